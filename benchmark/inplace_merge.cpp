@@ -0,0 +1,53 @@
+// Compares multidim::inplace_merge() of two sorted halves of a table of 16-element rows with and without a scratch range.
+// Usage: bench_inplace_merge [rows=1000000]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+
+namespace {
+	constexpr size_t row_width = 16;
+
+	using clock_type = std::chrono::steady_clock;
+	using table_type = multidim::dynarray<multidim::inner_array<std::uint32_t, row_width>>;
+
+	const auto by_key = [](const auto& a, const auto& b) { return a[0] < b[0]; };
+}
+
+int main(int argc, char** argv) {
+	const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+	if (rows < 2) {
+		std::fprintf(stderr, "usage: %s [rows], with rows >= 2\n", argv[0]);
+		return 1;
+	}
+	std::printf("%zu rows of %zu uint32 elements\n", rows, row_width);
+
+	// two interleaved sorted shards
+	table_type input(rows);
+	std::mt19937 rng(42);
+	const size_t half = rows / 2;
+	for (size_t i = 0; i != rows; ++i) {
+		input[i][0] = static_cast<std::uint32_t>(i < half ? 2 * i : 2 * (i - half) + 1);
+		for (size_t j = 1; j != row_width; ++j) input[i][j] = static_cast<std::uint32_t>(rng());
+	}
+	const auto middle = static_cast<std::ptrdiff_t>(half);
+
+	table_type in_place = input;
+	const clock_type::time_point rotate_start = clock_type::now();
+	multidim::inplace_merge(in_place.begin(), in_place.begin() + middle, in_place.end(), by_key);
+	const double rotate_seconds = std::chrono::duration<double>(clock_type::now() - rotate_start).count();
+
+	table_type buffered = input;
+	const clock_type::time_point buffer_start = clock_type::now();
+	table_type scratch(rows - half);
+	multidim::inplace_merge(buffered.begin(), buffered.begin() + middle, buffered.end(), scratch.begin(), scratch.end(), by_key);
+	const double buffer_seconds = std::chrono::duration<double>(clock_type::now() - buffer_start).count();
+
+	std::printf("without scratch %9.2f ms   with scratch (including its allocation) %9.2f ms   (%s)\n", rotate_seconds * 1e3, buffer_seconds * 1e3, in_place == buffered && multidim::is_sorted(buffered.begin(), buffered.end(), by_key) ? "ok" : "MISMATCH");
+}
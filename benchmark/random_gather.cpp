@@ -0,0 +1,62 @@
+// Compares the latency of random row gathers from a large dynarray allocated with different buffer policies.
+// Usage: bench_random_gather [megabytes=1024] [gathers=10000000]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+
+namespace {
+	constexpr size_t row_width = 8; // one 64-byte cache line of std::uint64_t per row
+
+	using clock_type = std::chrono::steady_clock;
+
+	double seconds_since(clock_type::time_point start) {
+		return std::chrono::duration<double>(clock_type::now() - start).count();
+	}
+
+	void run(const char* name, const multidim::buffer_policy& policy, size_t rows, const std::vector<size_t>& indices) {
+		const clock_type::time_point alloc_start = clock_type::now();
+		multidim::dynarray<multidim::inner_array<std::uint64_t, row_width>, multidim::managed_buffer> grid(policy, rows);
+		const double alloc_seconds = seconds_since(alloc_start);
+
+		// the first pass includes the page faults of pages that were not prefaulted
+		std::uint64_t sum = 0;
+		const clock_type::time_point first_start = clock_type::now();
+		for (size_t index : indices) sum += grid[index][index % row_width];
+		const double first_seconds = seconds_since(first_start);
+
+		const clock_type::time_point second_start = clock_type::now();
+		for (size_t index : indices) sum += grid[index][index % row_width];
+		const double second_seconds = seconds_since(second_start);
+
+		std::printf("%-24s alloc %8.3f s   first pass %7.2f ns/gather   second pass %7.2f ns/gather   (checksum %llu)\n", name, alloc_seconds, first_seconds * 1e9 / indices.size(), second_seconds * 1e9 / indices.size(), static_cast<unsigned long long>(sum));
+	}
+}
+
+int main(int argc, char** argv) {
+	const size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+	const size_t gathers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+	const size_t rows = (megabytes << 20) / (row_width * sizeof(std::uint64_t));
+	if (rows == 0 || gathers == 0) {
+		std::fprintf(stderr, "usage: %s [megabytes] [gathers]\n", argv[0]);
+		return 1;
+	}
+
+	std::mt19937_64 rng(42);
+	std::uniform_int_distribution<size_t> dist(0, rows - 1);
+	std::vector<size_t> indices(gathers);
+	for (size_t& index : indices) index = dist(rng);
+
+	std::printf("%zu MiB, %zu rows, %zu random gathers\n", megabytes, rows, gathers);
+	run("heap", multidim::buffer_policy{}, rows, indices);
+	run("heap + populate", multidim::buffer_policy{ multidim::huge_pages::none, true }, rows, indices);
+	run("transparent", multidim::buffer_policy{ multidim::huge_pages::transparent, false }, rows, indices);
+	run("transparent + populate", multidim::buffer_policy{ multidim::huge_pages::transparent, true }, rows, indices);
+	run("hugetlbfs + populate", multidim::buffer_policy{ multidim::huge_pages::hugetlbfs, true }, rows, indices);
+}
@@ -0,0 +1,70 @@
+// Compares lexicographical comparison of 64-element rows with multidim::lex_compare() against std::lexicographical_compare().
+// Usage: bench_row_compare [rows=100000] [passes=20]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+#include <multidim/compare.hpp>
+
+namespace {
+	constexpr size_t row_width = 64;
+
+	using clock_type = std::chrono::steady_clock;
+
+	template <typename T>
+	void run(const char* name, size_t rows, size_t passes) {
+		// rows share a long common prefix and differ somewhere in the last half, which is the expensive case for a dedupe or sort
+		multidim::dynarray<multidim::inner_array<T, row_width>> grid(rows);
+		std::mt19937_64 rng(42);
+		for (size_t i = 0; i != rows; ++i) {
+			const size_t diff_at = row_width / 2 + rng() % (row_width / 2);
+			for (size_t j = 0; j != row_width; ++j) grid[i][j] = static_cast<T>(j < diff_at ? j % 5 : rng() % 100);
+		}
+		std::vector<size_t> pairs(rows);
+		for (size_t& p : pairs) p = rng() % rows;
+
+		long long checksum = 0;
+		const clock_type::time_point std_start = clock_type::now();
+		for (size_t pass = 0; pass != passes; ++pass) {
+			for (size_t i = 0; i != rows; ++i) {
+				const T* const a = grid[i].data();
+				const T* const b = grid[pairs[i]].data();
+				checksum += std::lexicographical_compare(a, a + row_width, b, b + row_width);
+			}
+		}
+		const double std_seconds = std::chrono::duration<double>(clock_type::now() - std_start).count();
+
+		const clock_type::time_point lex_start = clock_type::now();
+		for (size_t pass = 0; pass != passes; ++pass) {
+			for (size_t i = 0; i != rows; ++i) {
+				checksum += multidim::lex_compare(grid[i], grid[pairs[i]]) < 0;
+			}
+		}
+		const double lex_seconds = std::chrono::duration<double>(clock_type::now() - lex_start).count();
+
+		const double compares = static_cast<double>(rows) * static_cast<double>(passes);
+		std::printf("%-10s std::lexicographical_compare %7.2f ns/row   multidim::lex_compare %7.2f ns/row   (checksum %lld)\n", name, std_seconds * 1e9 / compares, lex_seconds * 1e9 / compares, checksum);
+	}
+}
+
+int main(int argc, char** argv) {
+	const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+	const size_t passes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+	if (rows == 0 || passes == 0) {
+		std::fprintf(stderr, "usage: %s [rows] [passes]\n", argv[0]);
+		return 1;
+	}
+	std::printf("%zu rows of %zu elements, %zu passes\n", rows, row_width, passes);
+	run<std::uint8_t>("uint8", rows, passes);
+	run<std::int16_t>("int16", rows, passes);
+	run<std::int32_t>("int32", rows, passes);
+	run<std::int64_t>("int64", rows, passes);
+	run<float>("float", rows, passes);
+}
@@ -0,0 +1,65 @@
+// Compares lookups of random keys in a sorted table of 16-element rows with multidim::lower_bound() against multidim::sorted_row_index.
+// Usage: bench_row_search [rows=10000000] [lookups=1000000]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/compare.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+#include <multidim/sorted_row_index.hpp>
+
+namespace {
+	constexpr size_t row_width = 16;
+
+	using clock_type = std::chrono::steady_clock;
+}
+
+int main(int argc, char** argv) {
+	const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+	const size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+	if (rows == 0 || lookups == 0) {
+		std::fprintf(stderr, "usage: %s [rows] [lookups]\n", argv[0]);
+		return 1;
+	}
+	std::printf("%zu rows of %zu uint32 elements, %zu lookups\n", rows, row_width, lookups);
+
+	// sorted by construction: the first element counts up in steps of 0 to 3, so that some rows tie on their first element
+	multidim::dynarray<multidim::inner_array<std::uint32_t, row_width>> table(rows);
+	std::mt19937_64 rng(42);
+	std::uint32_t lead = 0;
+	for (size_t i = 0; i != rows; ++i) {
+		lead += static_cast<std::uint32_t>(rng() % 4);
+		table[i][0] = lead;
+		for (size_t j = 1; j != row_width; ++j) table[i][j] = static_cast<std::uint32_t>(i);
+	}
+	multidim::dynarray<multidim::inner_array<std::uint32_t, row_width>> keys(lookups);
+	for (size_t i = 0; i != lookups; ++i) {
+		const size_t at = rng() % rows;
+		for (size_t j = 0; j != row_width; ++j) keys[i][j] = table[at][j];
+	}
+
+	size_t checksum = 0;
+	const clock_type::time_point bisect_start = clock_type::now();
+	for (size_t i = 0; i != lookups; ++i) {
+		checksum += static_cast<size_t>(multidim::lower_bound(table.cbegin(), table.cend(), keys[i], multidim::lex_less{}) - table.cbegin());
+	}
+	const double bisect_seconds = std::chrono::duration<double>(clock_type::now() - bisect_start).count();
+
+	const clock_type::time_point build_start = clock_type::now();
+	const multidim::sorted_row_index index(table.cbegin(), table.cend());
+	const double build_seconds = std::chrono::duration<double>(clock_type::now() - build_start).count();
+
+	const clock_type::time_point index_start = clock_type::now();
+	for (size_t i = 0; i != lookups; ++i) {
+		checksum -= static_cast<size_t>(index.lower_bound(keys[i]) - table.cbegin());
+	}
+	const double index_seconds = std::chrono::duration<double>(clock_type::now() - index_start).count();
+
+	const double n = static_cast<double>(lookups);
+	std::printf("multidim::lower_bound %7.1f ns/lookup   sorted_row_index %7.1f ns/lookup (built in %.2f s)   (checksum %zu, expect 0)\n", bisect_seconds * 1e9 / n, index_seconds * 1e9 / n, build_seconds, checksum);
+}
@@ -0,0 +1,62 @@
+// Compares multidim::stable_partition() and multidim::stable_sort() of a table of 8-element rows with and without a scratch range.
+// Usage: bench_stable_partition [rows=5000000]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+
+namespace {
+	constexpr size_t row_width = 8;
+
+	using clock_type = std::chrono::steady_clock;
+	using table_type = multidim::dynarray<multidim::inner_array<std::uint32_t, row_width>>;
+
+	const auto keep = [](const auto& row) { return row[0] % 3 == 0; };
+	const auto by_key = [](const auto& a, const auto& b) { return a[0] % 1024 < b[0] % 1024; };
+
+	template <typename F>
+	double time_ms(F f) {
+		const clock_type::time_point start = clock_type::now();
+		f();
+		return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+	if (rows == 0) {
+		std::fprintf(stderr, "usage: %s [rows]\n", argv[0]);
+		return 1;
+	}
+	std::printf("%zu rows of %zu uint32 elements\n", rows, row_width);
+
+	table_type input(rows);
+	std::mt19937 rng(42);
+	for (size_t i = 0; i != rows; ++i) {
+		for (size_t j = 0; j != row_width; ++j) input[i][j] = static_cast<std::uint32_t>(rng());
+	}
+
+	table_type a = input;
+	const double partition_plain = time_ms([&] { multidim::stable_partition(a.begin(), a.end(), keep); });
+	table_type b = input;
+	const double partition_scratch = time_ms([&] {
+		table_type scratch(rows);
+		multidim::stable_partition(b.begin(), b.end(), scratch.begin(), scratch.end(), keep);
+	});
+	std::printf("stable_partition   without scratch %9.2f ms   with scratch %9.2f ms   (%s)\n", partition_plain, partition_scratch, a == b ? "ok" : "MISMATCH");
+
+	a = input;
+	const double sort_plain = time_ms([&] { multidim::stable_sort(a.begin(), a.end(), by_key); });
+	b = input;
+	const double sort_scratch = time_ms([&] {
+		table_type scratch(rows / 2);
+		multidim::stable_sort(b.begin(), b.end(), scratch.begin(), scratch.end(), by_key);
+	});
+	std::printf("stable_sort        without scratch %9.2f ms   with scratch %9.2f ms   (%s)\n", sort_plain, sort_scratch, a == b ? "ok" : "MISMATCH");
+}
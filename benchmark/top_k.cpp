@@ -0,0 +1,66 @@
+// Compares top-k extraction from wide rows of floats with multidim::sort() against multidim::partial_sort(), multidim::nth_element() and multidim::partial_sort_copy().
+// Usage: bench_top_k [rows=1000000] [k=100]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+
+namespace {
+	constexpr size_t row_width = 32;
+
+	using clock_type = std::chrono::steady_clock;
+	using table_type = multidim::dynarray<multidim::inner_array<float, row_width>>;
+
+	// orders rows by score (element 0), best first
+	const auto by_score = [](const auto& a, const auto& b) { return a[0] > b[0]; };
+
+	template <typename F>
+	void run(const char* name, const table_type& input, F f) {
+		table_type table = input;
+		const clock_type::time_point start = clock_type::now();
+		const float kth = f(table);
+		const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+		std::printf("%-28s %9.2f ms   (k-th score %f)\n", name, seconds * 1e3, static_cast<double>(kth));
+	}
+}
+
+int main(int argc, char** argv) {
+	const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+	const size_t k = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+	if (rows == 0 || k == 0 || k > rows) {
+		std::fprintf(stderr, "usage: %s [rows] [k], with 0 < k <= rows\n", argv[0]);
+		return 1;
+	}
+	std::printf("%zu rows of %zu floats, k = %zu\n", rows, row_width, k);
+
+	table_type input(rows);
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+	for (size_t i = 0; i != rows; ++i) {
+		for (size_t j = 0; j != row_width; ++j) input[i][j] = dist(rng);
+	}
+	const auto kth = static_cast<std::ptrdiff_t>(k - 1);
+
+	run("multidim::sort", input, [&](table_type& t) {
+		multidim::sort(t.begin(), t.end(), by_score);
+		return t[k - 1][0];
+	});
+	run("multidim::partial_sort", input, [&](table_type& t) {
+		multidim::partial_sort(t.begin(), t.begin() + kth + 1, t.end(), by_score);
+		return t[k - 1][0];
+	});
+	run("multidim::nth_element", input, [&](table_type& t) {
+		multidim::nth_element(t.begin(), t.begin() + kth, t.end(), by_score);
+		return t[k - 1][0];
+	});
+	run("multidim::partial_sort_copy", input, [&](table_type& t) {
+		table_type out(k);
+		multidim::partial_sort_copy(t.cbegin(), t.cend(), out.begin(), out.end(), by_score);
+		return out[k - 1][0];
+	});
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <functional> // for std::less
+#include <iterator>
+#include <type_traits>
+#include <utility> // for std::pair
+
+/**
+ * Binary search operations (on sorted ranges).
+ * For repeated lookups into a large table of sorted rows, see also multidim::sorted_row_index in <multidim/sorted_row_index.hpp>.
+ */
+
+namespace multidim {
+
+    namespace detail {
+        /**
+         * Gets the first element in [first, last) for which `goes_left(*it)` is true, given that the range is partitioned by it.
+         * Like partition_point(), but halves the range without branching on the comparison result, so that random access iterators do not suffer branch mispredictions.
+         */
+        template <typename ForwardIt, typename GoesLeft>
+        constexpr inline ForwardIt bisect(ForwardIt first, ForwardIt last, GoesLeft goes_left) {
+            typename std::iterator_traits<ForwardIt>::difference_type len = std::distance(first, last);
+            if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>) {
+                if (len == 0) return first;
+                while (len > 1) {
+                    const auto half = len / 2;
+                    if (!goes_left(first[half])) first += half; // compiled to a conditional move where possible
+                    len -= half;
+                }
+                return goes_left(*first) ? first : first + 1;
+            }
+            else {
+                while (len != 0) {
+                    ForwardIt mid = first;
+                    const auto half = len / 2;
+                    std::advance(mid, half);
+                    if (!goes_left(*mid)) {
+                        first = ++mid;
+                        len -= half + 1;
+                    }
+                    else {
+                        len = half;
+                    }
+                }
+                return first;
+            }
+        }
+    }
+
+    template <typename ForwardIt, typename T, typename Compare>
+    constexpr inline ForwardIt lower_bound(ForwardIt first, ForwardIt last, const T& value, Compare comp) {
+        return detail::bisect(first, last, [&](const auto& elem) { return !comp(elem, value); });
+    }
+    template <typename ForwardIt, typename T>
+    constexpr inline ForwardIt lower_bound(ForwardIt first, ForwardIt last, const T& value) {
+        return multidim::lower_bound(first, last, value, std::less<>());
+    }
+    template <typename ForwardIt, typename T, typename Compare>
+    constexpr inline ForwardIt upper_bound(ForwardIt first, ForwardIt last, const T& value, Compare comp) {
+        return detail::bisect(first, last, [&](const auto& elem) { return comp(value, elem); });
+    }
+    template <typename ForwardIt, typename T>
+    constexpr inline ForwardIt upper_bound(ForwardIt first, ForwardIt last, const T& value) {
+        return multidim::upper_bound(first, last, value, std::less<>());
+    }
+    template <typename ForwardIt, typename T, typename Compare>
+    constexpr inline std::pair<ForwardIt, ForwardIt> equal_range(ForwardIt first, ForwardIt last, const T& value, Compare comp) {
+        first = multidim::lower_bound(first, last, value, comp);
+        return { first, multidim::upper_bound(first, last, value, comp) };
+    }
+    template <typename ForwardIt, typename T>
+    constexpr inline std::pair<ForwardIt, ForwardIt> equal_range(ForwardIt first, ForwardIt last, const T& value) {
+        return multidim::equal_range(first, last, value, std::less<>());
+    }
+    template <typename ForwardIt, typename T, typename Compare>
+    constexpr inline bool binary_search(ForwardIt first, ForwardIt last, const T& value, Compare comp) {
+        first = multidim::lower_bound(first, last, value, comp);
+        return first != last && !comp(value, *first);
+    }
+    template <typename ForwardIt, typename T>
+    constexpr inline bool binary_search(ForwardIt first, ForwardIt last, const T& value) {
+        return multidim::binary_search(first, last, value, std::less<>());
+    }
+}
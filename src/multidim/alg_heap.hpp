@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <functional> // for std::less
+#include <iterator>
+
+#include "multidim/alg_modify.hpp" // for some helpers, e.g. multidim::iter_swap()
+#include "multidim/alg_sort.hpp" // for the binary heap helpers, e.g. detail::sift_down()
+
+/**
+ * Heap operations.
+ * The heaps are binary max-heaps laid out like those of the standard library, so that ranges can be passed between multidim:: and std:: heap algorithms.
+ * Like the rest of the algorithms library, these never construct temporary elements; elements are only ever swapped with multidim::iter_swap().
+ */
+
+namespace multidim {
+
+    namespace detail {
+        /**
+         * Moves the element at `hole` down the Arity-ary max-heap [first, first + len) until the heap property holds.
+         * Wider heaps are shallower, so each sift touches fewer levels (and hence fewer rows that are likely to miss the cache), at the cost of more comparisons per level.
+         */
+        template <size_t Arity, typename RandomIt, typename Compare>
+        constexpr inline void sift_down_d(RandomIt first, typename std::iterator_traits<RandomIt>::difference_type len, typename std::iterator_traits<RandomIt>::difference_type hole, Compare& comp) {
+            if constexpr (Arity == 2) {
+                detail::sift_down(first, len, hole, comp);
+            }
+            else {
+                using difference_type = typename std::iterator_traits<RandomIt>::difference_type;
+                while (true) {
+                    const difference_type child = static_cast<difference_type>(Arity) * hole + 1;
+                    if (child >= len) return;
+                    const difference_type child_end = len - child > static_cast<difference_type>(Arity) ? child + static_cast<difference_type>(Arity) : len;
+                    difference_type best = child;
+                    for (difference_type c = child + 1; c < child_end; ++c) {
+                        if (comp(*(first + best), *(first + c))) best = c;
+                    }
+                    if (!comp(*(first + hole), *(first + best))) return;
+                    multidim::iter_swap(first + hole, first + best);
+                    hole = best;
+                }
+            }
+        }
+        /**
+         * Moves the element at `hole` up the Arity-ary max-heap starting at first until the heap property holds.
+         */
+        template <size_t Arity, typename RandomIt, typename Compare>
+        constexpr inline void sift_up_d(RandomIt first, typename std::iterator_traits<RandomIt>::difference_type hole, Compare& comp) {
+            if constexpr (Arity == 2) {
+                detail::sift_up(first, hole, comp);
+            }
+            else {
+                while (hole > 0) {
+                    const auto parent = (hole - 1) / static_cast<decltype(hole)>(Arity);
+                    if (!comp(*(first + parent), *(first + hole))) return;
+                    multidim::iter_swap(first + parent, first + hole);
+                    hole = parent;
+                }
+            }
+        }
+        template <size_t Arity, typename RandomIt, typename Compare>
+        constexpr inline void make_heap_d(RandomIt first, RandomIt last, Compare& comp) {
+            const auto len = last - first;
+            if (len < 2) return;
+            for (auto i = (len - 2) / static_cast<decltype(len)>(Arity) + 1; i-- > 0;) {
+                detail::sift_down_d<Arity>(first, len, i, comp);
+            }
+        }
+    }
+
+    template <typename RandomIt, typename Compare>
+    constexpr inline RandomIt is_heap_until(RandomIt first, RandomIt last, Compare comp) {
+        const auto len = last - first;
+        for (decltype(last - first) i = 1; i < len; ++i) {
+            if (comp(*(first + (i - 1) / 2), *(first + i))) return first + i;
+        }
+        return last;
+    }
+    template <typename RandomIt>
+    constexpr inline RandomIt is_heap_until(RandomIt first, RandomIt last) {
+        return multidim::is_heap_until(first, last, std::less<>());
+    }
+    template <typename RandomIt, typename Compare>
+    constexpr inline bool is_heap(RandomIt first, RandomIt last, Compare comp) {
+        return multidim::is_heap_until(first, last, comp) == last;
+    }
+    template <typename RandomIt>
+    constexpr inline bool is_heap(RandomIt first, RandomIt last) {
+        return multidim::is_heap_until(first, last) == last;
+    }
+
+    template <typename RandomIt, typename Compare>
+    constexpr inline void make_heap(RandomIt first, RandomIt last, Compare comp) {
+        detail::make_heap(first, last, comp);
+    }
+    template <typename RandomIt>
+    constexpr inline void make_heap(RandomIt first, RandomIt last) {
+        multidim::make_heap(first, last, std::less<>());
+    }
+    /**
+     * Adds the element at last - 1 to the max-heap [first, last - 1).
+     */
+    template <typename RandomIt, typename Compare>
+    constexpr inline void push_heap(RandomIt first, RandomIt last, Compare comp) {
+        if (last - first < 2) return;
+        detail::sift_up(first, (last - first) - 1, comp);
+    }
+    template <typename RandomIt>
+    constexpr inline void push_heap(RandomIt first, RandomIt last) {
+        multidim::push_heap(first, last, std::less<>());
+    }
+    /**
+     * Swaps the greatest element of the max-heap [first, last) to last - 1, and makes [first, last - 1) a max-heap.
+     */
+    template <typename RandomIt, typename Compare>
+    constexpr inline void pop_heap(RandomIt first, RandomIt last, Compare comp) {
+        const auto len = last - first;
+        if (len < 2) return;
+        multidim::iter_swap(first, last - 1);
+        detail::sift_down(first, len - 1, decltype(len){ 0 }, comp);
+    }
+    template <typename RandomIt>
+    constexpr inline void pop_heap(RandomIt first, RandomIt last) {
+        multidim::pop_heap(first, last, std::less<>());
+    }
+    template <typename RandomIt, typename Compare>
+    constexpr inline void sort_heap(RandomIt first, RandomIt last, Compare comp) {
+        detail::sort_heap(first, last, comp);
+    }
+    template <typename RandomIt>
+    constexpr inline void sort_heap(RandomIt first, RandomIt last) {
+        multidim::sort_heap(first, last, std::less<>());
+    }
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <functional> // for std::less
+#include <iterator>
+#include <utility> // for std::move()
+
+#include "multidim/alg_modify.hpp" // for some helpers, e.g. multidim::rotate()
+#include "multidim/alg_binary_search.hpp" // for multidim::lower_bound() and multidim::upper_bound()
+
+/**
+ * Merge operations and set operations (on sorted ranges).
+ * Like the rest of the algorithms library, these never construct temporary elements.
+ * inplace_merge() either works in place by rotations, or moves elements through a scratch range of existing elements provided by the caller (e.g. a dynarray with the same inner extents).
+ */
+
+namespace multidim {
+
+    template <typename InputIt1, typename InputIt2, typename OutputIt, typename Compare>
+    constexpr inline OutputIt merge(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+        for (; first1 != last1; ++d_first) {
+            if (first2 == last2) return multidim::copy(first1, last1, d_first);
+            if (comp(*first2, *first1)) {
+                *d_first = *first2;
+                ++first2;
+            }
+            else {
+                *d_first = *first1;
+                ++first1;
+            }
+        }
+        return multidim::copy(first2, last2, d_first);
+    }
+    template <typename InputIt1, typename InputIt2, typename OutputIt>
+    constexpr inline OutputIt merge(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+        return multidim::merge(first1, last1, first2, last2, d_first, std::less<>());
+    }
+
+
+    namespace detail {
+        /**
+         * Merges [first, middle) and [middle, last) by moving the shorter of them into the scratch range at buffer, which must be large enough.
+         */
+        template <typename BidirIt, typename BufferIt, typename Compare>
+        constexpr inline void merge_with_buffer(BidirIt first, BidirIt middle, BidirIt last, typename std::iterator_traits<BidirIt>::difference_type len1, typename std::iterator_traits<BidirIt>::difference_type len2, BufferIt buffer, Compare& comp) {
+            if (len1 <= len2) {
+                // merge forwards into the hole left by the first run
+                const BufferIt buffer_end = multidim::move(first, middle, buffer);
+                for (; buffer != buffer_end; ++first) {
+                    if (middle == last) {
+                        multidim::move(buffer, buffer_end, first);
+                        return;
+                    }
+                    if (comp(*middle, *buffer)) {
+                        *first = std::move(*middle);
+                        ++middle;
+                    }
+                    else {
+                        *first = std::move(*buffer);
+                        ++buffer;
+                    }
+                }
+                // the rest of the second run is already in place
+            }
+            else {
+                // merge backwards into the hole left by the second run
+                BufferIt buffer_end = multidim::move(middle, last, buffer);
+                while (buffer_end != buffer) {
+                    if (middle == first) {
+                        multidim::move_backward(buffer, buffer_end, last);
+                        return;
+                    }
+                    --last;
+                    BufferIt right = buffer_end;
+                    BidirIt left = middle;
+                    if (comp(*--right, *--left)) {
+                        *last = std::move(*left);
+                        middle = left;
+                    }
+                    else {
+                        *last = std::move(*right);
+                        buffer_end = right;
+                    }
+                }
+                // the rest of the first run is already in place
+            }
+        }
+
+        /**
+         * Merges [first, middle) and [middle, last) by splitting them into two smaller merges around a rotation, until the runs fit into the scratch range (which may be empty).
+         * O(N log N) swaps without a scratch range, and O(N) moves with a scratch range as large as the shorter run.
+         */
+        template <typename BidirIt, typename BufferIt, typename Compare>
+        constexpr inline void merge_adaptive(BidirIt first, BidirIt middle, BidirIt last, typename std::iterator_traits<BidirIt>::difference_type len1, typename std::iterator_traits<BidirIt>::difference_type len2, BufferIt buffer, typename std::iterator_traits<BidirIt>::difference_type buffer_len, Compare& comp) {
+            while (true) {
+                if (len1 == 0 || len2 == 0) return;
+                if (len1 <= buffer_len || len2 <= buffer_len) {
+                    detail::merge_with_buffer(first, middle, last, len1, len2, buffer, comp);
+                    return;
+                }
+                if (len1 + len2 == 2) {
+                    if (comp(*middle, *first)) multidim::iter_swap(first, middle);
+                    return;
+                }
+                // split the longer run in half, and find where its middle element belongs in the other run
+                BidirIt first_cut = first;
+                BidirIt second_cut = middle;
+                typename std::iterator_traits<BidirIt>::difference_type len11, len22;
+                if (len1 > len2) {
+                    len11 = len1 / 2;
+                    std::advance(first_cut, len11);
+                    second_cut = multidim::lower_bound(middle, last, *first_cut, comp);
+                    len22 = std::distance(middle, second_cut);
+                }
+                else {
+                    len22 = len2 / 2;
+                    std::advance(second_cut, len22);
+                    first_cut = multidim::upper_bound(first, middle, *second_cut, comp);
+                    len11 = std::distance(first, first_cut);
+                }
+                const BidirIt new_middle = multidim::rotate(first_cut, middle, second_cut);
+                detail::merge_adaptive(first, first_cut, new_middle, len11, len22, buffer, buffer_len, comp);
+                // loop on the second half instead of recursing
+                first = new_middle;
+                middle = second_cut;
+                len1 -= len11;
+                len2 -= len22;
+            }
+        }
+    }
+
+    /**
+     * Merges the consecutive sorted ranges [first, middle) and [middle, last) into one sorted range, stably and without allocating memory.
+     * Uses rotations, so this takes O(N log N) swaps.  If that is too slow, use the overload that takes a scratch range.
+     */
+    template <typename BidirIt, typename Compare>
+    constexpr inline void inplace_merge(BidirIt first, BidirIt middle, BidirIt last, Compare comp) {
+        detail::merge_adaptive(first, middle, last, std::distance(first, middle), std::distance(middle, last), first, 0, comp);
+    }
+    template <typename BidirIt>
+    constexpr inline void inplace_merge(BidirIt first, BidirIt middle, BidirIt last) {
+        multidim::inplace_merge(first, middle, last, std::less<>());
+    }
+    /**
+     * Merges the consecutive sorted ranges [first, middle) and [middle, last) into one sorted range, stably, moving elements through the scratch range [buffer_first, buffer_last).
+     * The scratch range holds existing elements that can be assigned to and from the elements of the range (e.g. the rows of a dynarray with the same inner extents); their values afterwards are unspecified.
+     * With a scratch range at least as long as the shorter of the two runs, this takes O(N) moves; with a shorter one, it falls back to rotations for the parts that do not fit.
+     */
+    template <typename BidirIt, typename BufferIt, typename Compare>
+    constexpr inline void inplace_merge(BidirIt first, BidirIt middle, BidirIt last, BufferIt buffer_first, BufferIt buffer_last, Compare comp) {
+        detail::merge_adaptive(first, middle, last, std::distance(first, middle), std::distance(middle, last), buffer_first, static_cast<typename std::iterator_traits<BidirIt>::difference_type>(std::distance(buffer_first, buffer_last)), comp);
+    }
+    template <typename BidirIt, typename BufferIt>
+    constexpr inline void inplace_merge(BidirIt first, BidirIt middle, BidirIt last, BufferIt buffer_first, BufferIt buffer_last) {
+        multidim::inplace_merge(first, middle, last, buffer_first, buffer_last, std::less<>());
+    }
+
+
+    template <typename InputIt1, typename InputIt2, typename Compare>
+    constexpr inline bool includes(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, Compare comp) {
+        for (; first2 != last2; ++first1) {
+            if (first1 == last1 || comp(*first2, *first1)) return false;
+            if (!comp(*first1, *first2)) ++first2;
+        }
+        return true;
+    }
+    template <typename InputIt1, typename InputIt2>
+    constexpr inline bool includes(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2) {
+        return multidim::includes(first1, last1, first2, last2, std::less<>());
+    }
+
+    template <typename InputIt1, typename InputIt2, typename OutputIt, typename Compare>
+    constexpr inline OutputIt set_union(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+        for (; first1 != last1; ++d_first) {
+            if (first2 == last2) return multidim::copy(first1, last1, d_first);
+            if (comp(*first2, *first1)) {
+                *d_first = *first2;
+                ++first2;
+            }
+            else {
+                *d_first = *first1;
+                if (!comp(*first1, *first2)) ++first2;
+                ++first1;
+            }
+        }
+        return multidim::copy(first2, last2, d_first);
+    }
+    template <typename InputIt1, typename InputIt2, typename OutputIt>
+    constexpr inline OutputIt set_union(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+        return multidim::set_union(first1, last1, first2, last2, d_first, std::less<>());
+    }
+
+    template <typename InputIt1, typename InputIt2, typename OutputIt, typename Compare>
+    constexpr inline OutputIt set_intersection(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+        while (first1 != last1 && first2 != last2) {
+            if (comp(*first1, *first2)) {
+                ++first1;
+            }
+            else {
+                if (!comp(*first2, *first1)) {
+                    *d_first++ = *first1;
+                    ++first1;
+                }
+                ++first2;
+            }
+        }
+        return d_first;
+    }
+    template <typename InputIt1, typename InputIt2, typename OutputIt>
+    constexpr inline OutputIt set_intersection(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+        return multidim::set_intersection(first1, last1, first2, last2, d_first, std::less<>());
+    }
+
+    template <typename InputIt1, typename InputIt2, typename OutputIt, typename Compare>
+    constexpr inline OutputIt set_difference(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+        while (first1 != last1) {
+            if (first2 == last2) return multidim::copy(first1, last1, d_first);
+            if (comp(*first1, *first2)) {
+                *d_first++ = *first1;
+                ++first1;
+            }
+            else {
+                if (!comp(*first2, *first1)) ++first1;
+                ++first2;
+            }
+        }
+        return d_first;
+    }
+    template <typename InputIt1, typename InputIt2, typename OutputIt>
+    constexpr inline OutputIt set_difference(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+        return multidim::set_difference(first1, last1, first2, last2, d_first, std::less<>());
+    }
+
+    template <typename InputIt1, typename InputIt2, typename OutputIt, typename Compare>
+    constexpr inline OutputIt set_symmetric_difference(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+        while (first1 != last1) {
+            if (first2 == last2) return multidim::copy(first1, last1, d_first);
+            if (comp(*first1, *first2)) {
+                *d_first++ = *first1;
+                ++first1;
+            }
+            else {
+                if (comp(*first2, *first1)) {
+                    *d_first++ = *first2;
+                }
+                else {
+                    ++first1;
+                }
+                ++first2;
+            }
+        }
+        return multidim::copy(first2, last2, d_first);
+    }
+    template <typename InputIt1, typename InputIt2, typename OutputIt>
+    constexpr inline OutputIt set_symmetric_difference(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+        return multidim::set_symmetric_difference(first1, last1, first2, last2, d_first, std::less<>());
+    }
+}
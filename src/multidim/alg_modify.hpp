@@ -1,10 +1,13 @@
 #pragma once
 
+#include <cassert>
 #include <utility> // for std::move()
 #include <type_traits>
 #include <iterator>
+#include <numeric> // for std::gcd()
 
 #include "multidim/alg_nonmodify.hpp" // for some helpers, e.g. multidim::find()
+#include "multidim/temporary_row.hpp" // for multidim::temporary_row
 
 namespace multidim {
     template <typename InputIt, typename OutputIt>
@@ -203,35 +206,87 @@ namespace multidim {
         return d_first;
     }
 
+    namespace detail {
+        /**
+         * Whether rotate() may move rows along the cycles of the rotation: the iterator must be random access, its reference must be a row proxy (e.g. dynarray_ref), and copying base elements must not throw.
+         * Ranges of whole containers (e.g. std::vector<dynarray<int>>) are rotated by swaps instead, which swap their buffers in O(1).
+         */
+        template <typename It, typename = void>
+        struct rotates_by_cycles : std::false_type {};
+        template <typename It>
+        struct rotates_by_cycles<It, std::void_t<inner_container_of_t<typename std::iterator_traits<It>::reference>>> : std::bool_constant<
+            std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category> &&
+            std::is_nothrow_copy_constructible_v<typename element_traits<inner_container_of_t<typename std::iterator_traits<It>::reference>>::base_element> &&
+            std::is_nothrow_copy_assignable_v<typename element_traits<inner_container_of_t<typename std::iterator_traits<It>::reference>>::base_element>> {};
+        template <typename It>
+        constexpr inline bool rotates_by_cycles_v = rotates_by_cycles<It>::value;
+
+        /**
+         * Rotates rows by moving each one directly to its final position, following the cycles of the permutation and holding the first row of each cycle in a temporary_row.
+         * This copies N + gcd(N, K) rows, while the swap-only algorithm swaps about N rows (and each swap copies every element three times).
+         * The temporary row only uses the per-thread arena, so this never allocates from the heap or throws; it returns false without modifying the rows if a row does not fit in the arena.
+         */
+        template <typename RandomIt>
+        inline bool rotate_by_cycles(RandomIt first, RandomIt n_first, RandomIt last) noexcept {
+            using difference_type = typename std::iterator_traits<RandomIt>::difference_type;
+            const difference_type n = last - first;
+            const difference_type k = n_first - first;
+            const difference_type cycles = std::gcd(n, k);
+            temporary_row<inner_container_of_t<typename std::iterator_traits<RandomIt>::reference>> tmp(std::nothrow, *first);
+            if (!tmp) return false;
+            for (difference_type c = 0; c != cycles; ++c) {
+                if (c != 0) tmp = first[c];
+                difference_type i = c;
+                while (true) {
+                    difference_type j = i + k;
+                    if (j >= n) j -= n;
+                    if (j == c) break;
+                    first[i] = first[j];
+                    i = j;
+                }
+                first[i] = tmp.cref();
+            }
+            return true;
+        }
+
+        template <typename ForwardIt>
+        constexpr inline ForwardIt rotate_by_swaps(ForwardIt first, ForwardIt n_first, ForwardIt last) {
+            {
+                ForwardIt it = n_first;
+                do {
+                    multidim::iter_swap(first, it);
+                    ++first;
+                    ++it;
+                    if (first == n_first) {
+                        n_first = it;
+                    }
+                } while (it != last);
+            }
+            ForwardIt ret = first;
+            while (n_first != last) {
+                assert(first != n_first);
+                ForwardIt it = n_first;
+                do {
+                    multidim::iter_swap(first, it);
+                    ++first;
+                    ++it;
+                    if (first == n_first) {
+                        n_first = it;
+                    }
+                } while (it != last);
+            }
+            return ret;
+        }
+    }
+
     template <typename ForwardIt>
     constexpr inline ForwardIt rotate(ForwardIt first, ForwardIt n_first, ForwardIt last) {
         if (first == n_first) return last;
         if (n_first == last) return first;
-        {
-            ForwardIt it = n_first;
-            do {
-                multidim::iter_swap(first, it);
-                ++first;
-                ++it;
-                if (first == n_first) {
-                    n_first = it;
-                }
-            } while (it != last);
-        }
-        ForwardIt ret = first;
-        while (n_first != last) {
-            assert(first != n_first);
-            ForwardIt it = n_first;
-            do {
-                multidim::iter_swap(first, it);
-                ++first;
-                ++it;
-                if (first == n_first) {
-                    n_first = it;
-                }
-            } while (it != last);
+        if constexpr (detail::rotates_by_cycles_v<ForwardIt>) {
+            if (detail::rotate_by_cycles(first, n_first, last)) return first + (last - n_first);
         }
-        return ret;
+        return detail::rotate_by_swaps(first, n_first, last);
     }
     template <typename ForwardIt, typename OutputIt>
     constexpr inline ForwardIt rotate_copy(ForwardIt first, ForwardIt n_first, ForwardIt last, OutputIt d_first) {
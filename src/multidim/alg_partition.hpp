@@ -109,12 +109,61 @@ namespace multidim {
         }
     }
 
+    namespace detail {
+        /**
+         * Stable partition in one pass, moving the falsy elements through the scratch range at buffer, which must be large enough to hold all of them.
+         */
+        template <typename ForwardIt, typename BufferIt, typename UnaryPredicate>
+        constexpr inline ForwardIt stable_partition_with_buffer(ForwardIt first, ForwardIt last, BufferIt buffer, UnaryPredicate& p) {
+            ForwardIt out = first;
+            BufferIt buffer_end = buffer;
+            for (; first != last; ++first) {
+                if (p(*first)) {
+                    if (out != first) *out = std::move(*first);
+                    ++out;
+                }
+                else {
+                    *buffer_end = std::move(*first);
+                    ++buffer_end;
+                }
+            }
+            multidim::move(buffer, buffer_end, out);
+            return out;
+        }
+
+        // assumes that 0 < buffer_len
+        template <typename ForwardIt, typename BufferIt, typename UnaryPredicate>
+        constexpr inline ForwardIt stable_partition_adaptive(ForwardIt first, ForwardIt last, typename std::iterator_traits<ForwardIt>::difference_type len, BufferIt buffer, typename std::iterator_traits<ForwardIt>::difference_type buffer_len, UnaryPredicate& p) {
+            if (len <= buffer_len) return detail::stable_partition_with_buffer(first, last, buffer, p);
+            // at this point, len > buffer_len > 0, so both halves are non-empty
+            typename std::iterator_traits<ForwardIt>::difference_type left_len = len / 2;
+            ForwardIt mid = first;
+            std::advance(mid, left_len);
+            ForwardIt left_ans = stable_partition_adaptive(first, mid, left_len, buffer, buffer_len, p);
+            ForwardIt right_ans = stable_partition_adaptive(mid, last, len - left_len, buffer, buffer_len, p);
+            return multidim::rotate(left_ans, mid, right_ans);
+        }
+    }
+
     template <typename ForwardIt, typename UnaryPredicate>
     constexpr inline ForwardIt stable_partition(ForwardIt first, ForwardIt last, UnaryPredicate p) {
         if (first == last) return first;
         typename std::iterator_traits<ForwardIt>::difference_type len = std::distance(first, last);
         return detail::stable_partition_impl_with_sh(first, last, len, std::move(p));
     }
+    /**
+     * Like stable_partition(first, last, p), but moves elements through the scratch range [buffer_first, buffer_last) instead of only rotating them.
+     * The scratch range holds existing elements that can be assigned to and from the elements of the range (e.g. the rows of a dynarray with the same inner extents); their values afterwards are unspecified.
+     * With a scratch range at least as long as [first, last), this takes O(N) moves and calls p exactly once per element; with a shorter one, only the parts that do not fit are merged by rotations.
+     */
+    template <typename ForwardIt, typename BufferIt, typename UnaryPredicate>
+    constexpr inline ForwardIt stable_partition(ForwardIt first, ForwardIt last, BufferIt buffer_first, BufferIt buffer_last, UnaryPredicate p) {
+        if (first == last) return first;
+        const typename std::iterator_traits<ForwardIt>::difference_type buffer_len = std::distance(buffer_first, buffer_last);
+        typename std::iterator_traits<ForwardIt>::difference_type len = std::distance(first, last);
+        if (buffer_len == 0) return detail::stable_partition_impl_with_sh(first, last, len, std::move(p));
+        return detail::stable_partition_adaptive(first, last, len, buffer_first, buffer_len, p);
+    }
 
     template <typename ForwardIt, typename UnaryPredicate>
     constexpr inline ForwardIt partition_point(ForwardIt first, ForwardIt last, UnaryPredicate p) {
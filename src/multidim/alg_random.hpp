@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cassert>
 #include <random>
 
 #include "alg_modify.hpp" // for multidim::iter_swap()
@@ -31,7 +32,7 @@ namespace multidim {
             if (first == last) return out_end;
             *out_end = *first;
         }
-        assert(out_end - out == n);
+        assert(out_end - out == sz);
         diff_t curr = sz;
         for (; first != last; ++first) {
             const diff_t index = dist_t()(g, param_t(0, curr++));
@@ -64,12 +65,12 @@ namespace multidim {
      * Otherwise, this algorithm uses reservior sampling (Algorithm R), which is not stable.
      */
     template <typename PopulationIterator, typename SampleIterator, typename Distance, typename URBG>
-    constexpr inline SampleIterator selection_sample(PopulationIterator first, PopulationIterator last, SampleIterator out, Distance n, URBG&& g) {
-        if constexpr (std::is_base_of_v<std::forward_iterator_tag, std::iterator_traits<PopulationIterator>::iterator_category>) {
-            multidim::selection_sample(std::move(first), std::move(last), std::move(out), std::move(n), std::forward<URBG>(g));
+    constexpr inline SampleIterator sample(PopulationIterator first, PopulationIterator last, SampleIterator out, Distance n, URBG&& g) {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<PopulationIterator>::iterator_category>) {
+            return multidim::selection_sample(std::move(first), std::move(last), std::move(out), std::move(n), std::forward<URBG>(g));
         }
         else {
-            multidim::reservior_sample_r(std::move(first), std::move(last), std::move(out), std::move(n), std::forward<URBG>(g));
+            return multidim::reservior_sample_r(std::move(first), std::move(last), std::move(out), std::move(n), std::forward<URBG>(g));
         }
     }
 
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <functional> // for std::less
+#include <iterator>
+
+#include "multidim/alg_modify.hpp" // for some helpers, e.g. multidim::iter_swap()
+#include "multidim/alg_merge.hpp" // for detail::merge_adaptive()
+
+/**
+ * Sorting operations.
+ * Like the rest of the algorithms library, these never construct temporary elements; elements are only ever swapped with multidim::iter_swap() (and assigned from the input, in partial_sort_copy(), or through a scratch range, in stable_sort()).
+ */
+
+namespace multidim {
+
+    template <typename ForwardIt, typename Compare>
+    constexpr inline ForwardIt is_sorted_until(ForwardIt first, ForwardIt last, Compare comp) {
+        if (first == last) return last;
+        ForwardIt next = first;
+        for (++next; next != last; first = next, ++next) {
+            if (comp(*next, *first)) return next;
+        }
+        return last;
+    }
+    template <typename ForwardIt>
+    constexpr inline ForwardIt is_sorted_until(ForwardIt first, ForwardIt last) {
+        return multidim::is_sorted_until(first, last, std::less<>());
+    }
+    template <typename ForwardIt, typename Compare>
+    constexpr inline bool is_sorted(ForwardIt first, ForwardIt last, Compare comp) {
+        return multidim::is_sorted_until(first, last, comp) == last;
+    }
+    template <typename ForwardIt>
+    constexpr inline bool is_sorted(ForwardIt first, ForwardIt last) {
+        return multidim::is_sorted_until(first, last) == last;
+    }
+
+
+    namespace detail {
+        // ranges of at most this many elements are left for insertion sort
+        constexpr inline std::ptrdiff_t sort_threshold = 16;
+
+        /**
+         * Insertion sort by adjacent swaps, since we cannot hold the element being inserted in a temporary.
+         */
+        template <typename RandomIt, typename Compare>
+        constexpr inline void insertion_sort(RandomIt first, RandomIt last, Compare& comp) {
+            if (first == last) return;
+            for (RandomIt it = first + 1; it != last; ++it) {
+                for (RandomIt curr = it; curr != first && comp(*curr, *(curr - 1)); --curr) {
+                    multidim::iter_swap(curr, curr - 1);
+                }
+            }
+        }
+
+        /**
+         * Moves the element at `hole` down the max-heap [first, first + len) until the heap property holds.
+         */
+        template <typename RandomIt, typename Compare>
+        constexpr inline void sift_down(RandomIt first, typename std::iterator_traits<RandomIt>::difference_type len, typename std::iterator_traits<RandomIt>::difference_type hole, Compare& comp) {
+            while (true) {
+                auto child = 2 * hole + 1;
+                if (child >= len) return;
+                if (child + 1 < len && comp(*(first + child), *(first + (child + 1)))) ++child;
+                if (!comp(*(first + hole), *(first + child))) return;
+                multidim::iter_swap(first + hole, first + child);
+                hole = child;
+            }
+        }
+        /**
+         * Moves the element at `hole` up the max-heap starting at first until the heap property holds.
+         */
+        template <typename RandomIt, typename Compare>
+        constexpr inline void sift_up(RandomIt first, typename std::iterator_traits<RandomIt>::difference_type hole, Compare& comp) {
+            while (hole > 0) {
+                const auto parent = (hole - 1) / 2;
+                if (!comp(*(first + parent), *(first + hole))) return;
+                multidim::iter_swap(first + parent, first + hole);
+                hole = parent;
+            }
+        }
+        template <typename RandomIt, typename Compare>
+        constexpr inline void make_heap(RandomIt first, RandomIt last, Compare& comp) {
+            const auto len = last - first;
+            for (auto i = len / 2; i-- > 0;) {
+                detail::sift_down(first, len, i, comp);
+            }
+        }
+        template <typename RandomIt, typename Compare>
+        constexpr inline void sort_heap(RandomIt first, RandomIt last, Compare& comp) {
+            for (auto len = last - first; len > 1; --len) {
+                multidim::iter_swap(first, first + (len - 1));
+                detail::sift_down(first, len - 1, decltype(len){ 0 }, comp);
+            }
+        }
+
+        /**
+         * Swaps the median of *a, *b and *c into *result.
+         */
+        template <typename RandomIt, typename Compare>
+        constexpr inline void move_median_to_first(RandomIt result, RandomIt a, RandomIt b, RandomIt c, Compare& comp) {
+            if (comp(*a, *b)) {
+                if (comp(*b, *c)) multidim::iter_swap(result, b);
+                else if (comp(*a, *c)) multidim::iter_swap(result, c);
+                else multidim::iter_swap(result, a);
+            }
+            else if (comp(*a, *c)) multidim::iter_swap(result, a);
+            else if (comp(*b, *c)) multidim::iter_swap(result, c);
+            else multidim::iter_swap(result, b);
+        }
+
+        /**
+         * Partitions [first + 1, last) around the pivot at *first, and returns the start of the right part.
+         * The pivot stays at *first throughout, so it can be compared by reference instead of being copied out.
+         * The median-of-three pivot selection guarantees that the unguarded scans stop before going out of range.
+         */
+        template <typename RandomIt, typename Compare>
+        constexpr inline RandomIt partition_pivot(RandomIt first, RandomIt last, Compare& comp) {
+            const RandomIt mid = first + (last - first) / 2;
+            detail::move_median_to_first(first, first + 1, mid, last - 1, comp);
+            RandomIt left = first + 1;
+            RandomIt right = last;
+            while (true) {
+                while (comp(*left, *first)) ++left;
+                --right;
+                while (comp(*first, *right)) --right;
+                if (!(left < right)) return left;
+                multidim::iter_swap(left, right);
+                ++left;
+            }
+        }
+
+        template <typename RandomIt, typename Compare>
+        constexpr inline void introsort_loop(RandomIt first, RandomIt last, int depth_limit, Compare& comp) {
+            while (last - first > sort_threshold) {
+                if (depth_limit == 0) {
+                    detail::make_heap(first, last, comp);
+                    detail::sort_heap(first, last, comp);
+                    return;
+                }
+                --depth_limit;
+                const RandomIt cut = detail::partition_pivot(first, last, comp);
+                detail::introsort_loop(cut, last, depth_limit, comp);
+                last = cut;
+            }
+        }
+
+        /**
+         * Rearranges [first, last) so that [first, middle) holds the smallest middle - first elements as a max-heap.
+         */
+        template <typename RandomIt, typename Compare>
+        constexpr inline void heap_select(RandomIt first, RandomIt middle, RandomIt last, Compare& comp) {
+            detail::make_heap(first, middle, comp);
+            const auto len = middle - first;
+            for (RandomIt it = middle; it < last; ++it) {
+                if (comp(*it, *first)) {
+                    multidim::iter_swap(it, first);
+                    detail::sift_down(first, len, decltype(len){ 0 }, comp);
+                }
+            }
+        }
+
+        template <typename RandomIt, typename Compare>
+        constexpr inline void introselect_loop(RandomIt first, RandomIt nth, RandomIt last, int depth_limit, Compare& comp) {
+            while (last - first > sort_threshold) {
+                if (depth_limit == 0) {
+                    detail::heap_select(first, nth + 1, last, comp);
+                    multidim::iter_swap(first, nth); // the largest of the smallest elements is at the top of the heap
+                    return;
+                }
+                --depth_limit;
+                const RandomIt cut = detail::partition_pivot(first, last, comp);
+                if (cut <= nth) first = cut;
+                else last = cut;
+            }
+            detail::insertion_sort(first, last, comp);
+        }
+
+        template <typename Size>
+        constexpr inline int log2(Size n) noexcept {
+            int ret = 0;
+            while (n > 1) {
+                n >>= 1;
+                ++ret;
+            }
+            return ret;
+        }
+    }
+
+    /**
+     * Sorts the elements in [first, last) with introsort (quicksort that falls back to heapsort when recursion gets too deep, and insertion sort for small ranges).  O(N log N) comparisons and swaps in the worst case.  Not stable.
+     */
+    template <typename RandomIt, typename Compare>
+    constexpr inline void sort(RandomIt first, RandomIt last, Compare comp) {
+        if (last - first < 2) return;
+        detail::introsort_loop(first, last, 2 * detail::log2(last - first), comp);
+        detail::insertion_sort(first, last, comp); // every element is at most sort_threshold places from its final position
+    }
+    template <typename RandomIt>
+    constexpr inline void sort(RandomIt first, RandomIt last) {
+        multidim::sort(first, last, std::less<>());
+    }
+
+    namespace detail {
+        template <typename RandomIt, typename BufferIt, typename Compare>
+        constexpr inline void stable_sort_adaptive(RandomIt first, RandomIt last, BufferIt buffer, typename std::iterator_traits<RandomIt>::difference_type buffer_len, Compare& comp) {
+            const auto len = last - first;
+            if (len <= sort_threshold) {
+                detail::insertion_sort(first, last, comp); // stable, since it only swaps adjacent elements that are out of order
+                return;
+            }
+            const RandomIt mid = first + len / 2;
+            detail::stable_sort_adaptive(first, mid, buffer, buffer_len, comp);
+            detail::stable_sort_adaptive(mid, last, buffer, buffer_len, comp);
+            if (!comp(*mid, *(mid - 1))) return; // already in order, e.g. for presorted input
+            detail::merge_adaptive(first, mid, last, mid - first, last - mid, buffer, buffer_len, comp);
+        }
+    }
+
+    /**
+     * Sorts the elements in [first, last), preserving the order of equivalent elements, without allocating memory.
+     * Uses merge sort with in-place merges by rotations, so this takes O(N log^2 N) swaps.  If that is too slow, use the overload that takes a scratch range.
+     */
+    template <typename RandomIt, typename Compare>
+    constexpr inline void stable_sort(RandomIt first, RandomIt last, Compare comp) {
+        detail::stable_sort_adaptive(first, last, first, 0, comp);
+    }
+    template <typename RandomIt>
+    constexpr inline void stable_sort(RandomIt first, RandomIt last) {
+        multidim::stable_sort(first, last, std::less<>());
+    }
+    /**
+     * Like stable_sort(first, last, comp), but merges through the scratch range [buffer_first, buffer_last).
+     * The scratch range holds existing elements that can be assigned to and from the elements of the range (e.g. the rows of a dynarray with the same inner extents); their values afterwards are unspecified.
+     * With a scratch range at least half as long as [first, last), this takes O(N log N) moves; with a shorter one, only the merges that do not fit fall back to rotations.
+     */
+    template <typename RandomIt, typename BufferIt, typename Compare>
+    constexpr inline void stable_sort(RandomIt first, RandomIt last, BufferIt buffer_first, BufferIt buffer_last, Compare comp) {
+        detail::stable_sort_adaptive(first, last, buffer_first, static_cast<typename std::iterator_traits<RandomIt>::difference_type>(std::distance(buffer_first, buffer_last)), comp);
+    }
+    template <typename RandomIt, typename BufferIt>
+    constexpr inline void stable_sort(RandomIt first, RandomIt last, BufferIt buffer_first, BufferIt buffer_last) {
+        multidim::stable_sort(first, last, buffer_first, buffer_last, std::less<>());
+    }
+
+    /**
+     * Rearranges [first, last) so that *nth is the element that would be there if the range were sorted, no element in [first, nth) is greater than it, and no element in [nth, last) is less than it.
+     * Uses introselect (quickselect that falls back to heap selection when recursion gets too deep).  O(N) comparisons and swaps on average, O(N log N) in the worst case.
+     */
+    template <typename RandomIt, typename Compare>
+    constexpr inline void nth_element(RandomIt first, RandomIt nth, RandomIt last, Compare comp) {
+        if (nth == last || last - first < 2) return;
+        detail::introselect_loop(first, nth, last, 2 * detail::log2(last - first), comp);
+    }
+    template <typename RandomIt>
+    constexpr inline void nth_element(RandomIt first, RandomIt nth, RandomIt last) {
+        multidim::nth_element(first, nth, last, std::less<>());
+    }
+
+    /**
+     * Rearranges [first, last) so that [first, middle) holds the smallest middle - first elements in sorted order; the order of the rest is unspecified.
+     * Uses heap selection.  O(N log K) comparisons and swaps where K = middle - first, so this is much cheaper than sort() for K << N.
+     */
+    template <typename RandomIt, typename Compare>
+    constexpr inline void partial_sort(RandomIt first, RandomIt middle, RandomIt last, Compare comp) {
+        if (first == middle) return;
+        detail::heap_select(first, middle, last, comp);
+        detail::sort_heap(first, middle, comp);
+    }
+    template <typename RandomIt>
+    constexpr inline void partial_sort(RandomIt first, RandomIt middle, RandomIt last) {
+        multidim::partial_sort(first, middle, last, std::less<>());
+    }
+
+    /**
+     * Copies the smallest min(N, d_last - d_first) elements of [first, last) to [d_first, d_last) in sorted order, where N = last - first.
+     * The output elements are only ever assigned from input elements and swapped among themselves; the input is not modified.
+     * @return the iterator past the last element written
+     */
+    template <typename InputIt, typename RandomIt, typename Compare>
+    constexpr inline RandomIt partial_sort_copy(InputIt first, InputIt last, RandomIt d_first, RandomIt d_last, Compare comp) {
+        RandomIt d_end = d_first;
+        for (; first != last && d_end != d_last; ++first, ++d_end) {
+            *d_end = *first;
+        }
+        if (d_end == d_first) return d_end;
+        detail::make_heap(d_first, d_end, comp);
+        const auto len = d_end - d_first;
+        for (; first != last; ++first) {
+            if (comp(*first, *d_first)) {
+                *d_first = *first;
+                detail::sift_down(d_first, len, decltype(len){ 0 }, comp);
+            }
+        }
+        detail::sort_heap(d_first, d_end, comp);
+        return d_end;
+    }
+    template <typename InputIt, typename RandomIt>
+    constexpr inline RandomIt partial_sort_copy(InputIt first, InputIt last, RandomIt d_first, RandomIt d_last) {
+        return multidim::partial_sort_copy(first, last, d_first, d_last, std::less<>());
+    }
+}
@@ -4,3 +4,7 @@
 #include "alg_modify.hpp"
 #include "alg_random.hpp"
 #include "alg_partition.hpp"
+#include "alg_sort.hpp"
+#include "alg_heap.hpp"
+#include "alg_binary_search.hpp"
+#include "alg_merge.hpp"
@@ -6,6 +6,7 @@
 #include <utility> // for declaration of std::tuple_size / std::tuple_element
 
 #include "core.hpp"
+#include "compare.hpp"
 #include "iterator.hpp"
 
 namespace multidim {
@@ -111,6 +112,11 @@ namespace multidim {
 		constexpr const_iterator cend() const noexcept { return multidim::const_iterator<T>(static_cast<const Array&>(*this).data_offset(N), extents_, N); }
 		constexpr const_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
 		constexpr const_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+
+		/**
+		 * Gets the extents of elements that are stored in this array.
+		 */
+		constexpr const element_extents_type& extents() const noexcept { return extents_; }
 	protected:
 		using underlying_store = std::conditional_t<Owning, buffer_type, std::conditional_t<IsConst, const base_element*, base_element*>>;
 		template <typename... Args>
@@ -129,11 +135,6 @@ namespace multidim {
 			swap(extents_, other.extents_);
 		}
 
-		/**
-		 * Gets the extents of elements that are stored in this array.
-		 */
-		constexpr const element_extents_type& extents() const noexcept { return extents_; }
-
 		underlying_store data_;
 #if defined(__GNUC__)
 #pragma GCC diagnostic push
@@ -294,7 +295,7 @@ namespace multidim {
 			return static_cast<array_const_ref<T, N>>(a) == b;
 		}
 		friend constexpr MULTIDIM_FORCEINLINE bool operator!=(const array& a, const array_const_ref<T, N>& b) { return !(a == b); };
-		// Note: We don't provide lexicographical comparison because it isn't clear what it means to compare arrays of different shape.
+		// Note: We don't provide lexicographical comparison operators because it isn't clear what it means to compare arrays of different shape.  Use lex_compare() or lex_less for arrays of the same shape.
 	};
 
 	/**
@@ -421,6 +422,12 @@ namespace multidim {
 			return static_cast<array_const_ref<T, N>>(a) == b;
 		}
 		friend constexpr MULTIDIM_FORCEINLINE bool operator!=(const array_ref& a, const array_const_ref<T, N>& b) { return !(a == b); };
+#ifdef MULTIDIM_HAS_THREE_WAY_COMPARISON
+		/**
+		 * Lexicographically compares two array_refs of the same shape by their base elements (see lex_compare()).
+		 */
+		friend constexpr detail::three_way_ordering_t<typename B::base_element> operator<=>(const array_ref& a, const array_const_ref<T, N>& b) { return detail::lex_compare_three_way(a, b); }
+#endif
 
 		constexpr operator array_const_ref<T, N>() noexcept { return array_const_ref<T, N>{ this->data_, typename B::container_extents_type{ this->extents_ } }; }
 
@@ -490,9 +497,15 @@ namespace multidim {
 		 * Compares if two array_const_refs are elementwise equal.  If they have different shape or different number of elements, then it will also return false.
 		 */
 		friend constexpr bool operator==(const array_const_ref& a, const array_const_ref& b) {
-			return a.extents_ == b.extents_ && std::equal(a.data(), a.data_offset(N), b.data());
+			return a.extents_ == b.extents_ && detail::equal_n(a.data(), b.data(), N * a.extents_.stride());
 		}
 		friend constexpr MULTIDIM_FORCEINLINE bool operator!=(const array_const_ref& a, const array_const_ref& b) { return !(a == b); };
+#ifdef MULTIDIM_HAS_THREE_WAY_COMPARISON
+		/**
+		 * Lexicographically compares two array_const_refs of the same shape by their base elements (see lex_compare()).
+		 */
+		friend constexpr detail::three_way_ordering_t<typename B::base_element> operator<=>(const array_const_ref& a, const array_const_ref& b) { return detail::lex_compare_three_way(a, b); }
+#endif
 
 		/**
 		 * Rebinds this reference to another array_const_ref.
@@ -0,0 +1,368 @@
+#pragma once
+
+#if !(__has_include(<sys/stat.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>))
+#error "multidim/chunked_array.hpp requires POSIX file I/O"
+#endif
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memset() and std::memcpy()
+#include <future>
+#include <list>
+#include <stdexcept> // for std::out_of_range and std::invalid_argument
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dynarray.hpp"
+#include "dynamic_buffer.hpp"
+#include "codec.hpp"
+#include "core.hpp"
+
+namespace multidim {
+
+	/**
+	 * Where a chunked_array keeps its chunks.
+	 */
+	enum class chunk_storage {
+		single_file, // chunk i is stored at offset i * chunk_bytes of one file
+		directory // chunk i is stored in its own file, named "chunk_<i>" inside a directory
+	};
+
+	struct chunk_options {
+		chunk_storage storage = chunk_storage::single_file;
+		/**
+		 * The maximum number of chunks kept in memory.  Must be at least 1.
+		 */
+		size_t cache_chunks = 8;
+		/**
+		 * Whether to load chunk i+1 in the background when chunks i-1 and i are loaded one after the other (i.e. during a sequential scan).
+		 */
+		bool read_ahead = true;
+		/**
+		 * How chunks are encoded on disk (see codec.hpp).  Encoded chunks are decoded straight into the chunk buffer when loaded, including when they are read ahead.
+		 * The codec is not stored on disk, so an existing array must be opened with the codec that it was created with.
+		 */
+		binary_codec codec = binary_codec::raw;
+	};
+
+	namespace detail {
+		/**
+		 * Reads and writes whole chunks as raw bytes.  Chunks that were never written read as zero.
+		 * read() may be called concurrently with other calls to read() for other chunks.
+		 */
+		class chunk_store {
+		public:
+			chunk_store(const char* path, chunk_storage storage) : path_(path), storage_(storage), fd_(-1) {
+				if (storage_ == chunk_storage::single_file) {
+					fd_ = open_file(path_.c_str(), O_RDWR | O_CREAT);
+				}
+				else if (::mkdir(path, 0777) != 0 && errno != EEXIST) {
+					throw std::system_error(errno, std::generic_category(), "multidim: mkdir() failed");
+				}
+			}
+			chunk_store(const chunk_store&) = delete;
+			chunk_store& operator=(const chunk_store&) = delete;
+			~chunk_store() {
+				if (fd_ != -1) ::close(fd_);
+			}
+
+			void read(size_t index, size_t chunk_bytes, void* buf, size_t bytes) const {
+				if (storage_ == chunk_storage::single_file) {
+					read_at(fd_, buf, bytes, static_cast<off_t>(index * chunk_bytes));
+				}
+				else {
+					const int fd = ::open(chunk_path(index).c_str(), O_RDONLY | O_CLOEXEC);
+					if (fd == -1) {
+						if (errno != ENOENT) throw std::system_error(errno, std::generic_category(), "multidim: open() failed");
+						std::memset(buf, 0, bytes);
+						return;
+					}
+					try {
+						read_at(fd, buf, bytes, 0);
+					}
+					catch (...) {
+						::close(fd);
+						throw;
+					}
+					::close(fd);
+				}
+			}
+			void write(size_t index, size_t chunk_bytes, const void* buf, size_t bytes) {
+				if (storage_ == chunk_storage::single_file) {
+					write_at(fd_, buf, bytes, static_cast<off_t>(index * chunk_bytes));
+				}
+				else {
+					const int fd = open_file(chunk_path(index).c_str(), O_WRONLY | O_CREAT | O_TRUNC);
+					try {
+						write_at(fd, buf, bytes, 0);
+					}
+					catch (...) {
+						::close(fd);
+						throw;
+					}
+					::close(fd);
+				}
+			}
+
+		private:
+			static int open_file(const char* path, int flags) {
+				const int fd = ::open(path, flags | O_CLOEXEC, 0666);
+				if (fd == -1) throw std::system_error(errno, std::generic_category(), "multidim: open() failed");
+				return fd;
+			}
+			static void read_at(int fd, void* buf, size_t bytes, off_t offset) {
+				char* ptr = static_cast<char*>(buf);
+				while (bytes != 0) {
+					const ssize_t res = ::pread(fd, ptr, bytes, offset);
+					if (res < 0) {
+						if (errno == EINTR) continue;
+						throw std::system_error(errno, std::generic_category(), "multidim: pread() failed");
+					}
+					if (res == 0) {
+						std::memset(ptr, 0, bytes); // past the end of the file
+						return;
+					}
+					ptr += res;
+					bytes -= static_cast<size_t>(res);
+					offset += res;
+				}
+			}
+			static void write_at(int fd, const void* buf, size_t bytes, off_t offset) {
+				const char* ptr = static_cast<const char*>(buf);
+				while (bytes != 0) {
+					const ssize_t res = ::pwrite(fd, ptr, bytes, offset);
+					if (res < 0) {
+						if (errno == EINTR) continue;
+						throw std::system_error(errno, std::generic_category(), "multidim: pwrite() failed");
+					}
+					ptr += res;
+					bytes -= static_cast<size_t>(res);
+					offset += res;
+				}
+			}
+			std::string chunk_path(size_t index) const {
+				return path_ + "/chunk_" + std::to_string(index);
+			}
+
+			std::string path_;
+			chunk_storage storage_;
+			int fd_;
+		};
+	}
+
+	/**
+	 * Represents a multidimensional array that is too large to fit in memory.  The outermost dimension is split into chunks of chunk_rows() elements each, which are stored on disk and loaded on demand.
+	 * Each chunk is exposed as a dynarray_ref (so existing multidim algorithms can run on it), and the most recently used chunks are kept in an LRU cache.  Modified chunks are written back when they are evicted, when flush() is called, or when the chunked_array is destroyed.
+	 * Note: A chunk view (and references obtained from it) is invalidated when its chunk is evicted, i.e. after cache_chunks() other chunks have been accessed.
+	 * The base elements must be trivially copyable, since they are stored as raw bytes.  This class is not thread-safe.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 */
+	template <typename T>
+	class chunked_array {
+	public:
+		using reference = typename element_traits<T>::reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		using chunk_ref = dynarray_ref<T>;
+		using chunk_const_ref = dynarray_const_ref<T>;
+		static_assert(std::is_trivially_copyable_v<base_element>, "chunked_array requires trivially copyable base elements");
+
+		/**
+		 * Opens (or creates) a chunked array at the given path with size elements in the outermost dimension, split into chunks of chunk_rows elements each, given the element_extents_type (inner dimensions).
+		 * The shape is not stored on disk, so an existing array must be opened with the same shape and chunk size that it was created with.
+		 */
+		chunked_array(const char* path, const chunk_options& options, size_type size, size_type chunk_rows, const element_extents_type& extents) :
+			store_(path, options.storage), size_(size), chunk_rows_(chunk_rows), options_(options), last_loaded_(npos), pending_index_(npos), extents_(extents) {
+			if (chunk_rows_ == 0) throw std::invalid_argument("multidim: chunk_rows must be positive");
+			if (options_.cache_chunks == 0) throw std::invalid_argument("multidim: cache_chunks must be positive");
+			if (!codec_supports<base_element>(options_.codec)) throw std::invalid_argument("multidim: codec does not support this element type");
+		}
+		/**
+		 * Opens (or creates) a chunked array at the given path, given the inner dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		chunked_array(const char* path, const chunk_options& options, size_type size, size_type chunk_rows, TNs... ns) : chunked_array(path, options, size, chunk_rows, element_extents_type(ns...)) {}
+		chunked_array(const chunked_array&) = delete;
+		chunked_array& operator=(const chunked_array&) = delete;
+		~chunked_array() {
+			if (pending_.valid()) pending_.wait();
+			try {
+				flush();
+			}
+			catch (...) {
+				// destructors must not throw; call flush() explicitly to observe errors
+			}
+		}
+
+		size_type size() const noexcept { return size_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+		size_type chunk_rows() const noexcept { return chunk_rows_; }
+		size_type chunk_count() const noexcept { return (size_ + chunk_rows_ - 1) / chunk_rows_; }
+		size_type cache_chunks() const noexcept { return options_.cache_chunks; }
+		/**
+		 * Gets the extents of elements that are stored in this array.
+		 */
+		const element_extents_type& extents() const noexcept { return extents_; }
+
+		/**
+		 * Gets a mutable view of chunk `index`, loading it if necessary.  The chunk is marked as modified, so it will be written back.
+		 */
+		chunk_ref chunk(size_type index) {
+			entry& e = load(index);
+			e.dirty = true;
+			return chunk_ref{ e.buf.data(), container_extents_type{ rows_in_chunk(index), extents_ } };
+		}
+		/**
+		 * Gets a read-only view of chunk `index`, loading it if necessary.
+		 */
+		chunk_const_ref read_chunk(size_type index) {
+			const entry& e = load(index);
+			return chunk_const_ref{ e.buf.data(), container_extents_type{ rows_in_chunk(index), extents_ } };
+		}
+
+		/**
+		 * Gets a reference to the element at the specified index, loading its chunk if necessary.  It is undefined behaviour if index >= size().
+		 */
+		reference operator[](size_type index) {
+			assert(index < size_);
+			return chunk(index / chunk_rows_)[index % chunk_rows_];
+		}
+		reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		/**
+		 * Gets a read-only reference to the element at the specified index, loading its chunk if necessary.  It is undefined behaviour if index >= size().
+		 */
+		const_reference read(size_type index) {
+			assert(index < size_);
+			return read_chunk(index / chunk_rows_)[index % chunk_rows_];
+		}
+
+		/**
+		 * Writes all modified chunks back to disk.
+		 */
+		void flush() {
+			for (entry& e : lru_) {
+				write_back(e);
+			}
+		}
+
+	private:
+		static constexpr size_type npos = static_cast<size_type>(-1);
+
+		struct entry {
+			size_type index;
+			dynamic_buffer<base_element> buf;
+			bool dirty;
+		};
+
+		size_type rows_in_chunk(size_type index) const noexcept {
+			return index + 1 == chunk_count() ? size_ - index * chunk_rows_ : chunk_rows_;
+		}
+		size_type chunk_elements() const noexcept { return chunk_rows_ * extents_.stride(); }
+		size_type chunk_bytes() const noexcept { return chunk_elements() * sizeof(base_element); }
+		size_type stored_bytes(size_type index) const noexcept { return rows_in_chunk(index) * extents_.stride() * sizeof(base_element); }
+		// an encoded chunk is stored as its 8-byte length followed by the encoded block, which is at most one byte larger than the raw chunk
+		size_type slot_bytes() const noexcept { return options_.codec == binary_codec::raw ? chunk_bytes() : sizeof(std::uint64_t) + 1 + chunk_bytes(); }
+
+		void write_back(entry& e) {
+			if (!e.dirty) return;
+			if (options_.codec == binary_codec::raw) {
+				store_.write(e.index, slot_bytes(), e.buf.data(), stored_bytes(e.index));
+			}
+			else {
+				std::vector<unsigned char> frame(sizeof(std::uint64_t));
+				multidim::encode(options_.codec, e.buf.data(), rows_in_chunk(e.index) * extents_.stride(), frame);
+				const std::uint64_t len = frame.size() - sizeof(std::uint64_t);
+				std::memcpy(frame.data(), &len, sizeof(len));
+				store_.write(e.index, slot_bytes(), frame.data(), frame.size());
+			}
+			e.dirty = false;
+		}
+
+		dynamic_buffer<base_element> read_from_store(size_type index) const {
+			dynamic_buffer<base_element> buf(chunk_elements());
+			if (options_.codec == binary_codec::raw) {
+				store_.read(index, slot_bytes(), buf.data(), stored_bytes(index));
+				return buf;
+			}
+			std::uint64_t len;
+			store_.read(index, slot_bytes(), &len, sizeof(len));
+			if (len == 0) {
+				std::memset(buf.data(), 0, stored_bytes(index)); // never written
+				return buf;
+			}
+			if (len > slot_bytes() - sizeof(len)) throw format_error("multidim: corrupt chunk");
+			std::vector<unsigned char> frame(sizeof(len) + static_cast<size_t>(len));
+			store_.read(index, slot_bytes(), frame.data(), frame.size());
+			multidim::decode(frame.data() + sizeof(len), static_cast<size_t>(len), buf.data(), rows_in_chunk(index) * extents_.stride());
+			return buf;
+		}
+
+		entry& load(size_type index) {
+			if (index >= chunk_count()) throw std::out_of_range("chunk index out of range");
+			const bool sequential = last_loaded_ != npos && index == last_loaded_ + 1;
+			last_loaded_ = index;
+			if (const auto it = map_.find(index); it != map_.end()) {
+				lru_.splice(lru_.begin(), lru_, it->second); // move to front
+				return lru_.front();
+			}
+
+			// make space first, so that a failed write-back leaves everything in place
+			if (lru_.size() == options_.cache_chunks) {
+				write_back(lru_.back());
+				map_.erase(lru_.back().index);
+				lru_.pop_back();
+			}
+			dynamic_buffer<base_element> buf;
+			if (pending_index_ == index) {
+				pending_index_ = npos;
+				buf = pending_.get();
+			}
+			else {
+				buf = read_from_store(index);
+			}
+			lru_.push_front(entry{ index, std::move(buf), false });
+			map_.emplace(index, lru_.begin());
+
+			if (options_.read_ahead && sequential && index + 1 < chunk_count() && pending_index_ == npos && map_.find(index + 1) == map_.end()) {
+				pending_index_ = index + 1;
+				pending_ = std::async(std::launch::async, [this, next = index + 1]() { return read_from_store(next); });
+			}
+			return lru_.front();
+		}
+
+		detail::chunk_store store_;
+		size_type size_; // the size of the outermost dimension
+		size_type chunk_rows_; // the number of elements of the outermost dimension in each chunk
+		chunk_options options_;
+		std::list<entry> lru_; // most recently used chunk first
+		std::unordered_map<size_type, typename std::list<entry>::iterator> map_;
+		size_type last_loaded_;
+		size_type pending_index_; // the chunk that is being read ahead, or npos
+		std::future<dynamic_buffer<base_element>> pending_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+}
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memcpy()
+#include <stdexcept> // for std::runtime_error and std::invalid_argument
+#include <type_traits>
+#include <vector>
+
+/**
+ * Lightweight, dependency-free codecs for arrays of base elements, used by the binary format of serialize.hpp and by chunked_array.
+ *
+ * An encoded block starts with one byte holding the codec that was actually used, followed by the codec-specific data.
+ * The number of elements is not stored, since every user of a block already knows it.
+ * If a codec would make the data larger, the block is stored raw instead, so an encoded block is never more than one byte larger than the raw data.
+ *
+ * The decoders write straight into the destination buffer, and are written as simple loops over separate streams (e.g. all the bit widths before all the data) so that compilers can vectorize them.
+ */
+
+namespace multidim {
+
+	/**
+	 * Thrown when a serialized container is malformed, or does not match the container type that it is loaded into.
+	 */
+	class format_error : public std::runtime_error {
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	/**
+	 * How a payload is encoded.  Only raw payloads may be viewed without copying.
+	 */
+	enum class binary_codec : std::uint8_t {
+		raw = 0,
+		/**
+		 * Byte-shuffles the elements (all first bytes, then all second bytes, etc.), then compresses with an LZ77-style compressor.  Works for any base element type.
+		 */
+		shuffle_lz = 1,
+		/**
+		 * Zigzag-encodes the differences between consecutive elements, and packs each block of 128 differences with the smallest bit width that fits them all.  Integers only.
+		 */
+		delta_bitpack = 2,
+		/**
+		 * XORs each element with the previous one, and stores only the bytes between the leading and trailing zero bytes of the result.  float and double only.
+		 */
+		xor_float = 3
+	};
+
+	/**
+	 * Checks whether the codec can encode arrays of T.
+	 */
+	template <typename T>
+	constexpr inline bool codec_supports(binary_codec codec) noexcept {
+		switch (codec) {
+		case binary_codec::raw:
+		case binary_codec::shuffle_lz:
+			return std::is_trivially_copyable_v<T>;
+		case binary_codec::delta_bitpack:
+			return std::is_integral_v<T> && !std::is_same_v<T, bool>;
+		case binary_codec::xor_float:
+			return std::is_same_v<T, float> || std::is_same_v<T, double>;
+		}
+		return false;
+	}
+
+	namespace detail {
+		constexpr inline size_t bitpack_block = 128;
+		constexpr inline size_t lz_min_match = 4;
+		constexpr inline size_t lz_max_offset = 65535;
+		constexpr inline unsigned lz_hash_bits = 12;
+
+		[[noreturn]] inline void throw_corrupt_block() {
+			throw format_error("multidim: corrupt encoded block");
+		}
+
+		/**
+		 * Transposes count elements of size bytes each into size planes of count bytes each.
+		 */
+		inline void byte_shuffle(const unsigned char* in, size_t count, size_t size, unsigned char* out) noexcept {
+			for (size_t b = 0; b != size; ++b) {
+				for (size_t i = 0; i != count; ++i) {
+					out[b * count + i] = in[i * size + b];
+				}
+			}
+		}
+		inline void byte_unshuffle(const unsigned char* in, size_t count, size_t size, unsigned char* out) noexcept {
+			for (size_t b = 0; b != size; ++b) {
+				for (size_t i = 0; i != count; ++i) {
+					out[i * size + b] = in[b * count + i];
+				}
+			}
+		}
+
+		inline void lz_put_length(std::vector<unsigned char>& out, size_t len) {
+			for (; len >= 255; len -= 255) out.push_back(255);
+			out.push_back(static_cast<unsigned char>(len));
+		}
+		inline size_t lz_get_length(const unsigned char*& in, const unsigned char* in_end) {
+			size_t len = 0;
+			while (true) {
+				if (in == in_end) throw_corrupt_block();
+				const unsigned char b = *in++;
+				len += b;
+				if (b != 255) return len;
+			}
+		}
+
+		/**
+		 * Compresses [in, in + size) as a sequence of (literals, match) pairs.  Each pair starts with a token whose high nibble is the literal length and whose low nibble is the match length minus lz_min_match (15 means that more length bytes follow), followed by the literals and a two-byte little-endian match offset.
+		 * The last pair has no match.
+		 */
+		inline void lz_compress(const unsigned char* in, size_t size, std::vector<unsigned char>& out) {
+			std::vector<std::uint32_t> table(size_t{ 1 } << lz_hash_bits, 0); // position + 1 of the last occurrence of each hash, or 0
+			const auto hash = [in](size_t pos) noexcept {
+				std::uint32_t v;
+				std::memcpy(&v, in + pos, sizeof(v));
+				return static_cast<size_t>((v * 2654435761u) >> (32 - lz_hash_bits));
+			};
+			const auto emit = [&out, in](size_t anchor, size_t literals, size_t offset, size_t match) {
+				const size_t match_code = match == 0 ? 0 : match - lz_min_match;
+				out.push_back(static_cast<unsigned char>(((literals < 15 ? literals : 15) << 4) | (match_code < 15 ? match_code : 15)));
+				if (literals >= 15) lz_put_length(out, literals - 15);
+				out.insert(out.end(), in + anchor, in + anchor + literals);
+				if (match == 0) return;
+				out.push_back(static_cast<unsigned char>(offset & 0xff));
+				out.push_back(static_cast<unsigned char>(offset >> 8));
+				if (match_code >= 15) lz_put_length(out, match_code - 15);
+			};
+			size_t anchor = 0;
+			size_t pos = 0;
+			while (pos + lz_min_match <= size) {
+				const size_t h = hash(pos);
+				const size_t candidate = table[h];
+				table[h] = static_cast<std::uint32_t>(pos + 1);
+				if (candidate != 0 && pos - (candidate - 1) <= lz_max_offset && std::memcmp(in + candidate - 1, in + pos, lz_min_match) == 0) {
+					const size_t from = candidate - 1;
+					size_t len = lz_min_match;
+					while (pos + len < size && in[from + len] == in[pos + len]) ++len;
+					emit(anchor, pos - anchor, pos - from, len);
+					pos += len;
+					anchor = pos;
+				}
+				else {
+					++pos;
+				}
+			}
+			emit(anchor, size - anchor, 0, 0);
+		}
+		inline void lz_decompress(const unsigned char* in, const unsigned char* in_end, unsigned char* out, size_t size) {
+			unsigned char* const out_begin = out;
+			unsigned char* const out_end = out + size;
+			while (in != in_end) {
+				const unsigned char token = *in++;
+				size_t literals = token >> 4;
+				if (literals == 15) literals += lz_get_length(in, in_end);
+				if (literals > static_cast<size_t>(in_end - in) || literals > static_cast<size_t>(out_end - out)) throw_corrupt_block();
+				std::memcpy(out, in, literals);
+				in += literals;
+				out += literals;
+				if (in == in_end) break;
+				if (in_end - in < 2) throw_corrupt_block();
+				const size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+				in += 2;
+				size_t match = (token & 15) + lz_min_match;
+				if ((token & 15) == 15) match += lz_get_length(in, in_end);
+				if (offset == 0 || offset > static_cast<size_t>(out - out_begin) || match > static_cast<size_t>(out_end - out)) throw_corrupt_block();
+				const unsigned char* from = out - offset;
+				if (offset >= match) {
+					std::memcpy(out, from, match);
+					out += match;
+				}
+				else {
+					for (unsigned char* const end = out + match; out != end;) *out++ = *from++; // overlapping copy repeats the last offset bytes
+				}
+			}
+			if (out != out_end) throw_corrupt_block();
+		}
+
+		template <typename U>
+		constexpr inline unsigned bit_width(U x) noexcept {
+			unsigned ret = 0;
+			for (; x != 0; x >>= 1) ++ret;
+			return ret;
+		}
+
+		/**
+		 * Appends count values of width bits each, least significant bit first.
+		 */
+		template <typename U>
+		inline void pack_bits(const U* values, size_t count, unsigned width, std::vector<unsigned char>& out) {
+			const size_t start = out.size();
+			out.resize(start + (count * width + 7) / 8, 0);
+			unsigned char* const dest = out.data() + start;
+			size_t bit = 0;
+			for (size_t i = 0; i != count; ++i) {
+				for (unsigned b = 0; b < width;) {
+					const unsigned offset = bit & 7;
+					const unsigned take = 8 - offset < width - b ? 8 - offset : width - b;
+					dest[bit >> 3] |= static_cast<unsigned char>(((values[i] >> b) & ((U{ 1 } << take) - 1)) << offset);
+					b += take;
+					bit += take;
+				}
+			}
+		}
+		template <typename U>
+		inline void unpack_bits(const unsigned char* in, const unsigned char* in_end, size_t count, unsigned width, U* values) noexcept {
+			size_t bit = 0;
+			for (size_t i = 0; i != count; ++i, bit += width) {
+				const unsigned char* const src = in + (bit >> 3);
+				const unsigned offset = bit & 7;
+				if (width + offset <= 64 && in_end - src >= 8) {
+					// fast path: one unaligned 8-byte load
+					std::uint64_t word;
+					std::memcpy(&word, src, sizeof(word));
+					word >>= offset;
+					values[i] = static_cast<U>(width == 64 ? word : word & ((std::uint64_t{ 1 } << width) - 1));
+				}
+				else {
+					U v = 0;
+					for (unsigned b = 0; b < width;) {
+						const unsigned o = (bit + b) & 7;
+						const unsigned take = 8 - o < width - b ? 8 - o : width - b;
+						v |= static_cast<U>((in[(bit + b) >> 3] >> o) & ((1u << take) - 1)) << b;
+						b += take;
+					}
+					values[i] = v;
+				}
+			}
+		}
+
+		template <typename T>
+		inline void delta_bitpack_encode(const T* data, size_t count, std::vector<unsigned char>& out) {
+			using U = std::make_unsigned_t<T>;
+			constexpr unsigned bits = sizeof(U) * 8;
+			U zigzag[bitpack_block];
+			U prev = 0;
+			for (size_t first = 0; first < count; first += bitpack_block) {
+				const size_t n = count - first < bitpack_block ? count - first : bitpack_block;
+				U all = 0;
+				for (size_t i = 0; i != n; ++i) {
+					const U curr = static_cast<U>(data[first + i]);
+					const U delta = static_cast<U>(curr - prev);
+					zigzag[i] = static_cast<U>(static_cast<U>(delta << 1) ^ static_cast<U>(U{ 0 } - static_cast<U>(delta >> (bits - 1))));
+					all |= zigzag[i];
+					prev = curr;
+				}
+				const unsigned width = bit_width(all);
+				out.push_back(static_cast<unsigned char>(width));
+				pack_bits(zigzag, n, width, out);
+			}
+		}
+		template <typename T>
+		inline void delta_bitpack_decode(const unsigned char* in, const unsigned char* in_end, T* data, size_t count) {
+			using U = std::make_unsigned_t<T>;
+			U zigzag[bitpack_block];
+			U prev = 0;
+			for (size_t first = 0; first < count; first += bitpack_block) {
+				const size_t n = count - first < bitpack_block ? count - first : bitpack_block;
+				if (in == in_end) throw_corrupt_block();
+				const unsigned width = *in++;
+				const size_t bytes = (n * width + 7) / 8;
+				if (width > sizeof(U) * 8 || bytes > static_cast<size_t>(in_end - in)) throw_corrupt_block();
+				unpack_bits(in, in_end, n, width, zigzag);
+				in += bytes;
+				for (size_t i = 0; i != n; ++i) {
+					const U delta = static_cast<U>((zigzag[i] >> 1) ^ static_cast<U>(U{ 0 } - static_cast<U>(zigzag[i] & 1)));
+					prev = static_cast<U>(prev + delta);
+					data[first + i] = static_cast<T>(prev);
+				}
+			}
+			if (in != in_end) throw_corrupt_block();
+		}
+
+		template <typename T>
+		using float_bits_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+		/**
+		 * Stores a control byte per element (leading zero bytes in the high nibble, significant bytes in the low nibble), followed by the significant bytes of all the elements.
+		 */
+		template <typename T>
+		inline void xor_float_encode(const T* data, size_t count, std::vector<unsigned char>& out) {
+			using U = float_bits_t<T>;
+			const size_t controls = out.size();
+			out.resize(controls + count);
+			U prev = 0;
+			for (size_t i = 0; i != count; ++i) {
+				U curr;
+				std::memcpy(&curr, data + i, sizeof(U));
+				U x = curr ^ prev;
+				prev = curr;
+				unsigned lead = 0;
+				while (lead != sizeof(U) && (x >> ((sizeof(U) - 1 - lead) * 8)) == 0) ++lead;
+				unsigned trail = 0;
+				if (lead != sizeof(U)) {
+					while ((x & 0xff) == 0) {
+						x >>= 8;
+						++trail;
+					}
+				}
+				const unsigned len = static_cast<unsigned>(sizeof(U)) - lead - trail;
+				out[controls + i] = static_cast<unsigned char>((lead << 4) | len);
+				for (unsigned b = 0; b != len; ++b) out.push_back(static_cast<unsigned char>(x >> (b * 8)));
+			}
+		}
+		template <typename T>
+		inline void xor_float_decode(const unsigned char* in, const unsigned char* in_end, T* data, size_t count) {
+			using U = float_bits_t<T>;
+			if (static_cast<size_t>(in_end - in) < count) throw_corrupt_block();
+			const unsigned char* controls = in;
+			const unsigned char* bytes = in + count;
+			U prev = 0;
+			for (size_t i = 0; i != count; ++i) {
+				const unsigned lead = controls[i] >> 4;
+				const unsigned len = controls[i] & 15;
+				if (lead + len > sizeof(U) || len > static_cast<size_t>(in_end - bytes)) throw_corrupt_block();
+				U x = 0;
+				for (unsigned b = 0; b != len; ++b) x |= static_cast<U>(bytes[b]) << (b * 8);
+				bytes += len;
+				const unsigned trail = static_cast<unsigned>(sizeof(U)) - lead - len;
+				if (trail != sizeof(U)) x <<= trail * 8;
+				prev ^= x;
+				std::memcpy(data + i, &prev, sizeof(U));
+			}
+			if (bytes != in_end) throw_corrupt_block();
+		}
+	}
+
+	/**
+	 * Appends count elements, encoded with the given codec, to out.
+	 * Throws std::invalid_argument if the codec does not support T.
+	 */
+	template <typename T>
+	inline void encode(binary_codec codec, const T* data, size_t count, std::vector<unsigned char>& out) {
+		static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be encoded");
+		if (!codec_supports<T>(codec)) throw std::invalid_argument("multidim: codec does not support this element type");
+		const size_t start = out.size();
+		const size_t raw_size = count * sizeof(T);
+		out.push_back(static_cast<unsigned char>(codec));
+		if (codec == binary_codec::shuffle_lz) {
+			std::vector<unsigned char> shuffled(raw_size);
+			detail::byte_shuffle(reinterpret_cast<const unsigned char*>(data), count, sizeof(T), shuffled.data());
+			detail::lz_compress(shuffled.data(), raw_size, out);
+		}
+		else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+			if (codec == binary_codec::delta_bitpack) detail::delta_bitpack_encode(data, count, out);
+		}
+		else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+			if (codec == binary_codec::xor_float) detail::xor_float_encode(data, count, out);
+		}
+		if (codec == binary_codec::raw || out.size() - start > 1 + raw_size) {
+			// not worth it; store the elements as they are
+			out.resize(start);
+			out.push_back(static_cast<unsigned char>(binary_codec::raw));
+			const unsigned char* const bytes = reinterpret_cast<const unsigned char*>(data);
+			out.insert(out.end(), bytes, bytes + raw_size);
+		}
+	}
+
+	/**
+	 * Decodes exactly count elements from the encoded block [in, in + size) into data.
+	 * Throws format_error if the block is corrupt, or was not encoded from count elements of type T.
+	 */
+	template <typename T>
+	inline void decode(const unsigned char* in, size_t size, T* data, size_t count) {
+		static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be decoded");
+		if (size == 0) detail::throw_corrupt_block();
+		const unsigned char* const in_end = in + size;
+		const binary_codec codec = static_cast<binary_codec>(*in++);
+		if (!codec_supports<T>(codec)) throw format_error("multidim: unsupported codec");
+		switch (codec) {
+		case binary_codec::raw:
+			if (static_cast<size_t>(in_end - in) != count * sizeof(T)) detail::throw_corrupt_block();
+			if (count != 0) std::memcpy(data, in, count * sizeof(T)); // data may be nullptr when there are no elements
+			break;
+		case binary_codec::shuffle_lz: {
+			std::vector<unsigned char> shuffled(count * sizeof(T));
+			detail::lz_decompress(in, in_end, shuffled.data(), shuffled.size());
+			detail::byte_unshuffle(shuffled.data(), count, sizeof(T), reinterpret_cast<unsigned char*>(data));
+			break;
+		}
+		case binary_codec::delta_bitpack:
+			if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) detail::delta_bitpack_decode(in, in_end, data, count);
+			break;
+		case binary_codec::xor_float:
+			if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) detail::xor_float_decode(in, in_end, data, count);
+			break;
+		}
+	}
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm> // for std::min()
+#include <cassert>
+#include <cstddef>
+#include <cstring> // for std::memcmp()
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MULTIDIM_HAS_SSE2 1
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h> // for _BitScanForward()
+#endif
+
+#include "core.hpp"
+
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L && __has_include(<compare>)
+#include <compare>
+#define MULTIDIM_HAS_THREE_WAY_COMPARISON 1
+#endif
+
+/**
+ * Lexicographical comparison of rows (and whole containers) by their base elements.
+ */
+
+namespace multidim {
+
+	namespace detail {
+		inline unsigned count_trailing_zeros(unsigned x) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanForward(&index, x);
+			return static_cast<unsigned>(index);
+#else
+			return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+		}
+
+		/**
+		 * Gets the index of the first byte that differs between [a, a + n) and [b, b + n), or n if there is none.
+		 * Compares 32 or 16 bytes at a time with AVX2 or SSE2 when available.
+		 */
+		inline size_t first_mismatch_byte(const unsigned char* a, const unsigned char* b, size_t n) noexcept {
+			size_t i = 0;
+#if defined(__AVX2__)
+			for (; n - i >= 32; i += 32) {
+				const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+				const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+				const unsigned diff = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+				if (diff != 0) return i + count_trailing_zeros(diff);
+			}
+#endif
+#ifdef MULTIDIM_HAS_SSE2
+			for (; n - i >= 16; i += 16) {
+				const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+				const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+				const unsigned diff = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) & 0xFFFFu;
+				if (diff != 0) return i + count_trailing_zeros(diff);
+			}
+#endif
+			for (; i != n; ++i) {
+				if (a[i] != b[i]) return i;
+			}
+			return n;
+		}
+
+		template <typename T>
+		constexpr inline bool is_unsigned_byte_v = std::is_same_v<T, unsigned char> || std::is_same_v<T, std::byte>
+#if defined(__cpp_char8_t)
+			|| std::is_same_v<T, char8_t>
+#endif
+			;
+
+		template <typename T>
+		constexpr inline int compare_scalar(const T& a, const T& b) {
+			if (a < b) return -1;
+			if (b < a) return 1;
+			return 0;
+		}
+
+		/**
+		 * Lexicographically compares n base elements, returning a negative number, zero or a positive number like memcmp().
+		 * Unsigned bytes are compared with memcmp().  Other bitwise equality comparable elements are searched for the first mismatch with SIMD, and only the mismatching elements are compared with operator<.
+		 * Other elements are compared with operator< only.
+		 */
+		template <typename T>
+		constexpr inline int compare_n(const T* a, const T* b, size_t n) {
+#if defined(__cpp_lib_is_constant_evaluated) && __cpp_lib_is_constant_evaluated >= 201811L
+			if (std::is_constant_evaluated()) {
+				for (size_t i = 0; i != n; ++i) {
+					if (const int c = compare_scalar(a[i], b[i]); c != 0) return c;
+				}
+				return 0;
+			}
+#endif
+			if constexpr (is_unsigned_byte_v<T>) {
+				return n == 0 ? 0 : std::memcmp(a, b, n);
+			}
+			else if constexpr (is_bitwise_equality_comparable_v<T>) {
+				const size_t byte = first_mismatch_byte(reinterpret_cast<const unsigned char*>(a), reinterpret_cast<const unsigned char*>(b), n * sizeof(T));
+				if (byte == n * sizeof(T)) return 0;
+				return compare_scalar(a[byte / sizeof(T)], b[byte / sizeof(T)]);
+			}
+			else {
+				for (size_t i = 0; i != n; ++i) {
+					if (const int c = compare_scalar(a[i], b[i]); c != 0) return c;
+				}
+				return 0;
+			}
+		}
+	}
+
+	/**
+	 * Lexicographically compares two containers or references (e.g. two rows of a 2D dynarray) by their base elements.  Returns a negative number if a < b, zero if they are equivalent, and a positive number if a > b.
+	 * The elements of a and b must have the same extents; if a and b have different sizes then a proper prefix compares less.
+	 */
+	template <typename A, typename B, typename = std::enable_if_t<std::is_same_v<typename A::base_element, typename B::base_element>>>
+	constexpr inline int lex_compare(const A& a, const B& b) {
+		assert(a.extents() == b.extents());
+		const size_t na = a.size() * a.extents().stride();
+		const size_t nb = b.size() * b.extents().stride();
+		if (const int c = detail::compare_n(a.data(), b.data(), std::min(na, nb)); c != 0) return c;
+		return na < nb ? -1 : na > nb ? 1 : 0;
+	}
+
+	/**
+	 * Function object that orders containers or references lexicographically with lex_compare(), e.g. for multidim::sort() of the rows of a 2D dynarray.
+	 */
+	struct lex_less {
+		template <typename A, typename B>
+		constexpr bool operator()(const A& a, const B& b) const {
+			return lex_compare(a, b) < 0;
+		}
+	};
+
+#ifdef MULTIDIM_HAS_THREE_WAY_COMPARISON
+	namespace detail {
+		/**
+		 * The comparison category of operator<=> for containers of T: partial for floating point types (NaN is unordered), strong for integers, enums and pointers, and weak otherwise (since other elements are only compared with operator<).
+		 */
+		template <typename T>
+		using three_way_ordering_t = std::conditional_t<std::is_floating_point_v<T>, std::partial_ordering,
+			std::conditional_t<std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>, std::strong_ordering, std::weak_ordering>>;
+
+		template <typename A, typename B>
+		constexpr inline three_way_ordering_t<typename A::base_element> lex_compare_three_way(const A& a, const B& b) {
+			using ordering = three_way_ordering_t<typename A::base_element>;
+			if constexpr (std::is_floating_point_v<typename A::base_element>) {
+				// compare_n() treats NaN as equivalent to everything, so look for unordered elements here
+				assert(a.extents() == b.extents());
+				const size_t na = a.size() * a.extents().stride();
+				const size_t nb = b.size() * b.extents().stride();
+				const auto* x = a.data();
+				const auto* y = b.data();
+				for (size_t i = 0, n = std::min(na, nb); i != n; ++i) {
+					if (x[i] < y[i]) return ordering::less;
+					if (y[i] < x[i]) return ordering::greater;
+					if (!(x[i] == y[i])) return ordering::unordered;
+				}
+				return na < nb ? ordering::less : na > nb ? ordering::greater : ordering::equivalent;
+			}
+			else {
+				const int c = lex_compare(a, b);
+				return c < 0 ? ordering::less : c > 0 ? ordering::greater : ordering::equivalent;
+			}
+		}
+	}
+#endif
+}
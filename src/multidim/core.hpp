@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm> // for std::equal()
+#include <cstring> // for std::memcmp()
 #include <type_traits>
 #include <utility> // for std::declval()
 
@@ -70,9 +72,9 @@ namespace multidim {
 		using type = fixed_buffer<T, N * M>;
 	};
 
-	template <typename T, size_t M>
-	struct add_dim_to_buffer<dynamic_buffer<T>, M> {
-		using type = dynamic_buffer<T>;
+	template <typename T, typename Kind, size_t M>
+	struct add_dim_to_buffer<dynamic_buffer<T, Kind>, M> {
+		using type = dynamic_buffer<T, Kind>;
 	};
 
 	/**
@@ -130,4 +132,32 @@ namespace multidim {
 	constexpr inline T to_pointer(T&& t) noexcept {
 		return std::forward<T>(t);
 	}
+
+	/**
+	 * Trait that says whether two values of T are equal exactly when their object representations are equal, so that ranges of them can be compared with memcmp().
+	 * This holds for integers, enums and pointers, but not for floating point types (because of NaN and signed zeros) or types with padding.
+	 * Specialise it to std::true_type to opt in other types, e.g. structs of bytes without padding whose operator== compares every member.
+	 */
+	template <typename T>
+	struct is_bitwise_equality_comparable : std::bool_constant<std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>> {};
+	template <typename T>
+	constexpr inline bool is_bitwise_equality_comparable_v = is_bitwise_equality_comparable<T>::value;
+
+	namespace detail {
+		/**
+		 * Compares n base elements, like std::equal(a, a + n, b).  Bitwise equality comparable elements are compared with memcmp(), which is vectorised and exits at the first difference.
+		 */
+		template <typename T>
+		constexpr inline bool equal_n(const T* a, const T* b, size_t n) {
+			if constexpr (is_bitwise_equality_comparable_v<T>) {
+#if defined(__cpp_lib_is_constant_evaluated) && __cpp_lib_is_constant_evaluated >= 201811L
+				if (std::is_constant_evaluated()) return std::equal(a, a + n, b);
+#endif
+				return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
+			}
+			else {
+				return std::equal(a, a + n, b);
+			}
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <algorithm> // for std::copy_n()
+#include <atomic> // for std::atomic_thread_fence()
+#include <cassert>
+#include <memory> // for std::shared_ptr
+#include <stdexcept> // for std::out_of_range and std::invalid_argument
+#include <type_traits>
+#include <vector>
+
+#include "dynarray.hpp"
+#include "core.hpp"
+#include "iterator.hpp"
+
+/**
+ * Copy-on-write arrays, for snapshots that are copied often but rarely modified.
+ * Copying a cow_dynarray (or a paged_cow_dynarray) only shares ownership of the buffer, and the buffer is copied when it is first modified through a non-const member function while it is still shared.
+ * Like std::shared_ptr, different objects that share a buffer may be used from different threads, but a single object may not be copied on one thread while it is modified on another.
+ */
+
+namespace multidim {
+
+	namespace detail {
+		template <typename Base>
+		inline std::shared_ptr<Base[]> make_shared_elements(size_t sz) {
+			return std::shared_ptr<Base[]>(new Base[sz]()); // value-initialized, like dynamic_buffer
+		}
+		/**
+		 * Checks whether a buffer is shared with another pointer.
+		 * use_count() is a relaxed load, so when it shows that this pointer is the only owner, an acquire fence orders the last reads of the buffer by other owners on other threads (which released their copies with a release decrement of the count) before any writes by this thread.
+		 */
+		template <typename Base>
+		inline bool shared_elements_in_use(const std::shared_ptr<Base[]>& ptr) noexcept {
+			if (ptr.use_count() > 1) return true;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return false;
+		}
+		template <typename Base>
+		inline std::shared_ptr<Base[]> clone_shared_elements(const Base* data, size_t sz) {
+			std::shared_ptr<Base[]> ret(new Base[sz]);
+			std::copy_n(data, sz, ret.get());
+			return ret;
+		}
+	}
+
+	/**
+	 * Represents a multidimensional array like dynarray, but whose buffer is shared between copies until one of them is modified.
+	 * Copying is O(1).  The first non-const access to a shared buffer (operator[], at(), begin(), data(), conversion to dynarray_ref, etc.) copies the whole buffer, after which this array owns it exclusively.
+	 * References and iterators obtained from a non-const access stay valid until the array is copied from; those obtained from a const access may be invalidated by any non-const access.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 */
+	template <typename T>
+	class cow_dynarray {
+	public:
+		using value_type = typename element_traits<T>::value_type;
+		using reference = typename element_traits<T>::reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using pointer = typename element_traits<T>::pointer;
+		using const_pointer = typename element_traits<T>::const_pointer;
+		using iterator = iterator_impl<T, false>;
+		using const_iterator = iterator_impl<T, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+
+		/**
+		 * Constructs a cow_dynarray from the given size (current dimension) and element_extents_type (inner dimensions).
+		 */
+		explicit cow_dynarray(size_t size, const element_extents_type& extents) : data_(detail::make_shared_elements<base_element>(size * extents.stride())), size_(size), extents_(extents) {}
+		/**
+		 * Constructs a cow_dynarray from the given dimensions.
+		 * Note: Dimensions are only specified for dynarray layers.  Compile-time fixed arrays do not need a dimension parameter.
+		 */
+		template <typename TN, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TN>, std::is_convertible<size_t, TNs>...>>>
+		explicit cow_dynarray(TN n, TNs... ns) : cow_dynarray(n, element_extents_type(ns...)) {}
+		explicit cow_dynarray() : cow_dynarray(0, element_extents_type()) {}
+		/**
+		 * Copies the elements of an existing array into a new (unshared) buffer.
+		 */
+		explicit cow_dynarray(const dynarray_const_ref<T>& other) : data_(detail::clone_shared_elements(other.data(), other.size() * other.extents().stride())), size_(other.size()), extents_(other.extents()) {}
+		cow_dynarray(const cow_dynarray&) noexcept = default;
+		cow_dynarray(cow_dynarray&&) noexcept = default;
+		cow_dynarray& operator=(const cow_dynarray&) noexcept = default;
+		cow_dynarray& operator=(cow_dynarray&&) noexcept = default;
+
+		friend void swap(cow_dynarray& a, cow_dynarray& b) noexcept {
+			a.swap(b);
+		}
+		void swap(cow_dynarray& other) noexcept {
+			using std::swap;
+			swap(data_, other.data_);
+			swap(size_, other.size_);
+			swap(extents_, other.extents_);
+		}
+
+		/**
+		 * Checks whether the buffer is currently shared with another cow_dynarray, i.e. whether the next non-const access will copy it.
+		 */
+		bool shared() const noexcept { return detail::shared_elements_in_use(data_); }
+		/**
+		 * Makes sure that this array owns its buffer exclusively, copying it if it is shared.
+		 */
+		void detach() {
+			if (shared()) data_ = detail::clone_shared_elements(data_.get(), size_ * extents_.stride());
+		}
+
+		/**
+		 * Converting operator to dynarray_ref.  This detaches the buffer.
+		 */
+		operator dynarray_ref<T>() {
+			return dynarray_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+		/**
+		 * Converting operator to dynarray_const_ref.
+		 */
+		operator dynarray_const_ref<T>() const noexcept {
+			return dynarray_const_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+
+		/**
+		 * Gets a pointer to the underlying base elements.  The non-const overload detaches the buffer.
+		 */
+		base_element* data() {
+			detach();
+			return data_.get();
+		}
+		const base_element* data() const noexcept { return data_.get(); }
+
+		reference operator[](size_type index) { assert(index < size_); return static_cast<dynarray_ref<T>>(*this)[index]; }
+		const_reference operator[](size_type index) const noexcept { assert(index < size_); return static_cast<dynarray_const_ref<T>>(*this)[index]; }
+		reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+
+		size_type size() const noexcept { return size_; }
+		size_type max_size() const noexcept { return size_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+		const_iterator cbegin() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).begin(); }
+		const_iterator cend() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).end(); }
+		const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+		const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+		const_iterator begin() const noexcept { return cbegin(); }
+		iterator begin() { return static_cast<dynarray_ref<T>>(*this).begin(); }
+		const_iterator end() const noexcept { return cend(); }
+		iterator end() { return static_cast<dynarray_ref<T>>(*this).end(); }
+		const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(end()); }
+		reverse_iterator rbegin() { return std::make_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(begin()); }
+		reverse_iterator rend() { return std::make_reverse_iterator(begin()); }
+
+		reference front() { return operator[](0); }
+		const_reference front() const noexcept { return operator[](0); }
+		reference back() { return operator[](size_ - 1); }
+		const_reference back() const noexcept { return operator[](size_ - 1); }
+
+		/**
+		 * Gets the extents of elements that are stored in this array.
+		 */
+		const element_extents_type& extents() const noexcept { return extents_; }
+
+		/**
+		 * Compares if the array is elementwise equal to another array.  If they have different shape or different number of elements, then it will also return false.
+		 */
+		friend bool operator==(const cow_dynarray& a, const dynarray_const_ref<T>& b) {
+			return static_cast<dynarray_const_ref<T>>(a) == b;
+		}
+		friend bool operator!=(const cow_dynarray& a, const dynarray_const_ref<T>& b) { return !(a == b); };
+
+	private:
+		std::shared_ptr<base_element[]> data_;
+		size_t size_; // the size of the current dimension
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+
+	/**
+	 * Represents a multidimensional array like cow_dynarray, but whose outermost dimension is split into chunks of chunk_rows() elements, each shared separately.
+	 * A write only copies the chunk that it touches, so a snapshot of a large array that is then modified in a few places costs only those chunks.
+	 * Since the chunks are not contiguous, elements are accessed by index or one chunk at a time (as a dynarray_ref / dynarray_const_ref), like chunked_array.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 */
+	template <typename T>
+	class paged_cow_dynarray {
+	public:
+		using reference = typename element_traits<T>::reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		using chunk_ref = dynarray_ref<T>;
+		using chunk_const_ref = dynarray_const_ref<T>;
+
+		/**
+		 * The chunk size used if none is given: as many elements as fit in 64 KiB (but at least one).
+		 */
+		static size_type default_chunk_rows(const element_extents_type& extents) noexcept {
+			const size_type row_bytes = extents.stride() * sizeof(base_element);
+			return row_bytes == 0 || row_bytes >= 65536 ? 1 : 65536 / row_bytes;
+		}
+
+		/**
+		 * Constructs an array with the given size, chunk size and element_extents_type (inner dimensions).
+		 */
+		paged_cow_dynarray(size_type size, size_type chunk_rows, const element_extents_type& extents) : size_(size), chunk_rows_(chunk_rows), extents_(extents) {
+			if (chunk_rows_ == 0) throw std::invalid_argument("multidim: chunk_rows must be positive");
+			chunks_.reserve(chunk_count());
+			for (size_type i = 0; i != chunk_count(); ++i) {
+				chunks_.push_back(detail::make_shared_elements<base_element>(rows_in_chunk(i) * extents_.stride()));
+			}
+		}
+		/**
+		 * Constructs an array with the given size and element_extents_type (inner dimensions), and the default chunk size.
+		 */
+		paged_cow_dynarray(size_type size, const element_extents_type& extents) : paged_cow_dynarray(size, default_chunk_rows(extents), extents) {}
+		/**
+		 * Copies the elements of an existing array into new (unshared) chunks.
+		 */
+		explicit paged_cow_dynarray(const dynarray_const_ref<T>& other, size_type chunk_rows = 0) : paged_cow_dynarray(other.size(), chunk_rows != 0 ? chunk_rows : default_chunk_rows(other.extents()), other.extents()) {
+			for (size_type i = 0; i != chunk_count(); ++i) {
+				std::copy_n(other.data() + i * chunk_rows_ * extents_.stride(), rows_in_chunk(i) * extents_.stride(), chunks_[i].get());
+			}
+		}
+		paged_cow_dynarray(const paged_cow_dynarray&) = default;
+		paged_cow_dynarray(paged_cow_dynarray&&) noexcept = default;
+		paged_cow_dynarray& operator=(const paged_cow_dynarray&) = default;
+		paged_cow_dynarray& operator=(paged_cow_dynarray&&) noexcept = default;
+
+		friend void swap(paged_cow_dynarray& a, paged_cow_dynarray& b) noexcept {
+			using std::swap;
+			swap(a.chunks_, b.chunks_);
+			swap(a.size_, b.size_);
+			swap(a.chunk_rows_, b.chunk_rows_);
+			swap(a.extents_, b.extents_);
+		}
+
+		size_type size() const noexcept { return size_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+		size_type chunk_rows() const noexcept { return chunk_rows_; }
+		size_type chunk_count() const noexcept { return (size_ + chunk_rows_ - 1) / chunk_rows_; }
+		/**
+		 * Gets the extents of elements that are stored in this array.
+		 */
+		const element_extents_type& extents() const noexcept { return extents_; }
+
+		/**
+		 * Checks whether chunk `index` is currently shared with another paged_cow_dynarray, i.e. whether the next write to it will copy it.
+		 */
+		bool shared(size_type index) const noexcept { return detail::shared_elements_in_use(chunks_[index]); }
+
+		/**
+		 * Gets a mutable view of chunk `index`, copying the chunk first if it is shared.
+		 */
+		chunk_ref chunk(size_type index) {
+			assert(index < chunk_count());
+			if (shared(index)) chunks_[index] = detail::clone_shared_elements(chunks_[index].get(), rows_in_chunk(index) * extents_.stride());
+			return chunk_ref{ chunks_[index].get(), container_extents_type{ rows_in_chunk(index), extents_ } };
+		}
+		/**
+		 * Gets a read-only view of chunk `index`.
+		 */
+		chunk_const_ref read_chunk(size_type index) const noexcept {
+			assert(index < chunk_count());
+			return chunk_const_ref{ chunks_[index].get(), container_extents_type{ rows_in_chunk(index), extents_ } };
+		}
+
+		/**
+		 * Gets a reference to the element at the specified index, copying its chunk first if it is shared.  It is undefined behaviour if index >= size().
+		 */
+		reference operator[](size_type index) {
+			assert(index < size_);
+			return chunk(index / chunk_rows_)[index % chunk_rows_];
+		}
+		const_reference operator[](size_type index) const noexcept { return read(index); }
+		reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		/**
+		 * Gets a read-only reference to the element at the specified index, without copying anything.  It is undefined behaviour if index >= size().
+		 */
+		const_reference read(size_type index) const noexcept {
+			assert(index < size_);
+			return read_chunk(index / chunk_rows_)[index % chunk_rows_];
+		}
+
+		/**
+		 * Compares if the array is elementwise equal to another array.  If they have different shape or different number of elements, then it will also return false.
+		 */
+		friend bool operator==(const paged_cow_dynarray& a, const dynarray_const_ref<T>& b) {
+			if (a.size_ != b.size() || a.extents_ != b.extents()) return false;
+			for (size_type i = 0; i != a.chunk_count(); ++i) {
+				if (a.read_chunk(i) != chunk_const_ref{ b.data() + i * a.chunk_rows_ * a.extents_.stride(), container_extents_type{ a.rows_in_chunk(i), a.extents_ } }) return false;
+			}
+			return true;
+		}
+		friend bool operator!=(const paged_cow_dynarray& a, const dynarray_const_ref<T>& b) { return !(a == b); };
+
+	private:
+		size_type rows_in_chunk(size_type index) const noexcept {
+			return index + 1 == chunk_count() ? size_ - index * chunk_rows_ : chunk_rows_;
+		}
+
+		std::vector<std::shared_ptr<base_element[]>> chunks_;
+		size_t size_; // the size of the current dimension
+		size_t chunk_rows_; // the number of elements of the current dimension in each chunk
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm> // for std::copy()
+#include <charconv> // for std::from_chars()
+#include <cstddef>
+#include <cstring> // for std::memchr()
+#include <exception> // for std::exception_ptr
+#include <istream>
+#include <string>
+#include <string_view>
+#include <system_error> // for std::errc
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "dynarray.hpp"
+#include "array.hpp"
+#include "vector.hpp"
+#include "serialize.hpp" // for format_error and the container helpers
+#include "core.hpp"
+
+/**
+ * Parsing delimited numeric text (e.g. CSV) into two-dimensional containers, such as vector<inner_dynarray<double>>.
+ * Each non-blank line becomes one row.  The number of columns is inferred from the first row (after the optional header line), and every row must have that many columns.
+ * Fields are parsed with std::from_chars(), directly into the storage of the container.
+ */
+
+namespace multidim {
+
+	struct csv_options {
+		/**
+		 * The character that separates fields.
+		 */
+		char delimiter = ',';
+		/**
+		 * Whether the first line is a header that should be ignored.
+		 */
+		bool skip_header = false;
+		/**
+		 * The number of threads used to parse each chunk.  Chunks are split at line boundaries, and each part is parsed into its own range of rows.
+		 */
+		size_t threads = 1;
+		/**
+		 * The number of bytes read from the stream at a time by read_csv().  The buffer grows if a single line is longer than this.
+		 */
+		size_t chunk_size = size_t{ 1 } << 20;
+	};
+
+	namespace detail {
+		/**
+		 * Calls f(line_first, line_last) for every non-blank line in [first, last), excluding the line terminator ("\n" or "\r\n").
+		 */
+		template <typename Func>
+		inline void for_each_csv_line(const char* first, const char* last, Func&& f) {
+			while (first != last) {
+				const char* nl = static_cast<const char*>(std::memchr(first, '\n', static_cast<size_t>(last - first)));
+				const char* const line_end = nl ? nl : last;
+				const char* trimmed_end = line_end;
+				if (trimmed_end != first && trimmed_end[-1] == '\r') --trimmed_end;
+				if (trimmed_end != first) f(first, trimmed_end);
+				first = nl ? nl + 1 : last;
+			}
+		}
+
+		inline size_t count_csv_rows(const char* first, const char* last) {
+			size_t ret = 0;
+			for_each_csv_line(first, last, [&ret](const char*, const char*) noexcept { ++ret; });
+			return ret;
+		}
+
+		inline const char* skip_csv_blanks(const char* first, const char* last, char delimiter) noexcept {
+			while (first != last && (*first == ' ' || *first == '\t') && *first != delimiter) ++first;
+			return first;
+		}
+
+		inline size_t count_csv_columns(const char* first, const char* last, char delimiter) noexcept {
+			size_t ret = 1;
+			for (; first != last; ++first) {
+				if (*first == delimiter) ++ret;
+			}
+			return ret;
+		}
+
+		[[noreturn]] inline void throw_csv_error(const char* what, size_t row) {
+			throw format_error(std::string("multidim: CSV row ") + std::to_string(row) + ": " + what);
+		}
+
+		/**
+		 * Parses one line into cols base elements.
+		 */
+		template <typename T>
+		inline void parse_csv_line(const char* first, const char* last, T* out, size_t cols, char delimiter, size_t row) {
+			for (size_t c = 0; c != cols; ++c) {
+				if (c != 0) {
+					if (first == last) throw_csv_error("too few columns", row);
+					if (*first != delimiter) throw_csv_error("invalid number", row);
+					++first;
+				}
+				first = skip_csv_blanks(first, last, delimiter);
+				if (first != last && *first == '+') ++first; // std::from_chars() does not accept a leading '+'
+				const auto [ptr, ec] = std::from_chars(first, last, out[c]);
+				if (ec != std::errc()) throw_csv_error(ec == std::errc::result_out_of_range ? "value out of range" : "invalid number", row);
+				first = skip_csv_blanks(ptr, last, delimiter);
+			}
+			if (first != last) throw_csv_error(*first == delimiter ? "too many columns" : "invalid number", row);
+		}
+
+		template <typename T>
+		inline void parse_csv_lines(const char* first, const char* last, T* out, size_t cols, char delimiter, size_t row) {
+			for_each_csv_line(first, last, [&](const char* line_first, const char* line_last) {
+				parse_csv_line(line_first, line_last, out, cols, delimiter, row);
+				out += cols;
+				++row;
+			});
+		}
+
+		/**
+		 * Parses a block of complete lines.  alloc(rows) is called once with the number of rows in the block, and must return a pointer to storage for that many rows.
+		 * row is the index of the first row in the block (for error messages).  Returns the number of rows parsed.
+		 */
+		template <typename T, typename Alloc>
+		inline size_t parse_csv_block(const char* first, const char* last, size_t cols, const csv_options& options, size_t row, Alloc&& alloc) {
+			const size_t parts = options.threads > 1 && static_cast<size_t>(last - first) >= options.threads * 4096 ? options.threads : 1;
+			if (parts == 1) {
+				const size_t rows = count_csv_rows(first, last);
+				T* const out = alloc(rows);
+				parse_csv_lines(first, last, out, cols, options.delimiter, row);
+				return rows;
+			}
+
+			// split at line boundaries
+			std::vector<const char*> bounds(parts + 1);
+			bounds[0] = first;
+			bounds[parts] = last;
+			for (size_t i = 1; i != parts; ++i) {
+				const char* mid = first + (last - first) * static_cast<std::ptrdiff_t>(i) / static_cast<std::ptrdiff_t>(parts);
+				if (mid < bounds[i - 1]) mid = bounds[i - 1];
+				const char* const nl = static_cast<const char*>(std::memchr(mid, '\n', static_cast<size_t>(last - mid)));
+				bounds[i] = nl ? nl + 1 : last;
+			}
+
+			// runs f(i) for every part, the last one on this thread, and rethrows the exception of the earliest part that failed
+			const auto run_parallel = [parts](auto&& f) {
+				std::vector<std::exception_ptr> errors(parts);
+				std::vector<std::thread> workers;
+				workers.reserve(parts - 1);
+				try {
+					for (size_t i = 0; i != parts - 1; ++i) {
+						workers.emplace_back([&f, &errors, i]() {
+							try { f(i); }
+							catch (...) { errors[i] = std::current_exception(); }
+						});
+					}
+					f(parts - 1);
+				}
+				catch (...) {
+					errors[parts - 1] = std::current_exception();
+					if (workers.size() != parts - 1) errors.insert(errors.begin(), std::current_exception()); // failed to start a thread
+				}
+				for (std::thread& worker : workers) worker.join();
+				for (const std::exception_ptr& error : errors) {
+					if (error) std::rethrow_exception(error);
+				}
+			};
+
+			std::vector<size_t> offsets(parts + 1);
+			run_parallel([&](size_t i) { offsets[i + 1] = count_csv_rows(bounds[i], bounds[i + 1]); });
+			for (size_t i = 0; i != parts; ++i) offsets[i + 1] += offsets[i];
+			T* const out = alloc(offsets[parts]);
+			run_parallel([&](size_t i) { parse_csv_lines(bounds[i], bounds[i + 1], out + offsets[i] * cols, cols, options.delimiter, row + offsets[i]); });
+			return offsets[parts];
+		}
+
+		/**
+		 * Gets the element extents of a row with the given number of columns.
+		 */
+		template <typename E>
+		inline E csv_row_extents(size_t cols) {
+			static_assert(std::is_same_v<std::decay_t<decltype(std::declval<const E&>().inner())>, unit_extent>, "CSV can only be parsed into two-dimensional containers");
+			if constexpr (E::is_dynamic) {
+				return E(cols);
+			}
+			else {
+				if (cols != E::top_extent()) throw format_error("multidim: CSV column count does not match compile-time extent");
+				return E();
+			}
+		}
+
+		/**
+		 * Finds the first line of data (after skipping the header, if requested), and sets cols to its column count.
+		 * If at_end is false, the last line in [first, last) is incomplete, so it is not looked at.
+		 * Returns false if there is no such line yet.  first is advanced past the header and blank lines.
+		 */
+		inline bool find_csv_columns(const char*& first, const char* last, bool at_end, bool& header_pending, char delimiter, size_t& cols) {
+			while (first != last) {
+				const char* const nl = static_cast<const char*>(std::memchr(first, '\n', static_cast<size_t>(last - first)));
+				if (!nl && !at_end) return false;
+				const char* line_end = nl ? nl : last;
+				if (line_end != first && line_end[-1] == '\r') --line_end;
+				if (header_pending) {
+					header_pending = false;
+				}
+				else if (line_end != first) {
+					cols = count_csv_columns(first, line_end, delimiter);
+					return true;
+				}
+				first = nl ? nl + 1 : last;
+			}
+			return false;
+		}
+	}
+
+	/**
+	 * Parses delimited text that is entirely in memory (e.g. a memory-mapped file) into a two-dimensional container X, such as dynarray<inner_dynarray<double>> or vector<inner_array<float, 3>>.
+	 * Throws format_error if a field is not a number or a row has the wrong number of columns.
+	 */
+	template <typename X>
+	inline X parse_csv(std::string_view text, const csv_options& options = {}) {
+		using base_element = typename X::base_element;
+		using extents_type = typename X::container_extents_type;
+		static_assert(extents_type::is_dynamic, "the outermost dimension must be dynamic");
+		const char* first = text.data();
+		const char* const last = text.data() + text.size();
+		bool header_pending = options.skip_header;
+		size_t cols = 0;
+		if (!detail::find_csv_columns(first, last, true, header_pending, options.delimiter, cols)) {
+			return detail::make_container<X>(extents_type(0, typename X::element_extents_type{}));
+		}
+		const auto row_extents = detail::csv_row_extents<typename X::element_extents_type>(cols);
+		X ret = detail::make_container<X>(extents_type(0, row_extents));
+		detail::parse_csv_block<base_element>(first, last, cols, options, 0, [&](size_t rows) {
+			ret = detail::make_container<X>(extents_type(rows, row_extents));
+			return ret.data();
+		});
+		return ret;
+	}
+
+	/**
+	 * Parses delimited text from a stream into a two-dimensional vector X, such as vector<inner_dynarray<double>>.
+	 * The stream is read in chunks of options.chunk_size bytes, and the rows of each chunk are parsed directly into new (uninitialized) rows at the back of the vector.
+	 * Throws format_error if a field is not a number or a row has the wrong number of columns.
+	 */
+	template <typename X>
+	inline X read_csv(std::istream& is, const csv_options& options = {}) {
+		using base_element = typename X::base_element;
+		using element_extents_type = typename X::element_extents_type;
+		X ret{ element_extents_type{} };
+		std::string buf(options.chunk_size > 0 ? options.chunk_size : 1, '\0');
+		size_t filled = 0; // bytes in buf, of which [0, filled) are valid
+		size_t begin = 0; // bytes before this have been consumed
+		bool header_pending = options.skip_header;
+		bool has_columns = false;
+		size_t cols = 0;
+		bool eof = false;
+		while (!eof) {
+			// move the partial line to the front and refill
+			std::copy(buf.begin() + static_cast<std::ptrdiff_t>(begin), buf.begin() + static_cast<std::ptrdiff_t>(filled), buf.begin());
+			filled -= begin;
+			begin = 0;
+			if (buf.size() - filled <= buf.size() / 2) buf.resize(buf.size() * 2); // a single line is longer than half of the buffer
+			is.read(buf.data() + filled, static_cast<std::streamsize>(buf.size() - filled));
+			filled += static_cast<size_t>(is.gcount());
+			if (filled < buf.size()) {
+				if (!is.eof()) throw std::ios_base::failure("multidim: stream read failed");
+				eof = true;
+				if (filled != 0 && buf[filled - 1] != '\n') buf[filled++] = '\n'; // there is always space, since the read was short
+			}
+
+			const char* first = buf.data();
+			const char* const last_complete = [&]() {
+				for (size_t i = filled; i != 0; --i) {
+					if (buf[i - 1] == '\n') return buf.data() + i;
+				}
+				return buf.data();
+			}();
+			if (!has_columns) {
+				if (!detail::find_csv_columns(first, last_complete, false, header_pending, options.delimiter, cols)) {
+					begin = static_cast<size_t>(first - buf.data());
+					continue;
+				}
+				has_columns = true;
+				ret = X(detail::csv_row_extents<element_extents_type>(cols));
+			}
+			detail::parse_csv_block<base_element>(first, last_complete, cols, options, ret.size(), [&ret](size_t rows) {
+				const size_t old_size = ret.size();
+				ret.resize_for_overwrite(old_size + rows);
+				return ret.data() + old_size * ret.extents().stride();
+			});
+			begin = static_cast<size_t>(last_complete - buf.data());
+		}
+		return ret;
+	}
+}
@@ -2,40 +2,207 @@
 
 #include <algorithm>
 #include <memory>
+#include <type_traits>
+#include <utility> // for std::move()
+
+#include "page_allocation.hpp"
 
 namespace multidim {
+	/**
+	 * Buffer kind of buffers (and containers) that own a heap buffer and free it with delete[].  This is the default, and costs nothing beyond the pointer itself.
+	 */
+	struct plain_buffer {};
+	/**
+	 * Buffer kind of buffers (and containers) that remember a buffer_policy (e.g. to use huge pages), and that can be freed by any deleter (e.g. one from a decoder library that produced the buffer).
+	 * This makes every buffer hold a buffer_deleter, so only use it for containers that need these features.
+	 */
+	struct managed_buffer {};
+
+	/**
+	 * The deleter of the buffers owned by managed dynamic_buffers (and hence by dynarray and vector with managed_buffer).
+	 * By default it frees the buffer with delete[], but it can also hold any other deleter, so that buffers can change owners without copying.
+	 * It also remembers the buffer_policy of the buffer, so that containers can allocate replacement buffers the same way.
+	 */
+	template <typename T>
+	class buffer_deleter {
+	public:
+		constexpr buffer_deleter() noexcept = default;
+		/**
+		 * A deleter that uses delete[], for a buffer that was allocated with the given policy.
+		 */
+		constexpr explicit buffer_deleter(const buffer_policy& policy) noexcept : policy_(policy) {}
+		/**
+		 * A deleter that calls d(ptr).  Allocates a small object to hold d, unless D is std::default_delete<T[]>.
+		 */
+		template <typename D, typename = std::enable_if_t<!std::is_same_v<std::decay_t<D>, buffer_deleter> && !std::is_same_v<std::decay_t<D>, buffer_policy> && std::is_invocable_v<D&, T*>>>
+		explicit buffer_deleter(D&& d, const buffer_policy& policy = {}) : policy_(policy) {
+			if constexpr (!std::is_same_v<std::decay_t<D>, std::default_delete<T[]>>) {
+				custom_ = std::make_unique<custom_deleter<std::decay_t<D>>>(std::forward<D>(d));
+			}
+		}
+
+		void operator()(T* ptr) const noexcept {
+			if (custom_) (*custom_)(ptr);
+			else delete[] ptr;
+		}
+		/**
+		 * Gets the policy of the buffer.
+		 */
+		constexpr const buffer_policy& policy() const noexcept { return policy_; }
+
+	private:
+		struct custom_deleter_base {
+			virtual ~custom_deleter_base() = default;
+			virtual void operator()(T* ptr) noexcept = 0;
+		};
+		template <typename D>
+		struct custom_deleter final : custom_deleter_base {
+			explicit custom_deleter(D&& d) : d_(std::move(d)) {}
+			explicit custom_deleter(const D& d) : d_(d) {}
+			void operator()(T* ptr) noexcept override { d_(ptr); }
+			D d_;
+		};
+
+		std::unique_ptr<custom_deleter_base> custom_; // nullptr for delete[]
+		buffer_policy policy_;
+	};
+
+	/**
+	 * An owning pointer to the buffer of a dynamic_buffer, as returned by release() of the containers.
+	 */
+	template <typename T>
+	using buffer_ptr = std::unique_ptr<T[], buffer_deleter<T>>;
+
+	/**
+	 * Converts an owning pointer with any deleter to a buffer_ptr.  Nothing is copied.
+	 * Wrapping a custom deleter allocates; if that fails, the buffer is freed with its own deleter before the exception propagates.
+	 */
+	template <typename T, typename D>
+	inline buffer_ptr<T> to_buffer_ptr(std::unique_ptr<T[], D>&& ptr) {
+		if constexpr (std::is_same_v<D, buffer_deleter<T>>) {
+			return std::move(ptr);
+		}
+		else {
+			try {
+				buffer_deleter<T> deleter(std::move(ptr.get_deleter()));
+				return buffer_ptr<T>(ptr.release(), std::move(deleter));
+			}
+			catch (...) {
+				ptr.reset();
+				throw;
+			}
+		}
+	}
+
 	/**
 	 * Class that represents a buffer whose size is known at construction time, like a std::unique_ptr<T[]>.
-	 * The buffer is located on the heap.
+	 * A plain buffer is located on the heap.  A managed buffer is located on the heap, in pages mapped according to a buffer_policy, or wherever its buffer_deleter expects.
 	 * This class is a simple RAII class that owns its buffer, and will free the memory when it is destructed.  However, for efficiency, it does not know the size of its own buffer.
+	 * @tparam Kind plain_buffer or managed_buffer
 	 */
-	template <typename T>
+	template <typename T, typename Kind = plain_buffer>
 	class dynamic_buffer {
+		static_assert(std::is_same_v<Kind, plain_buffer> || std::is_same_v<Kind, managed_buffer>, "the buffer kind must be plain_buffer or managed_buffer");
+		constexpr static bool is_managed = std::is_same_v<Kind, managed_buffer>;
 	public:
+		/**
+		 * The owning pointer that release() returns: a std::unique_ptr<T[]> for plain buffers, or a buffer_ptr<T> for managed buffers.
+		 */
+		using owning_ptr = std::conditional_t<is_managed, buffer_ptr<T>, std::unique_ptr<T[]>>;
+
 		constexpr T* data() noexcept { return buf_.get(); }
 		constexpr const T* data() const noexcept { return buf_.get(); }
 		constexpr dynamic_buffer() = default;
-		constexpr dynamic_buffer(size_t sz) noexcept : buf_(std::make_unique<T[]>(sz)) {}
-		constexpr dynamic_buffer(std::unique_ptr<T[]>&& ptr) noexcept : buf_(std::move(ptr)) {}
+		constexpr dynamic_buffer(size_t sz) noexcept : buf_(std::make_unique<T[]>(sz).release()) {}
+		constexpr dynamic_buffer(std::unique_ptr<T[]>&& ptr) noexcept : buf_(ptr.release()) {}
+		/**
+		 * Constructs an empty managed buffer that remembers the given policy.
+		 */
+		constexpr explicit dynamic_buffer(const buffer_policy& policy) noexcept : buf_(nullptr, buffer_deleter<T>(policy)) {
+			static_assert(is_managed, "only managed buffers have a buffer policy");
+		}
+		/**
+		 * Constructs a managed buffer of sz value-initialized elements, allocated according to the given policy.
+		 */
+		dynamic_buffer(size_t sz, const buffer_policy& policy) : buf_(allocate(sz, policy)) {
+			static_assert(is_managed, "only managed buffers have a buffer policy");
+		}
+		/**
+		 * Takes ownership of a heap buffer, and remembers the given policy for buffers that are allocated to replace it.
+		 */
+		constexpr dynamic_buffer(std::unique_ptr<T[]>&& ptr, const buffer_policy& policy) noexcept : buf_(ptr.release(), buffer_deleter<T>(policy)) {
+			static_assert(is_managed, "only managed buffers have a buffer policy");
+		}
+		/**
+		 * Takes ownership of a buffer with any deleter, for a managed buffer.
+		 */
+		constexpr dynamic_buffer(buffer_ptr<T>&& ptr) noexcept : buf_(std::move(ptr)) {
+			static_assert(is_managed, "only managed buffers can hold a custom deleter");
+		}
 		constexpr dynamic_buffer(const dynamic_buffer&) noexcept = delete;
 		constexpr dynamic_buffer(dynamic_buffer&&) noexcept = default;
 		constexpr dynamic_buffer& operator=(const dynamic_buffer&) noexcept = delete;
 		constexpr dynamic_buffer& operator=(dynamic_buffer&&) noexcept = default;
 		/**
-		 * Creates a new buffer with a copy of the data from the current one.
+		 * Creates a new buffer of sz value-initialized elements, allocated the same way as this one (i.e. with the same policy, for a managed buffer).
+		 */
+		constexpr dynamic_buffer allocate_like(size_t sz) const {
+			if constexpr (is_managed) return dynamic_buffer(sz, policy());
+			else return dynamic_buffer(sz);
+		}
+		/**
+		 * Creates a new buffer with a copy of the data from the current one, allocated the same way as this one.
 		 * Note: If the size of the current buffer is actually smaller than the specified elements to copy, then behaviour is undefined.
 		 * @param sz the size to copy
 		 */
 		constexpr dynamic_buffer clone(size_t sz) const {
-			std::unique_ptr<T[]> tmp = std::make_unique<T[]>(sz);
-			std::copy_n(data(), sz, tmp.get());
-			return dynamic_buffer(std::move(tmp));
+			dynamic_buffer tmp = allocate_like(sz);
+			std::copy_n(data(), sz, tmp.data());
+			return tmp;
+		}
+		/**
+		 * Gives up ownership of the buffer, leaving this buffer empty (but still with the same policy, for a managed buffer).
+		 */
+		constexpr owning_ptr release() noexcept {
+			if constexpr (is_managed) {
+				buffer_ptr<T> ret(nullptr, buffer_deleter<T>(policy()));
+				ret.swap(buf_);
+				return ret;
+			}
+			else {
+				return std::move(buf_);
+			}
+		}
+		/**
+		 * Gets the policy that this managed buffer was allocated with.
+		 */
+		constexpr const buffer_policy& policy() const noexcept {
+			static_assert(is_managed, "only managed buffers have a buffer policy");
+			return buf_.get_deleter().policy();
 		}
 		friend void swap(dynamic_buffer& a, dynamic_buffer& b) noexcept {
 			using std::swap;
 			swap(a.buf_, b.buf_);
 		}
 	private:
-		std::unique_ptr<T[]> buf_;
+		static buffer_ptr<T> allocate(size_t sz, const buffer_policy& policy) {
+			if constexpr (std::is_trivial_v<T>) {
+				if (detail::use_page_allocation(sz * sizeof(T), policy)) {
+					size_t mapped_bytes;
+					void* const ptr = detail::allocate_pages(sz * sizeof(T), policy, mapped_bytes);
+					try {
+						buffer_deleter<T> deleter([mapped_bytes](T* p) noexcept { detail::unmap_pages(p, mapped_bytes); }, policy);
+						return buffer_ptr<T>(static_cast<T*>(ptr), std::move(deleter)); // mapped pages are zero, which is the value of trivial elements after value-initialization
+					}
+					catch (...) {
+						detail::unmap_pages(ptr, mapped_bytes);
+						throw;
+					}
+				}
+			}
+			return buffer_ptr<T>(std::make_unique<T[]>(sz).release(), buffer_deleter<T>(policy)); // small buffers and non-trivial elements stay on the heap
+		}
+
+		owning_ptr buf_;
 	};
 }
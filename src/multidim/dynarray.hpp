@@ -6,11 +6,12 @@
 #include <type_traits>
 
 #include "core.hpp"
+#include "compare.hpp"
 #include "iterator.hpp"
 
 namespace multidim {
 
-	template <typename T>
+	template <typename T, typename BufferKind = plain_buffer>
 	class dynarray;
 	template <typename T>
 	class dynarray_ref;
@@ -89,7 +90,7 @@ namespace multidim {
 	/**
 	 * Base class for dynarray.  This is an internal library implementation and should not be used directly by users.
 	 */
-	template <typename Dynarray, typename T, bool Owning, bool IsConst>
+	template <typename Dynarray, typename T, bool Owning, bool IsConst, typename BufferKind = plain_buffer>
 	class dynarray_base {
 	public:
 		using value_type = typename element_traits<T>::value_type;
@@ -106,7 +107,7 @@ namespace multidim {
 		using element_extents_type = typename element_traits<T>::extents_type;
 		using container_extents_type = dynamic_extent<element_extents_type>;
 		using base_element = typename element_traits<T>::base_element;
-		using buffer_type = dynamic_buffer<base_element>;
+		using buffer_type = dynamic_buffer<base_element, BufferKind>;
 
 		constexpr size_type size() const noexcept { return size_; }
 		constexpr size_type max_size() const noexcept { return size_; }
@@ -115,6 +116,11 @@ namespace multidim {
 		constexpr const_iterator cend() const noexcept { return multidim::const_iterator<T>(static_cast<const Dynarray&>(*this).data_offset(size_), extents_, size_); }
 		constexpr const_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
 		constexpr const_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+
+		/**
+		 * Gets the extents of elements that are stored in this dynarray.
+		 */
+		constexpr const element_extents_type& extents() const noexcept { return extents_; }
 	protected:
 		using underlying_store = std::conditional_t<Owning, buffer_type, std::conditional_t<IsConst, const base_element*, base_element*>>;
 		template <typename... Args>
@@ -134,11 +140,6 @@ namespace multidim {
 			swap(extents_, other.extents_);
 		}
 
-		/**
-		 * Gets the extents of elements that are stored in this dynarray.
-		 */
-		constexpr const element_extents_type& extents() const noexcept { return extents_; }
-
 		underlying_store data_;
 		size_t size_; // the size of the current dimension
 #if defined(__GNUC__)
@@ -159,11 +160,12 @@ namespace multidim {
 	/**
 	 * Represents a multidimensional array whose outermost dimension is an array with a size that is known at construction time.
 	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 * @tparam BufferKind plain_buffer, or managed_buffer to support buffer policies and adopting buffers with custom deleters (see dynamic_buffer)
 	 */
-	template <typename T>
-	class dynarray : public dynarray_base<dynarray<T>, T, true, false> {
+	template <typename T, typename BufferKind>
+	class dynarray : public dynarray_base<dynarray<T, BufferKind>, T, true, false, BufferKind> {
 	public:
-		using B = dynarray_base<dynarray<T>, T, true, false>;
+		using B = dynarray_base<dynarray<T, BufferKind>, T, true, false, BufferKind>;
 		constexpr dynarray(const dynarray& other) : B(other.size_, other.extents_, other.data_.clone(other.size_ * other.extents_.stride())) {}
 		constexpr dynarray(dynarray&& other) noexcept(std::is_nothrow_move_constructible_v<typename B::buffer_type>) : B(other.size_, other.extents_, std::move(other.data_)) {
 			other.size_ = 0;
@@ -180,6 +182,50 @@ namespace multidim {
 		template <typename TN, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TN>, std::is_convertible<size_t, TNs>...>>>
 		constexpr explicit dynarray(TN n, TNs... ns) noexcept : dynarray(n, typename B::element_extents_type(ns...)) {}
 		constexpr explicit dynarray() noexcept : dynarray(0, typename B::element_extents_type()) {}
+		/**
+		 * Constructs a dynarray from the given size (current dimension) and element_extents_type (inner dimensions), allocating its buffer according to the given policy.  The dynarray must use managed_buffer.
+		 */
+		explicit dynarray(const buffer_policy& policy, size_t size, const typename B::element_extents_type& extents) : B(size, extents, size * extents.stride(), policy) {
+			static_assert(std::is_same_v<BufferKind, managed_buffer>, "buffer policies need a dynarray with managed_buffer");
+		}
+		/**
+		 * Constructs a dynarray from the given dimensions, allocating its buffer according to the given policy (e.g. to use huge pages).
+		 */
+		template <typename TN, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TN>, std::is_convertible<size_t, TNs>...>>>
+		explicit dynarray(const buffer_policy& policy, TN n, TNs... ns) : dynarray(policy, n, typename B::element_extents_type(ns...)) {}
+		/**
+		 * Constructs a dynarray that takes ownership of an existing buffer, which must hold at least size * extents.stride() initialized base elements.  This should not generally be used directly.
+		 */
+		constexpr explicit dynarray(size_t size, const typename B::element_extents_type& extents, typename B::buffer_type&& buf) noexcept : B(size, extents, std::move(buf)) {}
+		/**
+		 * Constructs a dynarray that takes ownership of an existing buffer of size * extents.stride() initialized base elements, given the element_extents_type (inner dimensions).
+		 * Nothing is copied, and the buffer is eventually freed by its own deleter.  Other deleters than std::default_delete (e.g. one from the library that produced the buffer) need a dynarray with managed_buffer.
+		 * Holding a custom deleter allocates a small object; if that throws, the buffer is freed with its own deleter.
+		 */
+		template <typename D>
+		static dynarray adopt(std::unique_ptr<typename B::base_element[], D>&& buf, size_t size, const typename B::element_extents_type& extents) {
+			if constexpr (std::is_same_v<BufferKind, managed_buffer>) {
+				return dynarray(size, extents, typename B::buffer_type(to_buffer_ptr(std::move(buf))));
+			}
+			else {
+				static_assert(std::is_same_v<D, std::default_delete<typename B::base_element[]>>, "adopting a buffer with a custom deleter needs a dynarray with managed_buffer");
+				return dynarray(size, extents, typename B::buffer_type(std::move(buf)));
+			}
+		}
+		/**
+		 * Constructs a dynarray that takes ownership of an existing buffer of initialized base elements, given the dimensions.
+		 */
+		template <typename D, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		static dynarray adopt(std::unique_ptr<typename B::base_element[], D>&& buf, size_t size, TNs... ns) {
+			return adopt(std::move(buf), size, typename B::element_extents_type(ns...));
+		}
+		/**
+		 * Constructs a dynarray that takes ownership of an existing buffer of initialized base elements, which will be freed with deleter(ptr), given the dimensions.
+		 */
+		template <typename D, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		static dynarray adopt(typename B::base_element* ptr, D deleter, size_t size, TNs... ns) {
+			return adopt(std::unique_ptr<typename B::base_element[], D>(ptr, std::move(deleter)), size, typename B::element_extents_type(ns...));
+		}
 		constexpr dynarray& operator=(const dynarray& other) {
 			if (this->size_ != other.size_ || this->extents_ != other.extents_) {
 				this->size_ = other.size_;
@@ -214,6 +260,17 @@ namespace multidim {
 			B::swap(other);
 		}
 
+		/**
+		 * Gives up ownership of the buffer, which holds size() * extents().stride() base elements, leaving this dynarray empty.  Nothing is copied.
+		 * This returns a std::unique_ptr<base_element[]> for a dynarray with plain_buffer, or a buffer_ptr<base_element> (which keeps the deleter and policy) for a dynarray with managed_buffer.
+		 * Note: The size and extents are reset too, so read them before calling this.
+		 */
+		typename B::buffer_type::owning_ptr release() noexcept {
+			this->size_ = 0;
+			this->extents_ = typename B::element_extents_type();
+			return this->data_.release();
+		}
+
 		/**
 		 * Assign to this container some data starting from the given iterator.  The number of elements copied is determined by the size of this container.  Behaviour is undefined if there are not enough elements starting from the given iterator, or if the element extents don't match.
 		 */
@@ -305,7 +362,7 @@ namespace multidim {
 			return static_cast<dynarray_const_ref<T>>(a) == b;
 		}
 		friend constexpr MULTIDIM_FORCEINLINE bool operator!=(const dynarray& a, const dynarray_const_ref<T>& b) { return !(a == b); };
-		// Note: We don't provide lexicographical comparison because it isn't clear what it means to compare arrays of different shape.
+		// Note: We don't provide lexicographical comparison operators because it isn't clear what it means to compare arrays of different shape.  Use lex_compare() or lex_less for arrays of the same shape.
 	};
 
 	/**
@@ -429,6 +486,12 @@ namespace multidim {
 			return static_cast<dynarray_const_ref<T>>(a) == b;
 		}
 		friend constexpr MULTIDIM_FORCEINLINE bool operator!=(const dynarray_ref& a, const dynarray_const_ref<T>& b) { return !(a == b); };
+#ifdef MULTIDIM_HAS_THREE_WAY_COMPARISON
+		/**
+		 * Lexicographically compares two dynarray_refs of the same shape by their base elements (see lex_compare()).
+		 */
+		friend constexpr detail::three_way_ordering_t<typename B::base_element> operator<=>(const dynarray_ref& a, const dynarray_const_ref<T>& b) { return detail::lex_compare_three_way(a, b); }
+#endif
 
 		constexpr operator dynarray_const_ref<T>() noexcept { return dynarray_const_ref<T>{ this->data_, typename B::container_extents_type{ this->size_, this->extents_ } }; }
 
@@ -497,9 +560,15 @@ namespace multidim {
 		 * Compares if two dynarray_const_refs are elementwise equal.  If they have different shape or different number of elements, then it will also return false.
 		 */
 		friend constexpr MULTIDIM_FORCEINLINE bool operator==(const dynarray_const_ref& a, const dynarray_const_ref& b) {
-			return a.size_ == b.size_ && a.extents_ == b.extents_ && std::equal(a.data(), a.data_offset(a.size_), b.data());
+			return a.size_ == b.size_ && a.extents_ == b.extents_ && detail::equal_n(a.data(), b.data(), a.size_ * a.extents_.stride());
 		}
 		friend constexpr MULTIDIM_FORCEINLINE bool operator!=(const dynarray_const_ref& a, const dynarray_const_ref& b) { return !(a == b); };
+#ifdef MULTIDIM_HAS_THREE_WAY_COMPARISON
+		/**
+		 * Lexicographically compares two dynarray_const_refs of the same shape by their base elements (see lex_compare()).
+		 */
+		friend constexpr detail::three_way_ordering_t<typename B::base_element> operator<=>(const dynarray_const_ref& a, const dynarray_const_ref& b) { return detail::lex_compare_three_way(a, b); }
+#endif
 
 		/**
 		 * Rebinds this reference to another dynarray_const_ref.
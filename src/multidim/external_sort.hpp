@@ -0,0 +1,393 @@
+#pragma once
+
+#if !(__has_include(<fcntl.h>) && __has_include(<unistd.h>))
+#error "multidim/external_sort.hpp requires POSIX file I/O"
+#endif
+
+#include <algorithm> // for std::min()
+#include <cerrno>
+#include <cstddef>
+#include <cstdio> // for std::remove()
+#include <functional> // for std::less
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "dynarray.hpp"
+#include "alg_sort.hpp"
+#include "serialize.hpp" // for the binary format
+#include "core.hpp"
+
+/**
+ * Sorting sets of rows that do not fit in memory.
+ * The input is read into buffers of at most the given memory budget, and each buffer is sorted in memory and spilled to a temporary file (a "run").
+ * The runs are then merged with a k-way merge; if there are too many runs to give each one a reasonably sized buffer, they are merged in several passes.
+ * All files (including the output) are in the binary format of serialize.hpp, as a dynarray<T>, so the output can be read back with load<dynarray<T>>() or viewed with view<dynarray<T>>().
+ */
+
+namespace multidim {
+
+	namespace detail {
+		// the smallest block (in bytes) that each run gets during a merge; this limits the number of runs merged at once
+		constexpr inline size_t external_sort_min_block = 4096;
+
+		/**
+		 * An open file descriptor, with positioned reads and writes.
+		 */
+		class sort_file {
+		public:
+			sort_file(const char* path, int flags) : fd_(::open(path, flags | O_CLOEXEC, 0666)) {
+				if (fd_ == -1) throw std::system_error(errno, std::generic_category(), "multidim: open() failed");
+			}
+			sort_file(const sort_file&) = delete;
+			sort_file& operator=(const sort_file&) = delete;
+			~sort_file() { ::close(fd_); }
+
+			void read_at(void* buf, size_t bytes, size_t offset) const {
+				char* ptr = static_cast<char*>(buf);
+				while (bytes != 0) {
+					const ssize_t res = ::pread(fd_, ptr, bytes, static_cast<off_t>(offset));
+					if (res < 0) {
+						if (errno == EINTR) continue;
+						throw std::system_error(errno, std::generic_category(), "multidim: pread() failed");
+					}
+					if (res == 0) throw format_error("multidim: unexpected end of file");
+					ptr += res;
+					bytes -= static_cast<size_t>(res);
+					offset += static_cast<size_t>(res);
+				}
+			}
+			void write_at(const void* buf, size_t bytes, size_t offset) const {
+				const char* ptr = static_cast<const char*>(buf);
+				while (bytes != 0) {
+					const ssize_t res = ::pwrite(fd_, ptr, bytes, static_cast<off_t>(offset));
+					if (res < 0) {
+						if (errno == EINTR) continue;
+						throw std::system_error(errno, std::generic_category(), "multidim: pwrite() failed");
+					}
+					ptr += res;
+					bytes -= static_cast<size_t>(res);
+					offset += static_cast<size_t>(res);
+				}
+			}
+
+		private:
+			int fd_;
+		};
+
+		/**
+		 * Writes the header of a serialized dynarray<T> with the given number of rows, and the padding after its payload.
+		 * Returns the offset of the payload.
+		 */
+		template <typename T>
+		inline size_t write_rows_header(const sort_file& file, size_t rows, const typename element_traits<T>::extents_type& extents) {
+			using X = dynarray<T>;
+			using extents_type = typename X::container_extents_type;
+			const size_t payload_size = rows * extents.stride() * sizeof(typename X::base_element);
+			const binary_header header = make_header<X>(payload_size);
+			binary_extent_entry entries[extent_rank<extents_type>::value + 1]{};
+			extent_codec<extents_type>::encode(extents_type(rows, extents), entries);
+			static constexpr char zeros[binary_alignment] = {};
+			file.write_at(&header, sizeof(header), 0);
+			file.write_at(entries, extent_rank<extents_type>::value * sizeof(binary_extent_entry), sizeof(header));
+			file.write_at(zeros, header.header_size - sizeof(header) - extent_rank<extents_type>::value * sizeof(binary_extent_entry), sizeof(header) + extent_rank<extents_type>::value * sizeof(binary_extent_entry));
+			file.write_at(zeros, pad_to_alignment(payload_size) - payload_size, static_cast<size_t>(header.header_size) + payload_size);
+			return static_cast<size_t>(header.header_size);
+		}
+
+		/**
+		 * Writes the first rows of a buffer as a serialized dynarray<T>.
+		 */
+		template <typename T>
+		inline void write_run(const char* path, const dynarray<T>& buf, size_t rows) {
+			const sort_file file(path, O_WRONLY | O_CREAT | O_TRUNC);
+			const size_t offset = write_rows_header<T>(file, rows, buf.extents());
+			file.write_at(buf.data(), rows * buf.extents().stride() * sizeof(typename dynarray<T>::base_element), offset);
+		}
+
+		/**
+		 * Reads the rows of a serialized dynarray<T> one block at a time.  The next block is read in the background while the current one is being consumed.
+		 */
+		template <typename T>
+		class run_reader {
+		public:
+			using element_extents_type = typename element_traits<T>::extents_type;
+			using const_reference = typename element_traits<T>::const_reference;
+
+			run_reader(const char* path, size_t block_rows, const element_extents_type& extents) :
+				file_(path, O_RDONLY), current_(block_rows, extents), next_(block_rows, extents), pos_(0), filled_(0) {
+				using X = dynarray<T>;
+				using extents_type = typename X::container_extents_type;
+				binary_header header;
+				file_.read_at(&header, sizeof(header), 0);
+				check_header<X>(header);
+				if (header.codec != binary_codec::raw) throw format_error("multidim: unsupported codec");
+				binary_extent_entry entries[extent_rank<extents_type>::value + 1];
+				file_.read_at(entries, extent_rank<extents_type>::value * sizeof(binary_extent_entry), sizeof(header));
+				remaining_ = decode_extents<X>(header, entries).top_extent();
+				offset_ = static_cast<size_t>(header.header_size);
+				start_read();
+				next_block();
+			}
+
+			bool empty() const noexcept { return pos_ == filled_; }
+			const_reference front() const noexcept { return current_[pos_]; }
+			void pop() {
+				if (++pos_ == filled_) next_block();
+			}
+
+		private:
+			void start_read() {
+				if (remaining_ == 0) return;
+				const size_t rows = std::min(remaining_, next_.size());
+				const size_t bytes = rows * next_.extents().stride() * sizeof(typename dynarray<T>::base_element);
+				pending_ = std::async(std::launch::async, [file = &file_, buf = next_.data(), bytes, offset = offset_, rows]() {
+					file->read_at(buf, bytes, offset);
+					return rows;
+				});
+				remaining_ -= rows;
+				offset_ += bytes;
+			}
+			void next_block() {
+				pos_ = 0;
+				filled_ = pending_.valid() ? pending_.get() : 0;
+				using std::swap;
+				swap(current_, next_);
+				start_read();
+			}
+
+			sort_file file_;
+			dynarray<T> current_;
+			dynarray<T> next_;
+			size_t pos_; // index of the front row in current_
+			size_t filled_; // number of valid rows in current_
+			size_t remaining_; // number of rows not yet requested from the file
+			size_t offset_; // file offset of the first row not yet requested
+			std::future<size_t> pending_; // the read into next_; declared last, so that it finishes before the buffers are destroyed
+		};
+
+		/**
+		 * Writes rows as a serialized dynarray<T> one block at a time.  Each full block is written in the background while the next one is being filled.
+		 * The header is written by finish(), once the number of rows is known.
+		 */
+		template <typename T>
+		class run_writer {
+		public:
+			using element_extents_type = typename element_traits<T>::extents_type;
+
+			run_writer(const char* path, size_t block_rows, const element_extents_type& extents) :
+				file_(path, O_WRONLY | O_CREAT | O_TRUNC), current_(block_rows, extents), next_(block_rows, extents), pos_(0), rows_(0), offset_(pad_to_alignment(sizeof(binary_header) + extent_rank<dynamic_extent<element_extents_type>>::value * sizeof(binary_extent_entry))) {}
+
+			template <typename Row>
+			void push(const Row& row) {
+				current_[pos_] = row;
+				if (++pos_ == current_.size()) flush_block();
+			}
+			void finish() {
+				if (pos_ != 0) flush_block();
+				if (pending_.valid()) pending_.get();
+				write_rows_header<T>(file_, rows_, current_.extents());
+			}
+
+		private:
+			void flush_block() {
+				if (pending_.valid()) pending_.get();
+				using std::swap;
+				swap(current_, next_);
+				const size_t bytes = pos_ * next_.extents().stride() * sizeof(typename dynarray<T>::base_element);
+				pending_ = std::async(std::launch::async, [file = &file_, buf = next_.data(), bytes, offset = offset_]() {
+					file->write_at(buf, bytes, offset);
+				});
+				offset_ += bytes;
+				rows_ += pos_;
+				pos_ = 0;
+			}
+
+			sort_file file_;
+			dynarray<T> current_;
+			dynarray<T> next_;
+			size_t pos_; // number of rows in current_
+			size_t rows_; // number of rows handed to the file so far
+			size_t offset_; // file offset of the next block
+			std::future<void> pending_; // the write from next_; declared last, so that it finishes before the buffers are destroyed
+		};
+
+		/**
+		 * A tournament tree over k sequences, where each internal node remembers the loser of the match played there.
+		 * Replacing the winner only replays the matches on its path to the root, so each output element costs about log2(k) comparisons.
+		 * less(i, j) returns whether the front of sequence i should come before the front of sequence j (exhausted sequences lose to everything).
+		 */
+		class loser_tree {
+		public:
+			template <typename Less>
+			loser_tree(size_t k, Less& less) : k_(k), nodes_(k) {
+				std::vector<size_t> winners(2 * k);
+				for (size_t i = 0; i != k; ++i) winners[k + i] = i;
+				for (size_t n = k - 1; n > 0; --n) {
+					const size_t a = winners[2 * n];
+					const size_t b = winners[2 * n + 1];
+					if (less(b, a)) {
+						winners[n] = b;
+						nodes_[n] = a;
+					}
+					else {
+						winners[n] = a;
+						nodes_[n] = b;
+					}
+				}
+				nodes_[0] = k > 1 ? winners[1] : 0;
+			}
+
+			size_t winner() const noexcept { return nodes_[0]; }
+
+			/**
+			 * Replays the matches of the winner, after the front of its sequence has changed.
+			 */
+			template <typename Less>
+			void replay(Less& less) {
+				size_t w = nodes_[0];
+				for (size_t n = (w + k_) / 2; n > 0; n /= 2) {
+					if (less(nodes_[n], w)) std::swap(nodes_[n], w);
+				}
+				nodes_[0] = w;
+			}
+
+		private:
+			size_t k_;
+			std::vector<size_t> nodes_; // nodes_[0] is the overall winner, nodes_[1..k) are the losers of the internal nodes
+		};
+
+		/**
+		 * Merges the sorted runs at the given paths into the output file, splitting the memory budget evenly between the blocks of the readers and the writer.
+		 */
+		template <typename T, typename Compare>
+		inline void merge_runs(const std::vector<std::string>& inputs, const char* output_path, size_t memory_budget, const typename element_traits<T>::extents_type& extents, Compare& comp) {
+			const size_t row_bytes = std::max<size_t>(1, extents.stride() * sizeof(typename element_traits<T>::base_element));
+			const size_t block_rows = std::max<size_t>(1, memory_budget / (2 * (inputs.size() + 1)) / row_bytes);
+			std::vector<std::unique_ptr<run_reader<T>>> readers;
+			readers.reserve(inputs.size());
+			for (const std::string& input : inputs) {
+				readers.push_back(std::make_unique<run_reader<T>>(input.c_str(), block_rows, extents));
+			}
+			run_writer<T> writer(output_path, block_rows, extents);
+			const auto less = [&readers, &comp](size_t i, size_t j) {
+				if (readers[i]->empty()) return false;
+				if (readers[j]->empty()) return true;
+				return static_cast<bool>(comp(readers[i]->front(), readers[j]->front()));
+			};
+			loser_tree tree(readers.size(), less);
+			while (!readers[tree.winner()]->empty()) {
+				run_reader<T>& reader = *readers[tree.winner()];
+				writer.push(reader.front());
+				reader.pop();
+				tree.replay(less);
+			}
+			writer.finish();
+		}
+
+		/**
+		 * Owns temporary files, and removes them when destroyed.
+		 */
+		class temp_files {
+		public:
+			explicit temp_files(std::string prefix) : prefix_(std::move(prefix)), counter_(0) {}
+			temp_files(const temp_files&) = delete;
+			temp_files& operator=(const temp_files&) = delete;
+			~temp_files() {
+				for (const std::string& path : paths_) std::remove(path.c_str());
+			}
+
+			const std::string& create() {
+				paths_.push_back(prefix_ + std::to_string(counter_++));
+				return paths_.back();
+			}
+			void remove(const std::string& path) {
+				std::remove(path.c_str());
+				paths_.erase(std::find(paths_.begin(), paths_.end(), path));
+			}
+
+		private:
+			std::string prefix_;
+			size_t counter_;
+			std::vector<std::string> paths_;
+		};
+	}
+
+	/**
+	 * Sorts the rows in [first, last) into a file at output_path, using about memory_budget bytes of memory for row buffers, however many rows there are.
+	 * The output is a serialized dynarray<T> (see serialize.hpp).  Temporary files named "<output_path>.run<N>" are created next to the output and removed before returning.
+	 * If all the rows fit in half of the budget, they are sorted in memory and written directly.  Otherwise, sorted runs are spilled (while the next run is being filled) and then merged.
+	 * The sort is not stable.  comp is called with references to rows of dynarray<T>.
+	 * @tparam T the element type of the rows, i.e. the output is a dynarray<T>; if each row is one-dimensional then T is an inner container such as inner_dynarray<int>
+	 * @param first,last the rows to sort; each row must be assignable to dynarray<T>::reference, and all rows must have the same extents as the first one
+	 */
+	template <typename T, typename InputIt, typename Compare = std::less<>>
+	inline void external_sort(InputIt first, InputIt last, const char* output_path, size_t memory_budget, Compare comp = {}) {
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using base_element = typename element_traits<T>::base_element;
+		static_assert(std::is_trivially_copyable_v<base_element>, "external_sort requires trivially copyable base elements");
+
+		element_extents_type extents{};
+		if constexpr (element_traits<T>::is_inner_container) {
+			if (first != last) extents = detail::container_extents_of(*first);
+		}
+		const size_t row_bytes = std::max<size_t>(1, extents.stride() * sizeof(base_element)); // empty rows still count towards the budget
+		const size_t run_rows = std::max<size_t>(1, memory_budget / 2 / row_bytes);
+
+		detail::temp_files temps(std::string(output_path) + ".run");
+		std::vector<std::string> runs;
+		dynarray<T> filling(run_rows, extents);
+		dynarray<T> spilling(run_rows, extents);
+		std::future<void> pending; // the spill of the previous run, from spilling
+		size_t rows = 0;
+		for (; first != last; ++first) {
+			filling[rows] = *first;
+			if (++rows == run_rows) {
+				multidim::sort(filling.begin(), filling.end(), comp);
+				if (pending.valid()) pending.get();
+				using std::swap;
+				swap(filling, spilling);
+				runs.push_back(temps.create());
+				pending = std::async(std::launch::async, [path = runs.back(), &spilling]() { detail::write_run(path.c_str(), spilling, spilling.size()); });
+				rows = 0;
+			}
+		}
+		multidim::sort(filling.begin(), filling.begin() + rows, comp);
+		if (pending.valid()) pending.get();
+		if (runs.empty()) {
+			detail::write_run(output_path, filling, rows);
+			return;
+		}
+		if (rows != 0) {
+			runs.push_back(temps.create());
+			detail::write_run(runs.back().c_str(), filling, rows);
+		}
+		filling = dynarray<T>(0, extents); // give the memory back for the merge
+		spilling = dynarray<T>(0, extents);
+
+		// merge in passes until the remaining runs can be merged at once
+		const size_t max_fan_in = std::max<size_t>(2, memory_budget / (2 * std::max(row_bytes, detail::external_sort_min_block)) - 1);
+		while (runs.size() > max_fan_in) {
+			std::vector<std::string> merged;
+			for (size_t i = 0; i < runs.size(); i += max_fan_in) {
+				const std::vector<std::string> group(runs.begin() + i, runs.begin() + std::min(i + max_fan_in, runs.size()));
+				if (group.size() == 1) {
+					merged.push_back(group.front());
+					continue;
+				}
+				merged.push_back(temps.create());
+				detail::merge_runs<T>(group, merged.back().c_str(), memory_budget, extents, comp);
+				for (const std::string& path : group) temps.remove(path);
+			}
+			runs = std::move(merged);
+		}
+		detail::merge_runs<T>(runs, output_path, memory_budget, extents, comp);
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <algorithm> // for std::max()
+#include <cstddef>
+
+namespace multidim {
+
+	/**
+	 * Growth policy that multiplies the capacity by Num/Den whenever a growable container runs out of space.
+	 * A growth policy is any class with a static member function `next_capacity(capacity, min_capacity)` that returns the new capacity, which must be at least min_capacity.
+	 * @tparam Num the numerator of the growth factor
+	 * @tparam Den the denominator of the growth factor
+	 */
+	template <size_t Num, size_t Den = 1>
+	struct geometric_growth {
+		static_assert(Den > 0 && Num > Den, "growth factor must be greater than 1");
+		constexpr static size_t numerator = Num;
+		constexpr static size_t denominator = Den;
+		/**
+		 * Gets the capacity to grow to, given the current capacity and the minimum capacity that is required.
+		 */
+		constexpr static size_t next_capacity(size_t capacity, size_t min_capacity) noexcept {
+			// written this way to avoid overflowing when capacity is large
+			return std::max(min_capacity, capacity / Den * Num + capacity % Den * Num / Den);
+		}
+	};
+
+	/**
+	 * The growth policy used by growable containers unless otherwise specified.  This doubles the capacity, in order to provide amortized guarantees.
+	 */
+	using default_growth = geometric_growth<2>;
+}
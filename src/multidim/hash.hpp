@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memcpy()
+#include <functional> // for std::hash
+#include <iterator> // for std::iterator_traits
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h> // for _umul128()
+#endif
+
+#include "core.hpp"
+#include "array.hpp"
+#include "dynarray.hpp"
+#include "vector.hpp"
+
+/**
+ * Hashing of rows (and whole containers) by their base elements, so that they can be used as keys of unordered containers.
+ * std::hash is specialised for the containers and their references, and rows that compare equal with operator== have equal hashes, regardless of whether they are containers or references.
+ * Hashes are not stable across platforms or versions of this library, so they must not be persisted.
+ */
+
+namespace multidim {
+
+	namespace detail {
+		constexpr inline std::uint64_t hash_secret[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+		/**
+		 * Multiplies two 64-bit numbers and folds the 128-bit product into 64 bits.
+		 */
+		inline std::uint64_t hash_mum(std::uint64_t a, std::uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+			return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+			std::uint64_t hi;
+			const std::uint64_t lo = _umul128(a, b, &hi);
+			return lo ^ hi;
+#else
+			const std::uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<std::uint32_t>(a), lb = static_cast<std::uint32_t>(b);
+			const std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+			const std::uint64_t t = rl + (rm0 << 32);
+			const std::uint64_t lo = t + (rm1 << 32);
+			const std::uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+			return lo ^ hi;
+#endif
+		}
+		inline std::uint64_t hash_read64(const unsigned char* p) noexcept {
+			std::uint64_t v;
+			std::memcpy(&v, p, sizeof(v));
+			return v;
+		}
+		inline std::uint64_t hash_read32(const unsigned char* p) noexcept {
+			std::uint32_t v;
+			std::memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		/**
+		 * The state of a wyhash-style hash of a byte string, which consumes 32 bytes per step in two independent multiply lanes.
+		 */
+		struct byte_hasher {
+			std::uint64_t lane0;
+			std::uint64_t lane1;
+
+			explicit byte_hasher(std::uint64_t seed) noexcept {
+				lane0 = lane1 = seed ^ hash_mum(seed ^ hash_secret[0], hash_secret[1]);
+			}
+			void step(const unsigned char* p) noexcept {
+				lane0 = hash_mum(hash_read64(p) ^ hash_secret[1], hash_read64(p + 8) ^ lane0);
+				lane1 = hash_mum(hash_read64(p + 16) ^ hash_secret[2], hash_read64(p + 24) ^ lane1);
+			}
+			/**
+			 * Hashes the last 1 to 32 bytes (or none if len is 0), where len is the length of the whole string.
+			 */
+			std::uint64_t finish(const unsigned char* p, size_t rest, size_t len) noexcept {
+				std::uint64_t seed = lane0 ^ lane1;
+				if (rest > 16) {
+					seed = hash_mum(hash_read64(p) ^ hash_secret[1], hash_read64(p + 8) ^ seed);
+					p += 16;
+					rest -= 16;
+				}
+				std::uint64_t a = 0, b = 0;
+				if (rest >= 4) {
+					const size_t mid = (rest >> 3) << 2;
+					a = (hash_read32(p) << 32) | hash_read32(p + mid);
+					b = (hash_read32(p + rest - 4) << 32) | hash_read32(p + rest - 4 - mid);
+				}
+				else if (rest > 0) {
+					a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[rest >> 1]) << 8) | p[rest - 1];
+				}
+				return hash_mum(hash_secret[1] ^ len, hash_mum(a ^ hash_secret[1], b ^ seed));
+			}
+		};
+
+		inline std::uint64_t hash_bytes(const unsigned char* p, size_t len, std::uint64_t seed) noexcept {
+			byte_hasher hasher(seed);
+			size_t rest = len;
+			for (; rest > 32; rest -= 32, p += 32) hasher.step(p);
+			return hasher.finish(p, rest, len);
+		}
+
+		/**
+		 * Hashes four byte strings of the same length in lockstep, so that their multiplications overlap.
+		 */
+		inline void hash_bytes_x4(const unsigned char* const (&ps)[4], size_t len, std::uint64_t seed, std::uint64_t (&out)[4]) noexcept {
+			byte_hasher hashers[4] = { byte_hasher(seed), byte_hasher(seed), byte_hasher(seed), byte_hasher(seed) };
+			size_t offset = 0;
+			for (; len - offset > 32; offset += 32) {
+				for (size_t k = 0; k != 4; ++k) hashers[k].step(ps[k] + offset);
+			}
+			for (size_t k = 0; k != 4; ++k) out[k] = hashers[k].finish(ps[k] + offset, len - offset, len);
+		}
+
+		/**
+		 * Hashes n base elements.  Bitwise equality comparable elements are hashed by their bytes; other elements are hashed with std::hash and mixed one at a time, so that the hash agrees with operator==.
+		 */
+		template <typename T>
+		inline std::uint64_t hash_elements(const T* data, size_t n, std::uint64_t seed = 0) {
+			if constexpr (is_bitwise_equality_comparable_v<T>) {
+				return hash_bytes(reinterpret_cast<const unsigned char*>(data), n * sizeof(T), seed);
+			}
+			else {
+				std::uint64_t h = seed ^ hash_mum(seed ^ hash_secret[0], hash_secret[1]);
+				for (size_t i = 0; i != n; ++i) {
+					h = hash_mum(h ^ static_cast<std::uint64_t>(std::hash<T>{}(data[i])), hash_secret[1]);
+				}
+				return hash_mum(h ^ hash_secret[2], n ^ hash_secret[3]);
+			}
+		}
+	}
+
+	/**
+	 * Function object that hashes a container or reference (e.g. a row of a 2D dynarray) by its base elements.
+	 * Base elements that are bitwise equality comparable (see is_bitwise_equality_comparable) are hashed 32 bytes at a time; others use std::hash of each element.
+	 */
+	struct row_hash {
+		template <typename R>
+		size_t operator()(const R& r) const {
+			return static_cast<size_t>(detail::hash_elements(r.data(), r.size() * r.extents().stride()));
+		}
+	};
+
+	/**
+	 * Writes the hash of each row in [first, last) to out, in order, like std::transform(first, last, out, row_hash{}) but hashing four rows at a time to make better use of the processor's pipelines.
+	 * @return the iterator past the last hash written
+	 */
+	template <typename InputIt, typename OutputIt>
+	inline OutputIt hash_rows(InputIt first, InputIt last, OutputIt out) {
+		using row_type = typename std::iterator_traits<InputIt>::reference;
+		using base_element = typename std::decay_t<row_type>::base_element;
+		if constexpr (is_bitwise_equality_comparable_v<base_element> && std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+			while (last - first >= 4) {
+				const row_type r0 = first[0], r1 = first[1], r2 = first[2], r3 = first[3];
+				const size_t n = r0.size() * r0.extents().stride();
+				if (r1.size() * r1.extents().stride() == n && r2.size() * r2.extents().stride() == n && r3.size() * r3.extents().stride() == n) {
+					const unsigned char* const ps[4] = { reinterpret_cast<const unsigned char*>(r0.data()), reinterpret_cast<const unsigned char*>(r1.data()), reinterpret_cast<const unsigned char*>(r2.data()), reinterpret_cast<const unsigned char*>(r3.data()) };
+					std::uint64_t hashes[4];
+					detail::hash_bytes_x4(ps, n * sizeof(base_element), 0, hashes);
+					for (std::uint64_t h : hashes) *out++ = static_cast<size_t>(h);
+				}
+				else {
+					*out++ = row_hash{}(r0);
+					*out++ = row_hash{}(r1);
+					*out++ = row_hash{}(r2);
+					*out++ = row_hash{}(r3);
+				}
+				first += 4;
+			}
+		}
+		for (; first != last; ++first) {
+			*out++ = row_hash{}(*first);
+		}
+		return out;
+	}
+}
+
+namespace std {
+	template <typename T, typename BufferKind>
+	struct hash<multidim::dynarray<T, BufferKind>> : multidim::row_hash {};
+	template <typename T>
+	struct hash<multidim::dynarray_ref<T>> : multidim::row_hash {};
+	template <typename T>
+	struct hash<multidim::dynarray_const_ref<T>> : multidim::row_hash {};
+	template <typename T, size_t N>
+	struct hash<multidim::array<T, N>> : multidim::row_hash {};
+	template <typename T, size_t N>
+	struct hash<multidim::array_ref<T, N>> : multidim::row_hash {};
+	template <typename T, size_t N>
+	struct hash<multidim::array_const_ref<T, N>> : multidim::row_hash {};
+	template <typename T, typename Growth, typename BufferKind>
+	struct hash<multidim::vector<T, Growth, BufferKind>> : multidim::row_hash {};
+}
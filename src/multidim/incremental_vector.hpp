@@ -0,0 +1,408 @@
+#pragma once
+
+#include <cassert>
+#include <algorithm> // for std::min()
+#include <iterator> // for std::reverse_iterator
+#include <memory> // for std::destroy() et al
+#include <limits> // for std::numeric_limits<>
+#include <stdexcept> // for std::out_of_range
+#include <type_traits>
+
+#include "dynarray.hpp"
+#include "growth_policy.hpp"
+#include "uninitialized_dynamic_buffer.hpp"
+#include "core.hpp"
+#include "iterator.hpp"
+#include "memory.hpp"
+
+namespace multidim {
+
+	/**
+	 * Represents a multidimensional array whose outermost dimension is a growable vector, with bounded latency when growing.
+	 * Unlike multidim::vector, running out of capacity does not move every element into the new buffer at once.  Instead, the old buffer is kept alive, and a bounded number of elements are migrated to the new buffer on each subsequent modifying operation (push_back(), emplace_back() and pop_back()).
+	 * Worst-case push_back() is therefore (amortized over allocation) O(migration_step()) rather than O(size()).
+	 * While a migration is in progress the elements are not contiguous, so iterators are indexed_iterators, and converting to dynarray_ref finishes the migration first.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 * @tparam Growth the growth policy, which decides the new capacity when the vector runs out of space (see geometric_growth)
+	 */
+	template <typename T, typename Growth = default_growth>
+	class incremental_vector {
+	public:
+		using value_type = typename element_traits<T>::value_type;
+		using reference = typename element_traits<T>::reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using pointer = typename element_traits<T>::pointer;
+		using const_pointer = typename element_traits<T>::const_pointer;
+		using iterator = indexed_iterator<incremental_vector, false>;
+		using const_iterator = indexed_iterator<incremental_vector, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		using buffer_type = uninitialized_dynamic_buffer<base_element>;
+		using growth_policy = Growth;
+
+		/**
+		 * The default number of elements migrated per modifying operation.  This is the smallest number that guarantees that a migration always completes before the next time the capacity is exhausted.
+		 */
+		constexpr static size_type default_migration_step = Growth::denominator / (Growth::numerator - Growth::denominator) + 1;
+
+		constexpr incremental_vector(const incremental_vector& other) : data_(other.size_ * other.extents_.stride()), size_(other.size_), capacity_(other.size_), migrated_(0), old_size_(0), migration_step_(other.migration_step_), extents_(other.extents_) {
+			for (size_type i = 0; i != size_; ++i) {
+				std::uninitialized_copy_n(other.data_at(i), extents_.stride(), data_at(i));
+			}
+		}
+		constexpr incremental_vector(incremental_vector&& other) noexcept : data_(std::move(other.data_)), old_data_(std::move(other.old_data_)), size_(other.size_), capacity_(other.capacity_), migrated_(other.migrated_), old_size_(other.old_size_), migration_step_(other.migration_step_), extents_(other.extents_) {
+			other.size_ = 0;
+			other.capacity_ = 0;
+			other.migrated_ = 0;
+			other.old_size_ = 0;
+		}
+		/**
+		 * Constructs an incremental_vector from the given element_extents_type (inner dimensions).  This should not generally be used directly.
+		 */
+		constexpr explicit incremental_vector(const element_extents_type& extents) noexcept : size_(0), capacity_(0), migrated_(0), old_size_(0), migration_step_(default_migration_step), extents_(extents) {}
+		/**
+		 * Constructs an incremental_vector from the given dimensions.
+		 * Note: Dimensions are only specified for dynarray layers.  Vectors and compile-time fixed arrays do not need a dimension parameter.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		constexpr explicit incremental_vector(TNs... ns) noexcept : incremental_vector(element_extents_type(ns...)) {}
+		constexpr incremental_vector& operator=(const incremental_vector& other) {
+			incremental_vector tmp(other);
+			swap(tmp);
+			return *this;
+		}
+		constexpr incremental_vector& operator=(incremental_vector&& other) noexcept {
+			clear();
+			incremental_vector tmp(std::move(other));
+			swap(tmp);
+			return *this;
+		}
+
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && __cpp_lib_constexpr_dynamic_alloc >= 201907
+		constexpr ~incremental_vector() {
+#else
+		~incremental_vector() {
+#endif
+			clear();
+		}
+
+		/**
+		 * Swaps two incremental_vectors.  This will invalidate references to both vectors.
+		 */
+		friend constexpr void swap(incremental_vector& a, incremental_vector& b) noexcept {
+			a.swap(b);
+		}
+		/**
+		 * Swaps this incremental_vector with another one.  This will invalidate references to both vectors.
+		 */
+		constexpr void swap(incremental_vector& other) noexcept {
+			using std::swap;
+			swap(data_, other.data_);
+			swap(old_data_, other.old_data_);
+			swap(size_, other.size_);
+			swap(capacity_, other.capacity_);
+			swap(migrated_, other.migrated_);
+			swap(old_size_, other.old_size_);
+			swap(migration_step_, other.migration_step_);
+			swap(extents_, other.extents_);
+		}
+
+		/**
+		 * Converting operator to dynarray_ref.  This finishes any migration in progress, so that all elements are contiguous.
+		 */
+		constexpr operator dynarray_ref<T>() {
+			finish_migration();
+			return dynarray_ref<T>{ data_.data(), container_extents_type{ size_, extents_ } };
+		}
+		/**
+		 * Converting operator to dynarray_const_ref.  This finishes any migration in progress, so that all elements are contiguous.
+		 */
+		constexpr operator dynarray_const_ref<T>() {
+			finish_migration();
+			return dynarray_const_ref<T>{ data_.data(), container_extents_type{ size_, extents_ } };
+		}
+		/**
+		 * Converting operator to dynarray_const_ref, for a const incremental_vector.  The elements must be contiguous, i.e. no migration may be in progress (call finish_migration() first).
+		 */
+		constexpr operator dynarray_const_ref<T>() const noexcept {
+			assert(!migrating());
+			return dynarray_const_ref<T>{ data_.data(), container_extents_type{ size_, extents_ } };
+		}
+
+	private:
+		/**
+		 * Gets a pointer to the base elements of the element at the specified index, in whichever buffer it currently lives.
+		 * Elements in [migrated_, old_size_) are still in the old buffer; everything else is in the new buffer.
+		 */
+		constexpr base_element* data_at(size_type index) noexcept {
+			return (index - migrated_ < old_size_ - migrated_ ? old_data_.data() : data_.data()) + index * extents_.stride();
+		}
+		constexpr const base_element* data_at(size_type index) const noexcept {
+			return (index - migrated_ < old_size_ - migrated_ ? old_data_.data() : data_.data()) + index * extents_.stride();
+		}
+
+		constexpr reference get_element(base_element* base) noexcept {
+			if constexpr (element_traits<T>::is_inner_container) {
+				return reference{ base, extents_ };
+			}
+			else {
+				static_assert(std::is_same_v<element_extents_type, unit_extent>, "extents_type must be unit_extent if there is no inner container");
+				return *base;
+			}
+		}
+		constexpr const_reference get_element(const base_element* base) const noexcept {
+			if constexpr (element_traits<T>::is_inner_container) {
+				return const_reference{ base, extents_ };
+			}
+			else {
+				static_assert(std::is_same_v<element_extents_type, unit_extent>, "extents_type must be unit_extent if there is no inner container");
+				return *base;
+			}
+		}
+	public:
+		/**
+		 * Gets a reference to the element at the specified index.  It is undefined behaviour if index >= size().
+		 */
+		constexpr reference operator[](size_type index) noexcept {
+			assert(index < size_);
+			return get_element(data_at(index));
+		}
+		constexpr const_reference operator[](size_type index) const noexcept {
+			assert(index < size_);
+			return get_element(data_at(index));
+		}
+		/**
+		 * Gets a reference to the element at the specified index.  Throws std::out_of_range if index >= size().
+		 */
+		constexpr reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		constexpr const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+
+		constexpr size_type size() const noexcept { return size_; }
+		constexpr size_type max_size() const noexcept { return std::numeric_limits<difference_type>::max(); }
+		[[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+		constexpr size_type capacity() const noexcept { return capacity_; }
+
+		constexpr const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+		constexpr const_iterator cend() const noexcept { return const_iterator(this, size_); }
+		constexpr const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+		constexpr const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+		constexpr const_iterator begin() const noexcept { return cbegin(); }
+		constexpr iterator begin() noexcept { return iterator(this, 0); }
+		constexpr const_iterator end() const noexcept { return cend(); }
+		constexpr iterator end() noexcept { return iterator(this, size_); }
+		constexpr const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(end()); }
+		constexpr reverse_iterator rbegin() noexcept { return std::make_reverse_iterator(end()); }
+		constexpr const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(begin()); }
+		constexpr reverse_iterator rend() noexcept { return std::make_reverse_iterator(begin()); }
+
+		constexpr reference front() noexcept { return operator[](0); }
+		constexpr const_reference front() const noexcept { return operator[](0); }
+		constexpr reference back() noexcept { return operator[](size_ - 1); }
+		constexpr const_reference back() const noexcept { return operator[](size_ - 1); }
+
+
+
+		/**
+		 * Checks whether some elements still live in the old buffer.
+		 */
+		constexpr bool migrating() const noexcept { return migrated_ != old_size_; }
+		/**
+		 * Gets the maximum number of elements that are migrated on each modifying operation.
+		 */
+		constexpr size_type migration_step() const noexcept { return migration_step_; }
+		/**
+		 * Sets the maximum number of elements that are migrated on each modifying operation.  If this is smaller than default_migration_step, then some growths may need to finish a pending migration all at once.
+		 */
+		constexpr void set_migration_step(size_type step) noexcept { migration_step_ = step; }
+
+		/**
+		 * Migrates at most `count` elements from the old buffer to the new one.  This can be used to make progress on a migration during idle time.
+		 */
+		constexpr void migrate(size_type count) {
+			count = std::min(count, old_size_ - migrated_);
+			if (count == 0) return;
+			base_element* const src_first = old_data_.data() + migrated_ * extents_.stride();
+			base_element* const src_last = src_first + count * extents_.stride();
+			multidim::uninitialized_move_if_noexcept(src_first, src_last, data_.data() + migrated_ * extents_.stride());
+			std::destroy(src_first, src_last);
+			migrated_ += count;
+			if (migrated_ == old_size_) end_migration();
+		}
+		/**
+		 * Migrates all remaining elements from the old buffer to the new one.
+		 */
+		constexpr void finish_migration() {
+			migrate(old_size_ - migrated_);
+		}
+
+		/**
+		 * Reserves enough space to store at least new_cap elements, without further reallocation.  This finishes any migration in progress, and moves all elements at once.
+		 */
+		constexpr void reserve(size_type new_cap) {
+			if (new_cap <= capacity_) return;
+			reallocate(new_cap);
+		}
+
+		/**
+		 * Requests the removal of unused capacity.  This finishes any migration in progress, and moves all elements at once.
+		 */
+		constexpr void shrink_to_fit() {
+			if (size_ == capacity_) return;
+			reallocate(size_);
+		}
+
+		/**
+		 * Removes all existing elements from the vector.
+		 */
+		constexpr void clear() noexcept {
+			for (size_type i = 0; i != size_; ++i) {
+				std::destroy_n(data_at(i), extents_.stride());
+			}
+			end_migration();
+			size_ = 0;
+		}
+
+	private:
+		/**
+		 * Drops the old buffer.  All elements must already be in the new buffer (or be destroyed).
+		 */
+		constexpr void end_migration() noexcept {
+			old_data_ = buffer_type();
+			migrated_ = 0;
+			old_size_ = 0;
+		}
+
+		/**
+		 * Moves all elements (from both buffers) into a newly allocated buffer with the given capacity.
+		 */
+		constexpr void reallocate(size_type new_cap) {
+			buffer_type tmp_buf(new_cap * extents_.stride());
+			move_all_into(tmp_buf);
+			capacity_ = new_cap;
+		}
+
+		/**
+		 * Moves all existing elements into the given buffer at the same indices, and makes it the current buffer.
+		 */
+		constexpr void move_all_into(buffer_type& new_buf) {
+			for (size_type i = 0; i != size_; ++i) {
+				base_element* const src = data_at(i);
+				multidim::uninitialized_move_if_noexcept(src, src + extents_.stride(), new_buf.data() + i * extents_.stride());
+				std::destroy_n(src, extents_.stride());
+			}
+			end_migration();
+			data_ = std::move(new_buf);
+		}
+
+		/**
+		 * Ensures that there is space for one more element at index size_, by allocating a new buffer if necessary.
+		 * The new element is constructed by `construct` (which receives a pointer to its base elements) before any existing element is touched, so that it is safe for the new element to be a copy of an existing one.
+		 */
+		template <typename Construct>
+		constexpr void grow_and_construct(Construct&& construct) {
+			if (size_ < capacity_) {
+				construct(data_.data() + size_ * extents_.stride());
+				++size_;
+				return;
+			}
+			const size_type new_capacity = Growth::next_capacity(capacity_, size_ + 1);
+			buffer_type tmp_buf(new_capacity * extents_.stride()); // might throw std::bad_alloc()
+			construct(tmp_buf.data() + size_ * extents_.stride());
+			if (migrating()) {
+				// the previous migration has not completed (only possible if the migration step is too small), so we fall back to moving everything
+				move_all_into(tmp_buf);
+			}
+			else {
+				old_data_ = std::move(data_);
+				data_ = std::move(tmp_buf);
+				migrated_ = 0;
+				old_size_ = size_;
+			}
+			capacity_ = new_capacity;
+			++size_;
+		}
+
+	public:
+		/**
+		 * Adds an element to the back of the vector.  This is safe even if `value` is a reference to an element of this same vector.
+		 */
+		constexpr void push_back(const_reference value) {
+			grow_and_construct([&](base_element* dest) {
+				multidim::uninitialized_copy_at(value, get_element(dest));
+			});
+			migrate(migration_step_);
+		}
+		template <typename... Args>
+		constexpr void emplace_back(Args&&... args) {
+			static_assert(!element_traits<T>::is_inner_container, "emplace_back() only allowed for deepest level container");
+			grow_and_construct([&](base_element* dest) {
+				::new (static_cast<void*>(dest)) value_type(std::forward<Args>(args)...);
+			});
+			migrate(migration_step_);
+		}
+
+		/**
+		 * Removes the back element from this vector.  This is undefined behaviour if size()==0.
+		 */
+		constexpr void pop_back() {
+			--size_;
+			multidim::destroy_at(get_element(data_at(size_)));
+			if (size_ < old_size_) {
+				// the removed element was still in the old buffer
+				old_size_ = size_;
+				if (migrated_ == old_size_) end_migration();
+			}
+			migrate(migration_step_);
+		}
+
+
+
+		/**
+		 * Gets the extents of elements that are stored in this vector.
+		 */
+		constexpr const element_extents_type& extents() const noexcept { return extents_; }
+
+
+		/**
+		 * Compares if two incremental_vectors are elementwise equal.  If they have different shape or different number of elements, then it will also return false.
+		 */
+		friend constexpr bool operator==(const incremental_vector& a, const incremental_vector& b) {
+			if (a.size_ != b.size_ || !(a.extents_ == b.extents_)) return false;
+			for (size_type i = 0; i != a.size_; ++i) {
+				if (!(a[i] == b[i])) return false;
+			}
+			return true;
+		}
+		friend constexpr bool operator!=(const incremental_vector& a, const incremental_vector& b) { return !(a == b); };
+		// Note: We don't provide lexicographical comparison because it isn't clear what it means to compare arrays of different shape.
+
+	private:
+
+		buffer_type data_; // the current buffer, with space for capacity_ elements
+		buffer_type old_data_; // the buffer that is being migrated from, or an empty buffer if there is no migration in progress
+		size_t size_; // the size of the current dimension
+		size_t capacity_; // the capacity of the current dimension
+		size_t migrated_; // the number of elements at the front that have been migrated to data_
+		size_t old_size_; // elements in [migrated_, old_size_) still live in old_data_
+		size_t migration_step_; // the maximum number of elements to migrate on each modifying operation
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+
+}
@@ -4,6 +4,7 @@
 #include <compare>
 #endif
 #include <iterator>
+#include <memory> // for std::addressof()
 #include <type_traits>
 
 #include "core.hpp"
@@ -69,6 +70,7 @@ namespace multidim {
 			assert(ref_.extents() == other.ref_.extents());
 			ref_.rebind(other.ref_.data());
 			index_ = other.index_;
+			return *this;
 		}
 
 		constexpr typename B::reference operator*() const noexcept { return ref_; }
@@ -156,6 +158,87 @@ namespace multidim {
 	};
 
 
+	/**
+	 * Iterator that refers to an element of a container by its index, and dereferences it using the container's operator[].
+	 * This is for containers whose elements are not laid out at a fixed distance apart in a single buffer (e.g. while a container is migrating to a new buffer).  They satisfy LegacyRandomAccessIterator as much as is possible.
+	 * Like iterator_intermediate_impl, std::iterator_traits<Iter>::reference might not be a real reference.
+	 * @param Container the container type, which must provide operator[] and the usual member typedefs
+	 * @param IsConst whether this iterator is a const_iterator.
+	 */
+	template <typename Container, bool IsConst>
+	class indexed_iterator {
+	public:
+		using container_type = std::conditional_t<IsConst, const Container, Container>;
+		using value_type = typename Container::value_type;
+		using reference = std::conditional_t<IsConst, typename Container::const_reference, typename Container::reference>;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using pointer = std::conditional_t<IsConst, typename Container::const_pointer, typename Container::pointer>;
+		using iterator_category = std::random_access_iterator_tag;
+		using element_extents_type = typename Container::element_extents_type;
+		using base_element = std::conditional_t<IsConst, const typename Container::base_element, typename Container::base_element>;
+
+		constexpr indexed_iterator(container_type* container, size_type index) noexcept : container_(container), index_(index) {}
+		/**
+		 * Default-constructed iterator.
+		 * This should not be used for anything apart from reassignment, but is provided for convenience of some algorithms.
+		 * Two value-initialised instances are guaranteed to compare equal with operator==, as required by LegacyForwardIterator.
+		 */
+		constexpr indexed_iterator() noexcept : container_(nullptr), index_(0) {}
+		constexpr indexed_iterator(const indexed_iterator&) noexcept = default;
+		constexpr indexed_iterator& operator=(const indexed_iterator&) noexcept = default;
+		/**
+		 * Converts an iterator into a const_iterator.
+		 */
+		template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+		constexpr indexed_iterator(const indexed_iterator<Container, OtherConst>& other) noexcept : container_(other.container_), index_(other.index_) {}
+
+		constexpr reference operator*() const noexcept { return (*container_)[index_]; }
+		constexpr auto operator->() const noexcept {
+			if constexpr (std::is_reference_v<reference>) {
+				return std::addressof(**this);
+			}
+			else {
+				struct arrow_proxy {
+					reference ref;
+					constexpr const reference* operator->() const noexcept { return &ref; }
+				};
+				return arrow_proxy{ **this };
+			}
+		}
+
+		constexpr indexed_iterator& operator++() noexcept { ++index_; return *this; }
+		constexpr indexed_iterator operator++(int) noexcept { auto tmp = *this; ++(*this); return tmp; }
+		constexpr indexed_iterator& operator--() noexcept { --index_; return *this; }
+		constexpr indexed_iterator operator--(int) noexcept { auto tmp = *this; --(*this); return tmp; }
+		constexpr indexed_iterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+		constexpr indexed_iterator operator+(difference_type n) const noexcept { auto tmp = *this; return tmp += n; }
+		friend constexpr indexed_iterator operator+(difference_type n, const indexed_iterator& it) noexcept { return it + n; }
+		constexpr indexed_iterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+		constexpr indexed_iterator operator-(difference_type n) const noexcept { auto tmp = *this; return tmp -= n; }
+		friend constexpr difference_type operator-(const indexed_iterator& b, const indexed_iterator& a) noexcept { return b.index_ - a.index_; }
+
+		constexpr reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+		friend constexpr bool operator==(const indexed_iterator& a, const indexed_iterator& b) noexcept { return a.index_ == b.index_; }
+		friend constexpr bool operator!=(const indexed_iterator& a, const indexed_iterator& b) noexcept { return !(a == b); }
+#ifdef __cpp_impl_three_way_comparison
+		friend constexpr auto operator<=>(const indexed_iterator& a, const indexed_iterator& b) noexcept { return a.index_ <=> b.index_; }
+#else
+		friend constexpr auto operator<(const indexed_iterator& a, const indexed_iterator& b) noexcept { return a.index_ < b.index_; }
+		friend constexpr auto operator>(const indexed_iterator& a, const indexed_iterator& b) noexcept { return b < a; }
+		friend constexpr auto operator<=(const indexed_iterator& a, const indexed_iterator& b) noexcept { return !(b < a); }
+		friend constexpr auto operator>=(const indexed_iterator& a, const indexed_iterator& b) noexcept { return !(a < b); }
+#endif
+
+	private:
+		template <typename, bool>
+		friend class indexed_iterator;
+		container_type* container_;
+		size_type index_;
+	};
+
+
 	template <typename T, bool IsConst>
 	using iterator_impl = std::conditional_t<std::is_base_of_v<inner_container_base, T>, iterator_intermediate_impl<T, IsConst>, iterator_lowest_impl<T, IsConst>>;
 
@@ -0,0 +1,201 @@
+#pragma once
+
+#if !(__has_include(<sys/mman.h>) && __has_include(<sys/stat.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>))
+#error "multidim/mapped_buffer.hpp requires POSIX mmap()"
+#endif
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <type_traits>
+#include <utility> // for std::exchange()
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace multidim {
+
+	/**
+	 * How a file is mapped into memory.
+	 */
+	enum class map_mode {
+		read_only, // pages are shared with other processes mapping the same file, and may not be written to
+		copy_on_write, // pages are private; writes are never carried through to the file
+		read_write // pages are shared with other processes mapping the same file, and writes are carried through to the file
+	};
+
+	/**
+	 * Class that owns a memory mapping of an entire file, like a std::unique_ptr<std::byte[]> whose memory comes from mmap().
+	 * This class is a simple RAII class that closes the file and unmaps the memory when it is destructed.
+	 * Errors reported by the operating system are thrown as std::system_error.
+	 */
+	class mapped_file {
+	public:
+		constexpr mapped_file() noexcept : fd_(-1), ptr_(nullptr), size_(0), mode_(map_mode::read_only) {}
+		/**
+		 * Maps the whole of an existing file.
+		 */
+		mapped_file(const char* path, map_mode mode) : mapped_file(open_file(path, mode == map_mode::read_write ? O_RDWR : O_RDONLY), mode) {}
+		/**
+		 * Creates (or truncates) a file with the given size and maps it with map_mode::read_write.  The new contents of the file are zero.
+		 */
+		static mapped_file create(const char* path, size_t size) {
+			mapped_file ret(open_file(path, O_RDWR | O_CREAT | O_TRUNC), map_mode::read_write);
+			ret.resize(size);
+			return ret;
+		}
+		/**
+		 * Maps the whole of an already opened file descriptor.  The mapped_file takes ownership of the descriptor.
+		 */
+		mapped_file(int fd, map_mode mode) : fd_(fd), ptr_(nullptr), size_(0), mode_(mode) {
+			struct stat st;
+			if (::fstat(fd_, &st) != 0) {
+				const int err = errno;
+				::close(fd_);
+				throw std::system_error(err, std::generic_category(), "multidim: fstat() failed");
+			}
+			size_ = static_cast<size_t>(st.st_size);
+			try {
+				map();
+			}
+			catch (...) {
+				::close(fd_);
+				throw;
+			}
+		}
+		mapped_file(const mapped_file&) = delete;
+		mapped_file(mapped_file&& other) noexcept : fd_(std::exchange(other.fd_, -1)), ptr_(std::exchange(other.ptr_, nullptr)), size_(std::exchange(other.size_, 0)), mode_(other.mode_) {}
+		mapped_file& operator=(const mapped_file&) = delete;
+		mapped_file& operator=(mapped_file&& other) noexcept {
+			mapped_file tmp(std::move(other));
+			swap(*this, tmp);
+			return *this;
+		}
+		~mapped_file() {
+			if (ptr_) ::munmap(ptr_, size_);
+			if (fd_ != -1) ::close(fd_);
+		}
+		friend void swap(mapped_file& a, mapped_file& b) noexcept {
+			using std::swap;
+			swap(a.fd_, b.fd_);
+			swap(a.ptr_, b.ptr_);
+			swap(a.size_, b.size_);
+			swap(a.mode_, b.mode_);
+		}
+
+		void* data() noexcept { return ptr_; }
+		const void* data() const noexcept { return ptr_; }
+		/**
+		 * Gets the size of the mapping (and of the file) in bytes.
+		 */
+		size_t size() const noexcept { return size_; }
+		map_mode mode() const noexcept { return mode_; }
+		int native_handle() const noexcept { return fd_; }
+
+		/**
+		 * Changes the size of the file (with ftruncate()) and of the mapping (with mremap() where available).  Only allowed for map_mode::read_write.
+		 * The mapping may move, so pointers into the old mapping are invalidated.
+		 */
+		void resize(size_t new_size) {
+			assert(mode_ == map_mode::read_write);
+			if (::ftruncate(fd_, static_cast<off_t>(new_size)) != 0) {
+				throw std::system_error(errno, std::generic_category(), "multidim: ftruncate() failed");
+			}
+#if defined(MREMAP_MAYMOVE)
+			if (ptr_ && new_size != 0) {
+				void* const new_ptr = ::mremap(ptr_, size_, new_size, MREMAP_MAYMOVE);
+				if (new_ptr == MAP_FAILED) {
+					throw std::system_error(errno, std::generic_category(), "multidim: mremap() failed");
+				}
+				ptr_ = new_ptr;
+				size_ = new_size;
+				return;
+			}
+#endif
+			unmap();
+			size_ = new_size;
+			map();
+		}
+
+		/**
+		 * Writes modified pages back to the file.  This is only meaningful for map_mode::read_write.
+		 */
+		void flush() {
+			if (ptr_ && ::msync(ptr_, size_, MS_SYNC) != 0) {
+				throw std::system_error(errno, std::generic_category(), "multidim: msync() failed");
+			}
+		}
+
+	private:
+		static int open_file(const char* path, int flags) {
+			const int fd = ::open(path, flags | O_CLOEXEC, 0666);
+			if (fd == -1) {
+				throw std::system_error(errno, std::generic_category(), "multidim: open() failed");
+			}
+			return fd;
+		}
+		void map() {
+			if (size_ == 0) return; // mmap() does not allow empty mappings
+			const int prot = mode_ == map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+			const int flags = mode_ == map_mode::copy_on_write ? MAP_PRIVATE : MAP_SHARED;
+			void* const ptr = ::mmap(nullptr, size_, prot, flags, fd_, 0);
+			if (ptr == MAP_FAILED) {
+				throw std::system_error(errno, std::generic_category(), "multidim: mmap() failed");
+			}
+			ptr_ = ptr;
+		}
+		void unmap() noexcept {
+			if (ptr_) ::munmap(ptr_, size_);
+			ptr_ = nullptr;
+		}
+
+		int fd_;
+		void* ptr_;
+		size_t size_;
+		map_mode mode_;
+	};
+
+	/**
+	 * Class that represents a buffer backed by a memory-mapped file, like dynamic_buffer but without ever copying the file contents.
+	 * The file contents are reinterpreted as an array of T, so T must be trivially copyable.  The file size need not be a multiple of sizeof(T); any trailing bytes are not accessible.
+	 */
+	template <typename T>
+	class mapped_buffer {
+	public:
+		static_assert(std::is_trivially_copyable_v<T>, "mapped_buffer requires trivially copyable elements");
+		T* data() noexcept { return static_cast<T*>(file_.data()); }
+		const T* data() const noexcept { return static_cast<const T*>(file_.data()); }
+		/**
+		 * Gets the number of elements of T that fit in the file.
+		 */
+		size_t size() const noexcept { return file_.size() / sizeof(T); }
+		map_mode mode() const noexcept { return file_.mode(); }
+		mapped_buffer() = default;
+		mapped_buffer(const char* path, map_mode mode) : file_(path, mode) {}
+		explicit mapped_buffer(mapped_file&& file) noexcept : file_(std::move(file)) {}
+		/**
+		 * Creates (or truncates) a file that holds sz value-initialized elements.
+		 */
+		static mapped_buffer create(const char* path, size_t sz) {
+			return mapped_buffer(mapped_file::create(path, sz * sizeof(T)));
+		}
+		mapped_buffer(const mapped_buffer&) = delete;
+		mapped_buffer(mapped_buffer&&) noexcept = default;
+		mapped_buffer& operator=(const mapped_buffer&) = delete;
+		mapped_buffer& operator=(mapped_buffer&&) noexcept = default;
+		/**
+		 * Changes the number of elements in the file.  New elements are zero.  Only allowed for map_mode::read_write.
+		 */
+		void resize(size_t sz) { file_.resize(sz * sizeof(T)); }
+		void flush() { file_.flush(); }
+		friend void swap(mapped_buffer& a, mapped_buffer& b) noexcept {
+			using std::swap;
+			swap(a.file_, b.file_);
+		}
+	private:
+		mapped_file file_;
+	};
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <stdexcept> // for std::out_of_range and std::length_error
+#include <type_traits>
+
+#include "dynarray.hpp"
+#include "mapped_buffer.hpp"
+#include "core.hpp"
+#include "iterator.hpp"
+
+namespace multidim {
+
+	/**
+	 * Represents a multidimensional array whose base elements live in a memory-mapped file.
+	 * The outermost dimension is determined by the file size, and the inner dimensions are specified at construction time, so opening a file is O(1) regardless of its size.
+	 * Data is accessed through dynarray_ref / dynarray_const_ref views over the mapping.  Writing through a view of a map_mode::read_only mapping is undefined behaviour.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 */
+	template <typename T>
+	class mapped_dynarray {
+	public:
+		using value_type = typename element_traits<T>::value_type;
+		using reference = typename element_traits<T>::reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using pointer = typename element_traits<T>::pointer;
+		using const_pointer = typename element_traits<T>::const_pointer;
+		using iterator = iterator_impl<T, false>;
+		using const_iterator = iterator_impl<T, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		using buffer_type = mapped_buffer<base_element>;
+
+		/**
+		 * Maps an existing file, given the element_extents_type (inner dimensions).  Throws std::length_error if the file size is not a whole number of elements.
+		 */
+		mapped_dynarray(const char* path, map_mode mode, const element_extents_type& extents) : mapped_dynarray(buffer_type(path, mode), extents) {}
+		/**
+		 * Maps an existing file, given the inner dimensions.
+		 * Note: Dimensions are only specified for dynarray layers.  Compile-time fixed arrays do not need a dimension parameter.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		mapped_dynarray(const char* path, map_mode mode, TNs... ns) : mapped_dynarray(path, mode, element_extents_type(ns...)) {}
+		/**
+		 * Takes ownership of an existing mapping, given the element_extents_type (inner dimensions).
+		 */
+		mapped_dynarray(buffer_type&& buf, const element_extents_type& extents) : data_(std::move(buf)), size_(0), extents_(extents) {
+			const size_type stride = extents_.stride();
+			if (stride != 0) {
+				if (data_.size() % stride != 0) throw std::length_error("file size is not a multiple of the element size");
+				size_ = data_.size() / stride;
+			}
+		}
+		/**
+		 * Creates (or truncates) a file that holds an array of the given dimensions, and maps it with map_mode::read_write.  The new elements are zero.
+		 */
+		template <typename TN, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TN>, std::is_convertible<size_t, TNs>...>>>
+		static mapped_dynarray create(const char* path, TN n, TNs... ns) {
+			const element_extents_type extents(ns...);
+			mapped_dynarray ret(buffer_type::create(path, n * extents.stride()), extents);
+			ret.size_ = n; // in case the stride is zero
+			return ret;
+		}
+		mapped_dynarray(const mapped_dynarray&) = delete;
+		mapped_dynarray(mapped_dynarray&&) noexcept = default;
+		mapped_dynarray& operator=(const mapped_dynarray&) = delete;
+		mapped_dynarray& operator=(mapped_dynarray&&) noexcept = default;
+
+		friend void swap(mapped_dynarray& a, mapped_dynarray& b) noexcept {
+			using std::swap;
+			swap(a.data_, b.data_);
+			swap(a.size_, b.size_);
+			swap(a.extents_, b.extents_);
+		}
+
+		/**
+		 * Converting operator to dynarray_ref.
+		 */
+		operator dynarray_ref<T>() noexcept {
+			return dynarray_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+		/**
+		 * Converting operator to dynarray_const_ref.
+		 */
+		operator dynarray_const_ref<T>() const noexcept {
+			return dynarray_const_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+
+		/**
+		 * Gets a pointer to the underlying base elements.
+		 */
+		base_element* data() noexcept { return data_.data(); }
+		const base_element* data() const noexcept { return data_.data(); }
+
+		reference operator[](size_type index) noexcept { return static_cast<dynarray_ref<T>>(*this)[index]; }
+		const_reference operator[](size_type index) const noexcept { return static_cast<dynarray_const_ref<T>>(*this)[index]; }
+		reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+
+		size_type size() const noexcept { return size_; }
+		size_type max_size() const noexcept { return size_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+		const_iterator cbegin() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).begin(); }
+		const_iterator cend() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).end(); }
+		const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+		const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+		const_iterator begin() const noexcept { return cbegin(); }
+		iterator begin() noexcept { return static_cast<dynarray_ref<T>>(*this).begin(); }
+		const_iterator end() const noexcept { return cend(); }
+		iterator end() noexcept { return static_cast<dynarray_ref<T>>(*this).end(); }
+		const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(end()); }
+		reverse_iterator rbegin() noexcept { return std::make_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(begin()); }
+		reverse_iterator rend() noexcept { return std::make_reverse_iterator(begin()); }
+
+		reference front() noexcept { return operator[](0); }
+		const_reference front() const noexcept { return operator[](0); }
+		reference back() noexcept { return operator[](size_ - 1); }
+		const_reference back() const noexcept { return operator[](size_ - 1); }
+
+		/**
+		 * Gets the extents of elements that are stored in this array.
+		 */
+		const element_extents_type& extents() const noexcept { return extents_; }
+		map_mode mode() const noexcept { return data_.mode(); }
+
+		/**
+		 * Writes modified pages back to the file.  This is only meaningful for map_mode::read_write.
+		 */
+		void flush() { data_.flush(); }
+
+		/**
+		 * Compares if the array is elementwise equal to another array.  If they have different shape or different number of elements, then it will also return false.
+		 */
+		friend bool operator==(const mapped_dynarray& a, const dynarray_const_ref<T>& b) {
+			return static_cast<dynarray_const_ref<T>>(a) == b;
+		}
+		friend bool operator!=(const mapped_dynarray& a, const dynarray_const_ref<T>& b) { return !(a == b); };
+
+	private:
+		buffer_type data_;
+		size_t size_; // the size of the current dimension
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+}
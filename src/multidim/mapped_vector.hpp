@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept> // for std::out_of_range and std::length_error
+#include <type_traits>
+
+#include "dynarray.hpp"
+#include "growth_policy.hpp"
+#include "mapped_buffer.hpp"
+#include "core.hpp"
+#include "iterator.hpp"
+
+namespace multidim {
+
+	/**
+	 * Represents a multidimensional array whose outermost dimension is a growable vector, and whose base elements live in a memory-mapped file (always mapped with map_mode::read_write).
+	 * Growing past the capacity extends the file with ftruncate() and the mapping with mremap() (where available), so no data is copied through user space.
+	 * The file may be longer than size() while the vector is open; the slack is truncated away when the vector is destroyed or closed.
+	 * Base elements must be trivially copyable, and are never constructed or destroyed.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 * @tparam Growth the growth policy, which decides the new capacity when the vector runs out of space (see geometric_growth)
+	 */
+	template <typename T, typename Growth = default_growth>
+	class mapped_vector {
+	public:
+		using value_type = typename element_traits<T>::value_type;
+		using reference = typename element_traits<T>::reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using pointer = typename element_traits<T>::pointer;
+		using const_pointer = typename element_traits<T>::const_pointer;
+		using iterator = iterator_impl<T, false>;
+		using const_iterator = iterator_impl<T, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		using buffer_type = mapped_buffer<base_element>;
+		using growth_policy = Growth;
+
+		/**
+		 * Opens an existing file (whose contents become the elements of the vector), given the element_extents_type (inner dimensions).  Throws std::length_error if the file size is not a whole number of elements.
+		 */
+		mapped_vector(const char* path, const element_extents_type& extents) : data_(path, map_mode::read_write), size_(0), capacity_(0), extents_(extents) {
+			const size_type stride = extents_.stride();
+			if (stride != 0) {
+				if (data_.size() % stride != 0) throw std::length_error("file size is not a multiple of the element size");
+				size_ = capacity_ = data_.size() / stride;
+			}
+		}
+		/**
+		 * Opens an existing file, given the inner dimensions.
+		 * Note: Dimensions are only specified for dynarray layers.  Vectors and compile-time fixed arrays do not need a dimension parameter.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		mapped_vector(const char* path, TNs... ns) : mapped_vector(path, element_extents_type(ns...)) {}
+		/**
+		 * Creates (or truncates) a file that holds an empty vector with the given element_extents_type (inner dimensions).
+		 */
+		static mapped_vector create(const char* path, const element_extents_type& extents) {
+			return mapped_vector(buffer_type::create(path, 0), extents);
+		}
+		/**
+		 * Creates (or truncates) a file that holds an empty vector with the given inner dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		static mapped_vector create(const char* path, TNs... ns) {
+			return create(path, element_extents_type(ns...));
+		}
+		mapped_vector(const mapped_vector&) = delete;
+		mapped_vector(mapped_vector&& other) noexcept : data_(std::move(other.data_)), size_(other.size_), capacity_(other.capacity_), extents_(other.extents_) {
+			other.size_ = 0;
+			other.capacity_ = 0;
+		}
+		mapped_vector& operator=(const mapped_vector&) = delete;
+		mapped_vector& operator=(mapped_vector&& other) noexcept {
+			mapped_vector tmp(std::move(other));
+			swap(tmp);
+			return *this;
+		}
+		~mapped_vector() {
+			try {
+				close();
+			}
+			catch (...) {
+				// destructors must not throw; the file keeps its slack
+			}
+		}
+
+		friend void swap(mapped_vector& a, mapped_vector& b) noexcept {
+			a.swap(b);
+		}
+		void swap(mapped_vector& other) noexcept {
+			using std::swap;
+			swap(data_, other.data_);
+			swap(size_, other.size_);
+			swap(capacity_, other.capacity_);
+			swap(extents_, other.extents_);
+		}
+
+		/**
+		 * Truncates the file to size() elements and unmaps it.  The vector is empty afterwards.
+		 */
+		void close() {
+			if (capacity_ != size_) {
+				data_.resize(size_ * extents_.stride());
+			}
+			data_ = buffer_type();
+			size_ = 0;
+			capacity_ = 0;
+		}
+
+		/**
+		 * Converting operator to dynarray_ref.
+		 */
+		operator dynarray_ref<T>() noexcept {
+			return dynarray_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+		/**
+		 * Converting operator to dynarray_const_ref.
+		 */
+		operator dynarray_const_ref<T>() const noexcept {
+			return dynarray_const_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+
+		/**
+		 * Gets a pointer to the underlying base elements.  This pointer is invalidated whenever the capacity changes.
+		 */
+		base_element* data() noexcept { return data_.data(); }
+		const base_element* data() const noexcept { return data_.data(); }
+
+		reference operator[](size_type index) noexcept { assert(index < size_); return static_cast<dynarray_ref<T>>(*this)[index]; }
+		const_reference operator[](size_type index) const noexcept { assert(index < size_); return static_cast<dynarray_const_ref<T>>(*this)[index]; }
+		reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+
+		size_type size() const noexcept { return size_; }
+		size_type max_size() const noexcept { return std::numeric_limits<difference_type>::max(); }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+		size_type capacity() const noexcept { return capacity_; }
+
+		const_iterator cbegin() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).begin(); }
+		const_iterator cend() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).end(); }
+		const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+		const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+		const_iterator begin() const noexcept { return cbegin(); }
+		iterator begin() noexcept { return static_cast<dynarray_ref<T>>(*this).begin(); }
+		const_iterator end() const noexcept { return cend(); }
+		iterator end() noexcept { return static_cast<dynarray_ref<T>>(*this).end(); }
+		const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(end()); }
+		reverse_iterator rbegin() noexcept { return std::make_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(begin()); }
+		reverse_iterator rend() noexcept { return std::make_reverse_iterator(begin()); }
+
+		reference front() noexcept { return operator[](0); }
+		const_reference front() const noexcept { return operator[](0); }
+		reference back() noexcept { return operator[](size_ - 1); }
+		const_reference back() const noexcept { return operator[](size_ - 1); }
+
+		/**
+		 * Reserves enough space in the file to store at least new_cap elements, without further remapping.
+		 */
+		void reserve(size_type new_cap) {
+			if (new_cap <= capacity_) return;
+			data_.resize(new_cap * extents_.stride());
+			capacity_ = new_cap;
+		}
+		/**
+		 * Truncates the file to exactly size() elements.
+		 */
+		void shrink_to_fit() {
+			if (size_ == capacity_) return;
+			data_.resize(size_ * extents_.stride());
+			capacity_ = size_;
+		}
+		/**
+		 * Removes all existing elements from the vector.  The file is not truncated until shrink_to_fit() or close() is called.
+		 */
+		void clear() noexcept { size_ = 0; }
+
+		/**
+		 * Adds an element to the back of the vector, extending the file if necessary.  This is safe even if `value` is a reference to an element of this same vector.
+		 */
+		void push_back(const_reference value) {
+			if (size_ == capacity_) {
+				// the mapping might move, so remember where the value is if it is part of this vector
+				const base_element* src = value_data(value);
+				const bool internal = src >= data() && src < data() + size_ * extents_.stride();
+				const size_type offset = internal ? static_cast<size_type>(src - data()) : 0;
+				reserve(Growth::next_capacity(capacity_, size_ + 1));
+				if (internal) src = data() + offset;
+				std::copy_n(src, extents_.stride(), data() + size_ * extents_.stride());
+			}
+			else {
+				std::copy_n(value_data(value), extents_.stride(), data() + size_ * extents_.stride());
+			}
+			++size_;
+		}
+		/**
+		 * Removes the back element from this vector.  This is undefined behaviour if size()==0.
+		 */
+		void pop_back() noexcept { --size_; }
+
+		/**
+		 * Gets the extents of elements that are stored in this vector.
+		 */
+		const element_extents_type& extents() const noexcept { return extents_; }
+
+		/**
+		 * Writes modified pages back to the file.
+		 */
+		void flush() { data_.flush(); }
+
+		/**
+		 * Compares if the vector is elementwise equal to another array.  If they have different shape or different number of elements, then it will also return false.
+		 */
+		friend bool operator==(const mapped_vector& a, const dynarray_const_ref<T>& b) {
+			return static_cast<dynarray_const_ref<T>>(a) == b;
+		}
+		friend bool operator!=(const mapped_vector& a, const dynarray_const_ref<T>& b) { return !(a == b); };
+
+	private:
+		mapped_vector(buffer_type&& buf, const element_extents_type& extents) noexcept : data_(std::move(buf)), size_(0), capacity_(0), extents_(extents) {}
+
+		static const base_element* value_data(const_reference value) noexcept {
+			if constexpr (element_traits<T>::is_inner_container) {
+				return value.data();
+			}
+			else {
+				return &value;
+			}
+		}
+
+		buffer_type data_;
+		size_t size_; // the size of the current dimension
+		size_t capacity_; // the capacity of the current dimension
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+}
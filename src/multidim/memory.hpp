@@ -87,7 +87,7 @@ namespace multidim {
     }
 
     template <typename T, typename Reference>
-    constexpr inline void uninitialized_copy_at(const T& val, Reference& dest) {
+    constexpr inline void uninitialized_copy_at(const T& val, Reference&& dest) {
         if constexpr (std::is_base_of_v<multidim::reference_base, std::decay_t<Reference>>) {
             static_assert(std::is_base_of_v<multidim::reference_base, std::decay_t<T>>);
             const auto raw_first = dest.data();
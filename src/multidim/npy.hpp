@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm> // for std::min() and std::find()
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memcpy()
+#include <istream>
+#include <limits>
+#include <memory> // for std::unique_ptr
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "serialize.hpp" // for format_error, const_view_t and the container helpers
+#include "core.hpp"
+
+/**
+ * Reading and writing NumPy .npy files (format versions 1.0, 2.0 and 3.0).
+ * See https://numpy.org/doc/stable/reference/generated/numpy.lib.format.html for the format.
+ *
+ * The shape in the file must match the extent chain of the container: the number of dimensions must be equal, compile-time extents must be equal, and dynamic extents take their size from the file.
+ * Only arithmetic base elements in the native byte order are supported.
+ */
+
+namespace multidim {
+
+	namespace detail {
+		constexpr inline char npy_magic[6] = { '\x93', 'N', 'U', 'M', 'P', 'Y' };
+		constexpr inline size_t npy_alignment = 64; // the header is padded so that the data is aligned to this
+
+		template <typename T>
+		inline std::string npy_descr() {
+			static_assert(std::is_arithmetic_v<T>, "only arithmetic base elements can be stored in .npy files");
+			std::string ret;
+			ret += sizeof(T) == 1 ? '|' : native_endianness() == binary_endianness::little ? '<' : '>';
+			ret += type_kind<T>();
+			ret += std::to_string(sizeof(T));
+			return ret;
+		}
+
+		/**
+		 * Converts between an extent chain and an .npy shape (outermost dimension first).
+		 */
+		template <typename E>
+		struct npy_shape_codec;
+		template <>
+		struct npy_shape_codec<unit_extent> {
+			static void encode(const unit_extent&, std::string&) {}
+			static unit_extent decode(const std::uint64_t*) noexcept { return unit_extent{}; }
+		};
+		template <typename E, size_t N>
+		struct npy_shape_codec<static_extent<E, N>> {
+			static void encode(const static_extent<E, N>& e, std::string& out) {
+				out += std::to_string(N);
+				out += ", ";
+				npy_shape_codec<E>::encode(e.inner(), out);
+			}
+			static static_extent<E, N> decode(const std::uint64_t* in) {
+				if (*in != N) throw format_error("multidim: .npy shape does not match compile-time extent");
+				return static_extent<E, N>(npy_shape_codec<E>::decode(in + 1));
+			}
+		};
+		template <typename E>
+		struct npy_shape_codec<dynamic_extent<E>> {
+			static void encode(const dynamic_extent<E>& e, std::string& out) {
+				out += std::to_string(e.top_extent());
+				out += ", ";
+				npy_shape_codec<E>::encode(e.inner(), out);
+			}
+			static dynamic_extent<E> decode(const std::uint64_t* in) {
+				if (*in > std::numeric_limits<size_t>::max()) throw format_error("multidim: .npy shape too large");
+				return dynamic_extent<E>(static_cast<size_t>(*in), npy_shape_codec<E>::decode(in + 1));
+			}
+		};
+
+		/**
+		 * The parsed contents of an .npy header.
+		 */
+		struct npy_header {
+			std::string descr;
+			bool fortran_order = false;
+			std::uint64_t shape[std::numeric_limits<std::uint8_t>::max()];
+			size_t rank = 0;
+		};
+
+		/**
+		 * A minimal parser for the Python dict literal in the .npy header, e.g. "{'descr': '<i4', 'fortran_order': False, 'shape': (3, 4), }".
+		 */
+		class npy_header_parser {
+		public:
+			explicit npy_header_parser(const std::string& str) noexcept : str_(str), pos_(0) {}
+			npy_header parse() {
+				npy_header ret;
+				bool has_descr = false, has_fortran_order = false, has_shape = false;
+				expect('{');
+				while (skip_ws(), peek() != '}') {
+					const std::string key = parse_string();
+					expect(':');
+					if (key == "descr") {
+						ret.descr = parse_string();
+						has_descr = true;
+					}
+					else if (key == "fortran_order") {
+						skip_ws();
+						if (str_.compare(pos_, 4, "True") == 0) { ret.fortran_order = true; pos_ += 4; }
+						else if (str_.compare(pos_, 5, "False") == 0) { ret.fortran_order = false; pos_ += 5; }
+						else fail();
+						has_fortran_order = true;
+					}
+					else if (key == "shape") {
+						expect('(');
+						while (skip_ws(), peek() != ')') {
+							if (ret.rank == std::size(ret.shape)) fail();
+							ret.shape[ret.rank++] = parse_uint();
+							skip_ws();
+							if (peek() == ',') ++pos_;
+						}
+						++pos_;
+						has_shape = true;
+					}
+					else {
+						fail();
+					}
+					skip_ws();
+					if (peek() == ',') ++pos_;
+				}
+				if (!has_descr || !has_fortran_order || !has_shape) fail();
+				return ret;
+			}
+		private:
+			[[noreturn]] static void fail() { throw format_error("multidim: malformed .npy header"); }
+			char peek() const {
+				if (pos_ >= str_.size()) fail();
+				return str_[pos_];
+			}
+			void skip_ws() noexcept {
+				while (pos_ < str_.size() && (str_[pos_] == ' ' || str_[pos_] == '\t' || str_[pos_] == '\n')) ++pos_;
+			}
+			void expect(char c) {
+				skip_ws();
+				if (peek() != c) fail();
+				++pos_;
+			}
+			std::string parse_string() {
+				skip_ws();
+				const char quote = peek();
+				if (quote != '\'' && quote != '"') fail();
+				const size_t end = str_.find(quote, pos_ + 1);
+				if (end == std::string::npos) fail();
+				std::string ret = str_.substr(pos_ + 1, end - pos_ - 1);
+				pos_ = end + 1;
+				return ret;
+			}
+			std::uint64_t parse_uint() {
+				if (peek() < '0' || peek() > '9') fail();
+				std::uint64_t ret = 0;
+				while (pos_ < str_.size() && str_[pos_] >= '0' && str_[pos_] <= '9') {
+					const unsigned digit = static_cast<unsigned>(str_[pos_++] - '0');
+					if (ret > (std::numeric_limits<std::uint64_t>::max() - digit) / 10) fail();
+					ret = ret * 10 + digit;
+				}
+				return ret;
+			}
+
+			const std::string& str_;
+			size_t pos_;
+		};
+
+		/**
+		 * Gets the length of the header (including the magic and the length field) from the start of an .npy file, and checks the magic and version.
+		 * The prefix must contain 10 bytes for version 1.0, and 12 bytes for later versions (see npy_prefix_size()); prefix_size is set accordingly.
+		 */
+		inline size_t npy_prefix_size(const unsigned char* prefix) noexcept {
+			return prefix[6] == 1 ? 10 : 12;
+		}
+		inline size_t npy_header_length(const unsigned char* prefix, size_t& prefix_size) {
+			if (std::memcmp(prefix, npy_magic, sizeof(npy_magic)) != 0) throw format_error("multidim: not an .npy file");
+			const unsigned major = prefix[6];
+			if (major == 1) {
+				prefix_size = 10;
+				return prefix_size + (prefix[8] | static_cast<size_t>(prefix[9]) << 8);
+			}
+			else if (major == 2 || major == 3) {
+				prefix_size = 12;
+				return prefix_size + (prefix[8] | static_cast<size_t>(prefix[9]) << 8 | static_cast<size_t>(prefix[10]) << 16 | static_cast<size_t>(prefix[11]) << 24);
+			}
+			throw format_error("multidim: unsupported .npy format version");
+		}
+
+		/**
+		 * Checks that the parsed header matches the container type X, and returns the extents of the container.
+		 */
+		template <typename X>
+		inline typename X::container_extents_type npy_extents(const npy_header& header) {
+			using extents_type = typename X::container_extents_type;
+			using base_element = typename X::base_element;
+			std::string descr = header.descr;
+			if (!descr.empty() && descr[0] == '=') descr[0] = native_endianness() == binary_endianness::little ? '<' : '>';
+			if (sizeof(base_element) == 1 && !descr.empty() && (descr[0] == '<' || descr[0] == '>')) descr[0] = '|';
+			if (descr != npy_descr<base_element>()) throw format_error("multidim: .npy dtype does not match the base element type");
+			if (header.rank != extent_rank<extents_type>::value) throw format_error("multidim: .npy shape does not match the number of dimensions");
+			return npy_shape_codec<extents_type>::decode(header.shape);
+		}
+
+		/**
+		 * Copies Fortran-order (column-major) data into C-order (row-major) data of the given shape.
+		 * Fortran order reverses every axis, so the middle indices are walked with an odometer, and each fixed value of them is a 2D transpose between the outermost and innermost dimensions, which is done in cache-sized blocks.
+		 */
+		template <typename T>
+		inline void fortran_to_c_order(const T* src, T* dst, const std::uint64_t* shape, size_t rank) {
+			if (rank <= 1) {
+				std::copy_n(src, rank == 0 ? 1 : static_cast<size_t>(shape[0]), dst);
+				return;
+			}
+			constexpr size_t block = 64 / sizeof(T) > 8 ? 64 / sizeof(T) : 8;
+			// src_strides[d] and dst_strides[d] are the Fortran-order and C-order strides of axis d
+			std::vector<size_t> src_strides(rank), dst_strides(rank);
+			src_strides[0] = 1;
+			for (size_t d = 1; d != rank; ++d) src_strides[d] = src_strides[d - 1] * static_cast<size_t>(shape[d - 1]);
+			dst_strides[rank - 1] = 1;
+			for (size_t d = rank - 1; d != 0; --d) dst_strides[d - 1] = dst_strides[d] * static_cast<size_t>(shape[d]);
+			const size_t rows = static_cast<size_t>(shape[0]);
+			const size_t cols = static_cast<size_t>(shape[rank - 1]);
+			if (std::find(shape, shape + rank, std::uint64_t{ 0 }) != shape + rank) return;
+			const size_t dst_row_stride = dst_strides[0];
+			const size_t src_col_stride = src_strides[rank - 1];
+			std::vector<size_t> index(rank); // only the middle indices [1, rank - 1) are used
+			size_t src_offset = 0, dst_offset = 0;
+			while (true) {
+				const T* const src_base = src + src_offset;
+				T* const dst_base = dst + dst_offset;
+				for (size_t ib = 0; ib < rows; ib += block) {
+					const size_t ie = std::min(ib + block, rows);
+					for (size_t jb = 0; jb < cols; jb += block) {
+						const size_t je = std::min(jb + block, cols);
+						for (size_t i = ib; i != ie; ++i) {
+							for (size_t j = jb; j != je; ++j) {
+								dst_base[i * dst_row_stride + j] = src_base[i + j * src_col_stride];
+							}
+						}
+					}
+				}
+				// advance the middle indices, innermost first
+				size_t d = rank - 1;
+				while (--d != 0) {
+					src_offset += src_strides[d];
+					dst_offset += dst_strides[d];
+					if (++index[d] != static_cast<size_t>(shape[d])) break;
+					src_offset -= index[d] * src_strides[d];
+					dst_offset -= index[d] * dst_strides[d];
+					index[d] = 0;
+				}
+				if (d == 0) return;
+			}
+		}
+	}
+
+	/**
+	 * Writes a container (array, dynarray, vector, or a reference to one of them) as an .npy file (in C order) to a stream.  The stream should be opened in binary mode.
+	 * The data is aligned to 64 bytes from the start of the file, so the file can be viewed with view_npy() after it is mapped into memory.
+	 */
+	template <typename X>
+	inline void save_npy(std::ostream& os, const X& x) {
+		using extents_type = typename X::container_extents_type;
+		using base_element = typename X::base_element;
+		const extents_type extents = detail::container_extents_of(x);
+		std::string dict = "{'descr': '" + detail::npy_descr<base_element>() + "', 'fortran_order': False, 'shape': (";
+		detail::npy_shape_codec<extents_type>::encode(extents, dict);
+		dict.pop_back(); // "(3, 4, " -> "(3, 4,", but "(3,)" must keep its comma to be a tuple
+		if constexpr (detail::extent_rank<extents_type>::value > 1) dict.pop_back();
+		dict += "), }";
+		// the header is terminated by '\n' and padded with spaces so that the data is aligned
+		const auto padded_total = [&dict](size_t prefix_size) { return (prefix_size + dict.size() + 1 + detail::npy_alignment - 1) / detail::npy_alignment * detail::npy_alignment; };
+		const bool v1 = padded_total(10) - 10 <= 0xFFFF;
+		const size_t prefix_size = v1 ? 10 : 12;
+		const size_t total = padded_total(prefix_size);
+		const size_t header_len = total - prefix_size;
+		dict.append(header_len - dict.size() - 1, ' ');
+		dict += '\n';
+		unsigned char prefix[12];
+		std::memcpy(prefix, detail::npy_magic, sizeof(detail::npy_magic));
+		prefix[6] = v1 ? 1 : 2;
+		prefix[7] = 0;
+		for (size_t i = 8; i != prefix_size; ++i) prefix[i] = static_cast<unsigned char>(header_len >> ((i - 8) * 8));
+		const size_t payload_size = extents.stride() * sizeof(base_element);
+		if (!os.write(reinterpret_cast<const char*>(prefix), static_cast<std::streamsize>(prefix_size))
+			|| !os.write(dict.data(), static_cast<std::streamsize>(dict.size()))
+			|| !os.write(reinterpret_cast<const char*>(x.data()), static_cast<std::streamsize>(payload_size))) {
+			throw std::ios_base::failure("multidim: stream write failed");
+		}
+	}
+
+	/**
+	 * Reads an .npy file from a stream into a container of type X (array, dynarray or vector).  The stream should be opened in binary mode.
+	 * Fortran-order files are transposed into C order.
+	 * Throws format_error if the file is malformed or does not match X.
+	 */
+	template <typename X>
+	inline X load_npy(std::istream& is) {
+		using base_element = typename X::base_element;
+		const auto read = [&is](void* buf, size_t sz) {
+			if (!is.read(static_cast<char*>(buf), static_cast<std::streamsize>(sz))) throw format_error("multidim: unexpected end of stream");
+		};
+		unsigned char prefix[12];
+		read(prefix, 10);
+		if (detail::npy_prefix_size(prefix) > 10) read(prefix + 10, detail::npy_prefix_size(prefix) - 10);
+		size_t prefix_size;
+		const size_t header_end = detail::npy_header_length(prefix, prefix_size);
+		std::string dict(header_end - prefix_size, '\0');
+		read(dict.data(), dict.size());
+		const detail::npy_header header = detail::npy_header_parser(dict).parse();
+		X ret = detail::make_container<X>(detail::npy_extents<X>(header));
+		const size_t count = detail::container_extents_of(ret).stride();
+		if (header.fortran_order && header.rank > 1) {
+			const std::unique_ptr<base_element[]> tmp(new base_element[count]);
+			read(tmp.get(), count * sizeof(base_element));
+			detail::fortran_to_c_order(tmp.get(), ret.data(), header.shape, header.rank);
+		}
+		else {
+			read(ret.data(), count * sizeof(base_element));
+		}
+		return ret;
+	}
+
+	/**
+	 * Gets a read-only view of an .npy file at the given address (e.g. a memory-mapped file), without copying the data.
+	 * Only C-order files can be viewed; Fortran-order files throw format_error (load them with load_npy() instead).
+	 * Throws format_error if the file is malformed, does not fit in size bytes, does not match X, or if the data is misaligned for X::base_element.
+	 */
+	template <typename X>
+	inline const_view_t<X> view_npy(const void* mapped, size_t size) {
+		using extents_type = typename X::container_extents_type;
+		using base_element = typename X::base_element;
+		const unsigned char* const bytes = static_cast<const unsigned char*>(mapped);
+		if (size < 12) throw format_error("multidim: unexpected end of buffer");
+		size_t prefix_size;
+		const size_t header_end = detail::npy_header_length(bytes, prefix_size);
+		if (header_end > size) throw format_error("multidim: unexpected end of buffer");
+		const std::string dict(reinterpret_cast<const char*>(bytes) + prefix_size, header_end - prefix_size);
+		const detail::npy_header header = detail::npy_header_parser(dict).parse();
+		const extents_type extents = detail::npy_extents<X>(header);
+		if (header.fortran_order && header.rank > 1) throw format_error("multidim: Fortran-order .npy files cannot be viewed without copying");
+		if (extents.stride() > (size - header_end) / sizeof(base_element)) throw format_error("multidim: unexpected end of buffer");
+		const void* const payload = bytes + header_end;
+		if (reinterpret_cast<std::uintptr_t>(payload) % alignof(base_element) != 0) throw format_error("multidim: .npy data is misaligned");
+		return const_view_t<X>(static_cast<const base_element*>(payload), extents);
+	}
+}
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm> // for std::fill_n()
+#include <cstddef>
+#include <exception> // for std::exception_ptr
+#include <fstream>
+#include <memory> // for std::unique_ptr, std::uninitialized_value_construct_n() and std::destroy_n()
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility> // for std::pair
+#include <vector>
+
+#if defined(__linux__) && __has_include(<pthread.h>) && __has_include(<sched.h>)
+#include <pthread.h>
+#include <sched.h>
+#define MULTIDIM_NUMA_HAS_AFFINITY 1
+#endif
+#if defined(__linux__) && __has_include(<sys/syscall.h>) && __has_include(<unistd.h>)
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_mbind)
+#define MULTIDIM_NUMA_HAS_MBIND 1
+#endif
+#endif
+
+#include "dynarray.hpp"
+#include "core.hpp"
+
+/**
+ * NUMA-aware construction of large arrays.
+ *
+ * Memory is usually placed on the NUMA node of the thread that first touches it, so an array that is initialized by one thread ends up entirely on one node.
+ * make_numa_dynarray() instead initializes the array with one thread per row range, each pinned to a node, so that each range lands on the node of the thread that will later scan it with numa_parallel_for() (which uses the same ranges).
+ * Where the mbind() system call is available, pages can also be interleaved over the nodes, or bound to them explicitly.
+ * Everything degrades gracefully: without node information there is a single node, without thread affinity the threads are not pinned, and without mbind() placement falls back to first touch.
+ */
+
+namespace multidim {
+
+	/**
+	 * How the pages of a new array are placed on NUMA nodes.
+	 */
+	enum class numa_policy {
+		first_touch, // each page lands on the node of the thread that initializes it
+		interleave, // pages are spread round-robin over the nodes (with mbind(MPOL_INTERLEAVE)); good for arrays that are accessed randomly
+		bind // the pages of each thread's row range are bound to that thread's node (with mbind(MPOL_BIND)), even if other threads touch them first
+	};
+
+	struct numa_options {
+		numa_policy policy = numa_policy::first_touch;
+		/**
+		 * The number of threads (and hence row ranges).  0 means std::thread::hardware_concurrency().
+		 */
+		size_t threads = 0;
+		/**
+		 * The nodes to use, e.g. {0, 1}.  Thread i runs on nodes[i % nodes.size()].  Empty means all online nodes.
+		 */
+		std::vector<int> nodes;
+	};
+
+	namespace detail {
+		/**
+		 * Parses a Linux cpu/node list such as "0-3,8,10-11".
+		 */
+		inline std::vector<int> parse_id_list(const std::string& list) {
+			std::vector<int> ret;
+			size_t pos = 0;
+			while (pos < list.size()) {
+				size_t end = list.find(',', pos);
+				if (end == std::string::npos) end = list.size();
+				const std::string item = list.substr(pos, end - pos);
+				const size_t dash = item.find('-');
+				try {
+					const int first = std::stoi(item.substr(0, dash));
+					const int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+					for (int id = first; id <= last; ++id) ret.push_back(id);
+				}
+				catch (const std::exception&) {
+					// not a number (e.g. a trailing newline); skip it
+				}
+				pos = end + 1;
+			}
+			return ret;
+		}
+		inline std::vector<int> read_id_list(const std::string& path) {
+			std::ifstream ifs(path);
+			std::string list;
+			if (!std::getline(ifs, list)) return {};
+			return parse_id_list(list);
+		}
+
+		inline size_t resolve_threads(const numa_options& options) noexcept {
+			if (options.threads != 0) return options.threads;
+			const size_t hw = std::thread::hardware_concurrency();
+			return hw != 0 ? hw : 1;
+		}
+		inline std::vector<int> resolve_nodes(const numa_options& options) {
+			if (!options.nodes.empty()) return options.nodes;
+			std::vector<int> ret = read_id_list("/sys/devices/system/node/online");
+			if (ret.empty()) ret.push_back(0);
+			return ret;
+		}
+
+		/**
+		 * Pins the calling thread to the cpus of the given node.  Does nothing if that is not possible.
+		 */
+		inline void pin_to_node([[maybe_unused]] int node) noexcept {
+#ifdef MULTIDIM_NUMA_HAS_AFFINITY
+			std::vector<int> cpus;
+			try {
+				cpus = read_id_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+			}
+			catch (...) {
+				return;
+			}
+			if (cpus.empty()) return;
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for (int cpu : cpus) {
+				if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+			}
+			::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+#endif
+		}
+
+		/**
+		 * Applies a memory policy to the whole pages in [ptr, ptr + bytes).  Returns false if that is not possible, in which case the pages keep the default (first touch) policy.
+		 */
+		inline bool mbind_range([[maybe_unused]] void* ptr, [[maybe_unused]] size_t bytes, [[maybe_unused]] numa_policy policy, [[maybe_unused]] const std::vector<int>& nodes) noexcept {
+#ifdef MULTIDIM_NUMA_HAS_MBIND
+			constexpr int mpol_bind = 2;
+			constexpr int mpol_interleave = 3;
+			constexpr size_t mask_bits = 1024;
+			const long page = ::sysconf(_SC_PAGESIZE);
+			if (page <= 0) return false;
+			const size_t page_size = static_cast<size_t>(page);
+			const size_t begin = (reinterpret_cast<size_t>(ptr) + page_size - 1) / page_size * page_size;
+			const size_t end = (reinterpret_cast<size_t>(ptr) + bytes) / page_size * page_size;
+			if (begin >= end) return true; // no whole pages to place
+			unsigned long mask[mask_bits / (8 * sizeof(unsigned long))] = {};
+			for (int node : nodes) {
+				if (node < 0 || static_cast<size_t>(node) >= mask_bits) return false;
+				mask[static_cast<size_t>(node) / (8 * sizeof(unsigned long))] |= 1ul << (static_cast<size_t>(node) % (8 * sizeof(unsigned long)));
+			}
+			const int mode = policy == numa_policy::interleave ? mpol_interleave : mpol_bind;
+			return ::syscall(SYS_mbind, begin, end - begin, mode, mask, mask_bits + 1, 0u) == 0;
+#else
+			return false;
+#endif
+		}
+
+		/**
+		 * Runs f(i) on parts threads, where thread i is pinned to nodes[i % nodes.size()].  Rethrows the exception of the first part that failed.
+		 */
+		template <typename Func>
+		inline void run_pinned(size_t parts, const std::vector<int>& nodes, Func&& f) {
+			std::vector<std::exception_ptr> errors(parts);
+			std::vector<std::thread> workers;
+			workers.reserve(parts);
+			std::exception_ptr start_error;
+			try {
+				for (size_t i = 0; i != parts; ++i) {
+					workers.emplace_back([&f, &errors, &nodes, i]() {
+						pin_to_node(nodes[i % nodes.size()]);
+						try { f(i); }
+						catch (...) { errors[i] = std::current_exception(); }
+					});
+				}
+			}
+			catch (...) {
+				start_error = std::current_exception(); // failed to start a thread
+			}
+			for (std::thread& worker : workers) worker.join();
+			if (start_error) std::rethrow_exception(start_error);
+			for (const std::exception_ptr& error : errors) {
+				if (error) std::rethrow_exception(error);
+			}
+		}
+	}
+
+	/**
+	 * Gets the number of online NUMA nodes (1 if this cannot be determined).
+	 */
+	inline size_t numa_node_count() {
+		return detail::resolve_nodes(numa_options{}).size();
+	}
+
+	/**
+	 * Gets the row range [first, last) that part `index` of `parts` handles, when `size` rows are split into contiguous, nearly equal ranges.
+	 * This is the chunking used by make_numa_dynarray() and numa_parallel_for().
+	 */
+	constexpr inline std::pair<size_t, size_t> partition_rows(size_t size, size_t parts, size_t index) noexcept {
+		const size_t base = size / parts;
+		const size_t extra = size % parts; // the first `extra` parts get one more row
+		const size_t first = index * base + (index < extra ? index : extra);
+		return { first, first + base + (index < extra ? 1 : 0) };
+	}
+
+	/**
+	 * Calls f(first, last) for the row ranges of `size` rows, each on its own thread pinned to a node, with the same chunking and node assignment as make_numa_dynarray().
+	 * Running a scan this way on an array made by make_numa_dynarray() with the same options keeps memory accesses on the local node.
+	 */
+	template <typename Func>
+	inline void numa_parallel_for(size_t size, const numa_options& options, Func&& f) {
+		const size_t parts = std::min(detail::resolve_threads(options), std::max<size_t>(size, 1));
+		const std::vector<int> nodes = detail::resolve_nodes(options);
+		detail::run_pinned(parts, nodes, [&](size_t i) {
+			const auto [first, last] = partition_rows(size, parts, i);
+			f(first, last);
+		});
+	}
+
+	/**
+	 * Constructs a dynarray whose pages are placed on NUMA nodes according to the options.  The base elements are value-initialized (in parallel).
+	 * The memory is allocated without being touched, optionally given a memory policy with mbind(), and then initialized by one pinned thread per row range.
+	 * Base elements that are not trivially default constructible are constructed in raw storage, which only a dynarray with managed_buffer can free.
+	 */
+	template <typename T, typename BufferKind = plain_buffer>
+	inline dynarray<T, BufferKind> make_numa_dynarray(size_t size, const typename element_traits<T>::extents_type& extents, const numa_options& options = {}) {
+		using base_element = typename element_traits<T>::base_element;
+		const size_t stride = extents.stride();
+		const std::vector<int> nodes = detail::resolve_nodes(options);
+		const size_t parts = std::min(detail::resolve_threads(options), std::max<size_t>(size, 1));
+		if constexpr (std::is_trivially_default_constructible_v<base_element>) {
+			std::unique_ptr<base_element[]> buf(new base_element[size * stride]); // default-initialized, so no page is touched yet
+			if (options.policy == numa_policy::interleave) {
+				detail::mbind_range(buf.get(), size * stride * sizeof(base_element), options.policy, nodes);
+			}
+			base_element* const data = buf.get();
+			detail::run_pinned(parts, nodes, [&](size_t i) {
+				const auto [first, last] = partition_rows(size, parts, i);
+				if (options.policy == numa_policy::bind) {
+					detail::mbind_range(data + first * stride, (last - first) * stride * sizeof(base_element), options.policy, { nodes[i % nodes.size()] });
+				}
+				std::fill_n(data + first * stride, (last - first) * stride, base_element{});
+			});
+			return dynarray<T, BufferKind>(size, extents, dynamic_buffer<base_element, BufferKind>(std::move(buf)));
+		}
+		else {
+			static_assert(std::is_same_v<BufferKind, managed_buffer>, "make_numa_dynarray needs managed_buffer for base elements that are not trivially default constructible");
+			// mbind() only affects pages that have not been touched yet, so the policy is applied to raw storage before the elements are constructed in it
+			using storage = std::aligned_storage_t<sizeof(base_element), alignof(base_element)>;
+			const size_t count = size * stride;
+			std::unique_ptr<storage[]> raw(new storage[count]); // default-initialized, so no page is touched yet
+			if (options.policy == numa_policy::interleave) {
+				detail::mbind_range(raw.get(), count * sizeof(base_element), options.policy, nodes);
+			}
+			base_element* const data = reinterpret_cast<base_element*>(raw.get());
+			std::vector<unsigned char> constructed(parts); // whether each row range has been constructed, so that they can be destroyed if another range fails
+			try {
+				detail::run_pinned(parts, nodes, [&](size_t i) {
+					const auto [first, last] = partition_rows(size, parts, i);
+					if (options.policy == numa_policy::bind) {
+						detail::mbind_range(data + first * stride, (last - first) * stride * sizeof(base_element), options.policy, { nodes[i % nodes.size()] });
+					}
+					std::uninitialized_value_construct_n(data + first * stride, (last - first) * stride);
+					constructed[i] = true;
+				});
+			}
+			catch (...) {
+				for (size_t i = 0; i != parts; ++i) {
+					if (constructed[i]) {
+						const auto [first, last] = partition_rows(size, parts, i);
+						std::destroy_n(data + first * stride, (last - first) * stride);
+					}
+				}
+				throw;
+			}
+			auto destroy = [inner = std::move(raw), count](base_element* p) mutable noexcept {
+				std::destroy_n(p, count);
+				inner.reset();
+			};
+			try {
+				buffer_deleter<base_element> deleter(std::move(destroy));
+				return dynarray<T, BufferKind>(size, extents, dynamic_buffer<base_element, BufferKind>(buffer_ptr<base_element>(data, std::move(deleter))));
+			}
+			catch (...) {
+				// the deleter object could not be allocated, so destroy is still intact, and frees the storage when it goes out of scope
+				std::destroy_n(data, count);
+				throw;
+			}
+		}
+	}
+	/**
+	 * Constructs a dynarray of the given dimensions whose pages are placed on NUMA nodes according to the options.
+	 */
+	template <typename T, typename BufferKind = plain_buffer, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+	inline dynarray<T, BufferKind> make_numa_dynarray(const numa_options& options, size_t size, TNs... ns) {
+		return make_numa_dynarray<T, BufferKind>(size, typename element_traits<T>::extents_type(ns...), options);
+	}
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <new> // for std::bad_alloc
+#include <string>
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MULTIDIM_HAS_MMAP 1
+#endif
+
+namespace multidim {
+
+	/**
+	 * Which kind of pages back a buffer.
+	 */
+	enum class huge_pages {
+		none, // ordinary heap memory
+		transparent, // memory aligned to the huge page size and marked with madvise(MADV_HUGEPAGE), so that the kernel backs it with transparent huge pages when it can
+		hugetlbfs // pages from the preallocated hugetlbfs pool (mmap(MAP_HUGETLB)); if the pool is too small this falls back to transparent
+	};
+
+	/**
+	 * How a managed dynamic_buffer or uninitialized_dynamic_buffer (see managed_buffer) allocates its memory.
+	 * Huge pages cut TLB misses for random access into large arrays, and prefaulting moves the cost of page faults from the first access to the allocation.
+	 * The policies only apply to trivial base elements and to buffers of at least one huge page; other buffers (and platforms without mmap()) use the heap as usual.
+	 */
+	struct buffer_policy {
+		huge_pages pages = huge_pages::none;
+		/**
+		 * Whether to fault in every page at allocation time (mmap(MAP_POPULATE) or madvise(MADV_POPULATE_WRITE)).
+		 */
+		bool populate = false;
+
+		/**
+		 * Whether this policy allocates from the heap.
+		 */
+		constexpr bool is_default() const noexcept { return pages == huge_pages::none && !populate; }
+		friend constexpr bool operator==(const buffer_policy& a, const buffer_policy& b) noexcept { return a.pages == b.pages && a.populate == b.populate; }
+		friend constexpr bool operator!=(const buffer_policy& a, const buffer_policy& b) noexcept { return !(a == b); }
+	};
+
+	namespace detail {
+		constexpr inline size_t transparent_huge_page_size = size_t{ 2 } << 20;
+
+		constexpr inline size_t round_up_to(size_t bytes, size_t alignment) noexcept {
+			return (bytes + alignment - 1) / alignment * alignment;
+		}
+
+		/**
+		 * Gets the default hugetlbfs page size (from /proc/meminfo), or 2 MiB if it is not known.
+		 */
+		inline size_t hugetlb_page_size() {
+			static const size_t size = []() -> size_t {
+				std::ifstream ifs("/proc/meminfo");
+				std::string key;
+				size_t kib;
+				while (ifs >> key) {
+					if (key == "Hugepagesize:" && ifs >> kib && kib != 0) return kib << 10;
+				}
+				return transparent_huge_page_size;
+			}();
+			return size;
+		}
+
+		/**
+		 * Gets whether a buffer of the given size should be allocated with allocate_pages() rather than on the heap.
+		 */
+		constexpr inline bool use_page_allocation([[maybe_unused]] size_t bytes, [[maybe_unused]] const buffer_policy& policy) noexcept {
+#ifdef MULTIDIM_HAS_MMAP
+			return !policy.is_default() && bytes >= transparent_huge_page_size;
+#else
+			return false;
+#endif
+		}
+
+#ifdef MULTIDIM_HAS_MMAP
+		/**
+		 * Faults in every page of [ptr, ptr + bytes), which must be freshly mapped memory.
+		 */
+		inline void populate_pages(void* ptr, size_t bytes) noexcept {
+#ifdef MADV_POPULATE_WRITE
+			if (::madvise(ptr, bytes, MADV_POPULATE_WRITE) == 0) return;
+#endif
+			// older kernels: touch one byte per page (the memory is already zero)
+			const long page = ::sysconf(_SC_PAGESIZE);
+			const size_t step = page > 0 ? static_cast<size_t>(page) : 4096;
+			volatile char* const p = static_cast<char*>(ptr);
+			for (size_t i = 0; i < bytes; i += step) p[i] = 0;
+		}
+
+		/**
+		 * Maps zeroed memory that is aligned to the transparent huge page size and marked with MADV_HUGEPAGE.
+		 * Returns nullptr on failure.
+		 */
+		inline void* map_transparent(size_t bytes, bool populate) noexcept {
+			const size_t align = transparent_huge_page_size;
+			// over-allocate, then trim the ends so that what remains is aligned
+			void* const raw = ::mmap(nullptr, bytes + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (raw == MAP_FAILED) return nullptr;
+			char* const begin = static_cast<char*>(raw);
+			char* const aligned = begin + (align - reinterpret_cast<size_t>(begin) % align) % align;
+			if (aligned != begin) ::munmap(begin, static_cast<size_t>(aligned - begin));
+			if (aligned + bytes != begin + bytes + align) ::munmap(aligned + bytes, static_cast<size_t>(begin + align - aligned));
+#ifdef MADV_HUGEPAGE
+			::madvise(aligned, bytes, MADV_HUGEPAGE); // only a hint; fails e.g. if transparent huge pages are disabled
+#endif
+			if (populate) populate_pages(aligned, bytes); // after madvise(), so that the faults already use huge pages
+			return aligned;
+		}
+
+		/**
+		 * Maps zeroed memory for a buffer of the given size according to the policy.  Throws std::bad_alloc on failure.
+		 * @param mapped_bytes receives the size of the mapping, which must be passed to unmap_pages()
+		 */
+		inline void* allocate_pages(size_t bytes, const buffer_policy& policy, size_t& mapped_bytes) {
+			if (policy.pages == huge_pages::none) {
+				// no alignment needed, so let the kernel prefault while mapping
+				mapped_bytes = bytes;
+				void* const ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | (policy.populate ? MAP_POPULATE : 0), -1, 0);
+				if (ptr == MAP_FAILED) throw std::bad_alloc();
+				return ptr;
+			}
+#ifdef MAP_HUGETLB
+			if (policy.pages == huge_pages::hugetlbfs) {
+				mapped_bytes = round_up_to(bytes, hugetlb_page_size());
+				void* const ptr = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (policy.populate ? MAP_POPULATE : 0), -1, 0);
+				if (ptr != MAP_FAILED) return ptr;
+			}
+#endif
+			mapped_bytes = round_up_to(bytes, transparent_huge_page_size);
+			void* const ptr = map_transparent(mapped_bytes, policy.populate);
+			if (!ptr) throw std::bad_alloc();
+			return ptr;
+		}
+
+		inline void unmap_pages(void* ptr, size_t mapped_bytes) noexcept {
+			::munmap(ptr, mapped_bytes);
+		}
+#else
+		inline void* allocate_pages(size_t, const buffer_policy&, size_t&) { throw std::bad_alloc(); }
+		inline void unmap_pages(void*, size_t) noexcept {}
+#endif
+	}
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <iterator> // for std::reverse_iterator
+#include <memory> // for std::destroy_n() et al
+#include <limits> // for std::numeric_limits<>
+#include <stdexcept> // for std::out_of_range
+#include <type_traits>
+
+#include "dynarray.hpp"
+#include "growth_policy.hpp"
+#include "uninitialized_dynamic_buffer.hpp"
+#include "core.hpp"
+#include "iterator.hpp"
+#include "memory.hpp"
+
+namespace multidim {
+
+	/**
+	 * Represents a growable vector of rows, where each row is like a dynarray<T> whose width (the number of columns) can be changed after construction.
+	 * Each row reserves space for inner_capacity() columns (the pitch), so that resize_inner() only needs to construct or destroy the new or removed columns of each row, as long as the new width fits in the pitch.
+	 * Otherwise, resize_inner() reallocates with geometric slack (according to the growth policy), like push_back() does for rows.
+	 * Since rows are not adjacent to each other in memory (unless the width is equal to the pitch), iterators are indexed_iterators and there is no conversion to dynarray_ref.
+	 * @tparam T the element type of each row; if rows are one-dimensional then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 * @tparam Growth the growth policy, which decides the new capacity (for both rows and columns) when the container runs out of space (see geometric_growth)
+	 */
+	template <typename T, typename Growth = default_growth>
+	class pitched_vector {
+	public:
+		using value_type = void;
+		using reference = dynarray_ref<T>;
+		using const_reference = dynarray_const_ref<T>;
+		using pointer = void;
+		using const_pointer = void;
+		using iterator = indexed_iterator<pitched_vector, false>;
+		using const_iterator = indexed_iterator<pitched_vector, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using element_extents_type = dynamic_extent<typename element_traits<T>::extents_type>;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		using buffer_type = uninitialized_dynamic_buffer<base_element>;
+		using growth_policy = Growth;
+
+		constexpr pitched_vector(const pitched_vector& other) : data_(other.size_ * other.extents_.stride()), size_(other.size_), capacity_(other.size_), pitch_(other.extents_.top_extent()), extents_(other.extents_) {
+			for (size_type i = 0; i != size_; ++i) {
+				std::uninitialized_copy_n(other.row_data(i), extents_.stride(), row_data(i));
+			}
+		}
+		constexpr pitched_vector(pitched_vector&& other) noexcept : data_(std::move(other.data_)), size_(other.size_), capacity_(other.capacity_), pitch_(other.pitch_), extents_(other.extents_) {
+			other.size_ = 0;
+			other.capacity_ = 0;
+		}
+		/**
+		 * Constructs a pitched_vector from the given row extents and the initial number of columns to reserve in each row.  This should not generally be used directly.
+		 */
+		constexpr explicit pitched_vector(const element_extents_type& extents, size_type pitch) noexcept : size_(0), capacity_(0), pitch_(std::max(pitch, extents.top_extent())), extents_(extents) {}
+		/**
+		 * Constructs a pitched_vector from the given dimensions.  The first dimension is the initial number of columns in each row.
+		 * Note: Dimensions are only specified for dynarray layers.  Compile-time fixed arrays do not need a dimension parameter.
+		 */
+		template <typename TN, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TN>, std::is_convertible<size_t, TNs>...>>>
+		constexpr explicit pitched_vector(TN n, TNs... ns) noexcept : pitched_vector(element_extents_type(n, ns...), n) {}
+		constexpr pitched_vector& operator=(const pitched_vector& other) {
+			pitched_vector tmp(other);
+			swap(tmp);
+			return *this;
+		}
+		constexpr pitched_vector& operator=(pitched_vector&& other) noexcept {
+			clear();
+			pitched_vector tmp(std::move(other));
+			swap(tmp);
+			return *this;
+		}
+
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && __cpp_lib_constexpr_dynamic_alloc >= 201907
+		constexpr ~pitched_vector() {
+#else
+		~pitched_vector() {
+#endif
+			clear();
+		}
+
+		/**
+		 * Swaps two pitched_vectors.  This will invalidate references to both vectors.
+		 */
+		friend constexpr void swap(pitched_vector& a, pitched_vector& b) noexcept {
+			a.swap(b);
+		}
+		/**
+		 * Swaps this pitched_vector with another one.  This will invalidate references to both vectors.
+		 */
+		constexpr void swap(pitched_vector& other) noexcept {
+			using std::swap;
+			swap(data_, other.data_);
+			swap(size_, other.size_);
+			swap(capacity_, other.capacity_);
+			swap(pitch_, other.pitch_);
+			swap(extents_, other.extents_);
+		}
+
+	private:
+		/**
+		 * Gets the number of base elements between the starts of two adjacent rows.
+		 */
+		constexpr size_type row_stride() const noexcept { return pitch_ * extents_.inner().stride(); }
+		/**
+		 * Gets a pointer to the first base element of the row at the specified index.  It is valid (but not dereferenceable) for index to be in [size(), capacity()].
+		 */
+		constexpr base_element* row_data(size_type index) noexcept { return data_.data() + index * row_stride(); }
+		constexpr const base_element* row_data(size_type index) const noexcept { return data_.data() + index * row_stride(); }
+	public:
+		/**
+		 * Gets a reference to the row at the specified index.  It is undefined behaviour if index >= size().
+		 */
+		constexpr reference operator[](size_type index) noexcept {
+			assert(index < size_);
+			return reference{ row_data(index), extents_ };
+		}
+		constexpr const_reference operator[](size_type index) const noexcept {
+			assert(index < size_);
+			return const_reference{ row_data(index), extents_ };
+		}
+		/**
+		 * Gets a reference to the row at the specified index.  Throws std::out_of_range if index >= size().
+		 */
+		constexpr reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		constexpr const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+
+		constexpr size_type size() const noexcept { return size_; }
+		constexpr size_type max_size() const noexcept { return std::numeric_limits<difference_type>::max(); }
+		[[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+		constexpr size_type capacity() const noexcept { return capacity_; }
+		/**
+		 * Gets the number of columns in each row.
+		 */
+		constexpr size_type inner_size() const noexcept { return extents_.top_extent(); }
+		/**
+		 * Gets the number of columns that each row can hold without reallocation (i.e. the pitch).
+		 */
+		constexpr size_type inner_capacity() const noexcept { return pitch_; }
+
+		constexpr const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+		constexpr const_iterator cend() const noexcept { return const_iterator(this, size_); }
+		constexpr const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+		constexpr const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+		constexpr const_iterator begin() const noexcept { return cbegin(); }
+		constexpr iterator begin() noexcept { return iterator(this, 0); }
+		constexpr const_iterator end() const noexcept { return cend(); }
+		constexpr iterator end() noexcept { return iterator(this, size_); }
+		constexpr const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(end()); }
+		constexpr reverse_iterator rbegin() noexcept { return std::make_reverse_iterator(end()); }
+		constexpr const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(begin()); }
+		constexpr reverse_iterator rend() noexcept { return std::make_reverse_iterator(begin()); }
+
+		constexpr reference front() noexcept { return operator[](0); }
+		constexpr const_reference front() const noexcept { return operator[](0); }
+		constexpr reference back() noexcept { return operator[](size_ - 1); }
+		constexpr const_reference back() const noexcept { return operator[](size_ - 1); }
+
+
+
+		/**
+		 * Reserves enough space to store at least new_cap rows, without further reallocation.
+		 */
+		constexpr void reserve(size_type new_cap) {
+			if (new_cap <= capacity_) return;
+			reallocate(new_cap, pitch_);
+		}
+		/**
+		 * Reserves enough space in each row to store at least new_cap columns, so that resize_inner() up to new_cap will not reallocate.
+		 */
+		constexpr void reserve_inner(size_type new_cap) {
+			if (new_cap <= pitch_) return;
+			reallocate(capacity_, new_cap);
+		}
+
+		/**
+		 * Requests the removal of unused capacity, both for rows and for columns.
+		 */
+		constexpr void shrink_to_fit() {
+			if (size_ == capacity_ && inner_size() == pitch_) return;
+			reallocate(size_, inner_size());
+		}
+
+		/**
+		 * Changes the number of columns in every row.  New columns are value-initialized.
+		 * This takes O(size()) time if new_size <= inner_capacity(), and otherwise reallocates with geometric slack.
+		 */
+		constexpr void resize_inner(size_type new_size) {
+			const size_type old_size = inner_size();
+			if (new_size == old_size) return;
+			if (new_size > pitch_) {
+				reallocate(capacity_, Growth::next_capacity(pitch_, new_size));
+			}
+			const size_type inner_stride = extents_.inner().stride();
+			for (size_type i = 0; i != size_; ++i) {
+				if (new_size > old_size) {
+					std::uninitialized_value_construct_n(row_data(i) + old_size * inner_stride, (new_size - old_size) * inner_stride);
+				}
+				else {
+					std::destroy_n(row_data(i) + new_size * inner_stride, (old_size - new_size) * inner_stride);
+				}
+			}
+			extents_ = element_extents_type(new_size, extents_.inner());
+		}
+
+		/**
+		 * Removes all existing rows from the vector.
+		 */
+		constexpr void clear() noexcept {
+			for (size_type i = 0; i != size_; ++i) {
+				std::destroy_n(row_data(i), extents_.stride());
+			}
+			size_ = 0;
+		}
+
+	private:
+		/**
+		 * Moves all existing rows into a newly allocated buffer with the given row capacity and pitch.
+		 */
+		constexpr void reallocate(size_type new_cap, size_type new_pitch) {
+			const size_type new_row_stride = new_pitch * extents_.inner().stride();
+			buffer_type tmp_buf(new_cap * new_row_stride); // might throw std::bad_alloc()
+			for (size_type i = 0; i != size_; ++i) {
+				multidim::uninitialized_move_if_noexcept(row_data(i), row_data(i) + extents_.stride(), tmp_buf.data() + i * new_row_stride);
+				std::destroy_n(row_data(i), extents_.stride());
+			}
+			data_ = std::move(tmp_buf);
+			capacity_ = new_cap;
+			pitch_ = new_pitch;
+		}
+
+	public:
+		/**
+		 * Adds a row to the back of the vector.  The row must have inner_size() columns.  This is safe even if `value` is a reference to a row of this same vector.
+		 */
+		constexpr void push_back(const_reference value) {
+			assert(value.size() == inner_size());
+			if (size_ < capacity_) {
+				std::uninitialized_copy_n(value.data(), extents_.stride(), row_data(size_));
+			}
+			else {
+				const size_type new_capacity = Growth::next_capacity(capacity_, size_ + 1);
+				const size_type stride = row_stride();
+				buffer_type tmp_buf(new_capacity * stride); // might throw std::bad_alloc()
+				// copy the new row before touching the existing ones
+				std::uninitialized_copy_n(value.data(), extents_.stride(), tmp_buf.data() + size_ * stride);
+				for (size_type i = 0; i != size_; ++i) {
+					multidim::uninitialized_move_if_noexcept(row_data(i), row_data(i) + extents_.stride(), tmp_buf.data() + i * stride);
+					std::destroy_n(row_data(i), extents_.stride());
+				}
+				data_ = std::move(tmp_buf);
+				capacity_ = new_capacity;
+			}
+			++size_;
+		}
+
+		/**
+		 * Removes the back row from this vector.  This is undefined behaviour if size()==0.
+		 */
+		constexpr void pop_back() noexcept {
+			--size_;
+			std::destroy_n(row_data(size_), extents_.stride());
+		}
+
+
+
+		/**
+		 * Gets the extents of the rows that are stored in this vector.
+		 */
+		constexpr const element_extents_type& extents() const noexcept { return extents_; }
+
+
+		/**
+		 * Compares if two pitched_vectors are elementwise equal.  The pitch does not participate in the comparison.  If they have different shape or different number of rows, then it will also return false.
+		 */
+		friend constexpr bool operator==(const pitched_vector& a, const pitched_vector& b) {
+			if (a.size_ != b.size_ || !(a.extents_ == b.extents_)) return false;
+			for (size_type i = 0; i != a.size_; ++i) {
+				if (!(a[i] == b[i])) return false;
+			}
+			return true;
+		}
+		friend constexpr bool operator!=(const pitched_vector& a, const pitched_vector& b) { return !(a == b); };
+		// Note: We don't provide lexicographical comparison because it isn't clear what it means to compare arrays of different shape.
+
+	private:
+
+		buffer_type data_;
+		size_t size_; // the number of rows
+		size_t capacity_; // the number of rows that data_ can hold
+		size_t pitch_; // the number of columns that each row in data_ can hold
+		element_extents_type extents_; // the extents of each row, where top_extent() is the current number of columns
+	};
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory> // for std::unique_ptr
+#include <thread> // for std::this_thread::yield()
+#include <utility> // for std::move() and std::exchange()
+#include <vector>
+
+/**
+ * Read-copy-update publication of immutable versions of a container.
+ */
+
+namespace multidim {
+
+	/**
+	 * Holds the current version of a container (e.g. a dynarray lookup table).  Readers never block, and a single writer replaces the whole version at a time.
+	 *
+	 * Readers call read() to get a const_ref, which pins the current version until the const_ref is destroyed.  This costs two atomic increments/decrements on a shared counter, and never waits for the writer.
+	 * The writer calls publish() with a new version, which becomes visible to new readers with one atomic pointer exchange.  The old version is retired, and deleted once every reader that might still see it has finished.
+	 *
+	 * Reclamation is epoch-based: readers register in the counter for the parity of the global epoch when they start, and the epoch may only advance once no reader remains from two epochs ago.
+	 * Hence a version that was retired in epoch e can be deleted once the epoch reaches e + 2.
+	 *
+	 * read() may be called from any number of threads concurrently.  publish(), reclaim() and synchronize() must only be called by one thread at a time (the writer).
+	 * @tparam Container the type of each version; versions are never modified after they are published
+	 */
+	template <typename Container>
+	class rcu_cell {
+	public:
+		/**
+		 * An epoch-protected read-only reference to one version of the container.  The version stays alive (even if a newer one is published) until this is destroyed.
+		 * Readers should not hold a const_ref for long, since that delays the reclamation of every version that is retired in the meantime.
+		 */
+		class const_ref {
+		public:
+			const_ref(const const_ref&) = delete;
+			const_ref(const_ref&& other) noexcept : cell_(std::exchange(other.cell_, nullptr)), ptr_(other.ptr_), parity_(other.parity_) {}
+			const_ref& operator=(const const_ref&) = delete;
+			const_ref& operator=(const_ref&& other) noexcept {
+				const_ref tmp(std::move(other));
+				std::swap(cell_, tmp.cell_);
+				std::swap(ptr_, tmp.ptr_);
+				std::swap(parity_, tmp.parity_);
+				return *this;
+			}
+			~const_ref() {
+				if (cell_) cell_->readers_[parity_].count.fetch_sub(1, std::memory_order_release);
+			}
+
+			const Container& operator*() const noexcept { return *ptr_; }
+			const Container* operator->() const noexcept { return ptr_; }
+			const Container* get() const noexcept { return ptr_; }
+
+		private:
+			friend class rcu_cell;
+			const_ref(const rcu_cell* cell, const Container* ptr, size_t parity) noexcept : cell_(cell), ptr_(ptr), parity_(parity) {}
+
+			const rcu_cell* cell_;
+			const Container* ptr_;
+			size_t parity_;
+		};
+
+		/**
+		 * Constructs a cell whose first version is the given container.
+		 */
+		explicit rcu_cell(Container initial) : current_(new Container(std::move(initial))), epoch_(0) {}
+		rcu_cell(const rcu_cell&) = delete;
+		rcu_cell& operator=(const rcu_cell&) = delete;
+		/**
+		 * Deletes every version.  There must be no readers left.
+		 */
+		~rcu_cell() {
+			delete current_.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * Gets a reference to the current version.  Never blocks.
+		 */
+		const_ref read() const noexcept {
+			while (true) {
+				const std::uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+				const size_t parity = static_cast<size_t>(epoch & 1);
+				readers_[parity].count.fetch_add(1, std::memory_order_seq_cst);
+				// if the epoch moved on in the meantime, the writer might not have seen us, so register again
+				if (epoch_.load(std::memory_order_seq_cst) == epoch) {
+					return const_ref(this, current_.load(std::memory_order_acquire), parity);
+				}
+				readers_[parity].count.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * Makes the given container the current version, and retires the previous one.  Versions retired earlier are deleted if no reader can still see them.
+		 */
+		void publish(Container next) {
+			std::unique_ptr<Container> fresh = std::make_unique<Container>(std::move(next));
+			retired_.reserve(retired_.size() + 1); // so that retiring cannot fail after the exchange
+			Container* const old = current_.exchange(fresh.release(), std::memory_order_acq_rel);
+			retired_.push_back(retired_version{ epoch_.load(std::memory_order_relaxed), std::unique_ptr<Container>(old) });
+			reclaim();
+		}
+
+		/**
+		 * Deletes the retired versions that no reader can still see, advancing the epoch as far as the current readers allow.  Never blocks.
+		 */
+		void reclaim() noexcept {
+			for (int i = 0; i != 2 && !retired_.empty() && try_advance(); ++i) {}
+			const std::uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+			size_t kept = 0;
+			for (retired_version& r : retired_) {
+				if (r.epoch + 2 > epoch) retired_[kept++] = std::move(r);
+			}
+			retired_.erase(retired_.begin() + static_cast<std::ptrdiff_t>(kept), retired_.end());
+		}
+
+		/**
+		 * Waits until every retired version has been deleted, i.e. until all readers that started before the last publish() have finished.
+		 */
+		void synchronize() noexcept {
+			while (!retired_.empty()) {
+				reclaim();
+				if (!retired_.empty()) std::this_thread::yield();
+			}
+		}
+
+		/**
+		 * Gets the number of retired versions that have not been deleted yet.
+		 */
+		size_t retired() const noexcept { return retired_.size(); }
+
+	private:
+		struct retired_version {
+			std::uint64_t epoch; // the epoch in which this version was replaced
+			std::unique_ptr<Container> ptr;
+		};
+		struct alignas(64) reader_counter {
+			std::atomic<size_t> count{ 0 };
+		};
+
+		/**
+		 * Advances the epoch from e to e + 1 if no reader that started in epoch e - 1 remains.
+		 */
+		bool try_advance() noexcept {
+			const std::uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+			if (readers_[static_cast<size_t>((epoch + 1) & 1)].count.load(std::memory_order_seq_cst) != 0) return false;
+			epoch_.store(epoch + 1, std::memory_order_seq_cst);
+			return true;
+		}
+
+		std::atomic<Container*> current_;
+		std::atomic<std::uint64_t> epoch_;
+		mutable reader_counter readers_[2]; // the number of active readers that started in an even/odd epoch
+		std::vector<retired_version> retired_; // only accessed by the writer
+	};
+}
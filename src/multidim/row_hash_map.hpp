@@ -0,0 +1,408 @@
+#pragma once
+
+#include <algorithm> // for std::fill() and std::max()
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator> // for std::forward_iterator_tag
+#include <stdexcept> // for std::out_of_range
+#include <type_traits>
+#include <utility> // for std::pair, std::move() and std::forward()
+#include <vector>
+
+#include "compare.hpp" // for MULTIDIM_HAS_SSE2
+#include "core.hpp"
+#include "hash.hpp"
+#include "vector.hpp"
+
+/**
+ * Hash tables keyed by fixed-width rows, whose keys live together in one multidim::vector instead of in separately allocated nodes.
+ *
+ * Layout (SwissTable-style open addressing):
+ *   keys_, hashes_ (and values_ for maps): dense arrays of the entries, in insertion order except that erasing moves the last entry into the hole
+ *   ctrl_: one control byte per slot, which is empty, deleted, or the low 7 bits of the hash of the entry in that slot
+ *   slots_: the index of the entry in each full slot
+ * Lookups probe groups of 16 control bytes at a time (with SSE2 where available), and only compare keys whose 7 hash bits match.
+ */
+
+namespace multidim {
+
+	namespace detail {
+		constexpr inline std::int8_t ctrl_empty = -128;
+		constexpr inline std::int8_t ctrl_deleted = -2;
+		constexpr inline size_t ctrl_group = 16;
+
+		/**
+		 * Gets a 16-bit mask of the control bytes in the group at ctrl that are equal to value.
+		 */
+		inline unsigned match_ctrl(const std::int8_t* ctrl, std::int8_t value) noexcept {
+#ifdef MULTIDIM_HAS_SSE2
+			const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+			return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value))));
+#else
+			unsigned mask = 0;
+			for (size_t i = 0; i != ctrl_group; ++i) mask |= static_cast<unsigned>(ctrl[i] == value) << i;
+			return mask;
+#endif
+		}
+		/**
+		 * Gets a 16-bit mask of the control bytes in the group at ctrl that are empty or deleted.
+		 */
+		inline unsigned match_ctrl_free(const std::int8_t* ctrl) noexcept {
+#ifdef MULTIDIM_HAS_SSE2
+			return static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)))); // empty and deleted are the only negative control bytes
+#else
+			unsigned mask = 0;
+			for (size_t i = 0; i != ctrl_group; ++i) mask |= static_cast<unsigned>(ctrl[i] < 0) << i;
+			return mask;
+#endif
+		}
+
+		/**
+		 * The part of row_hash_map and row_hash_set that stores the keys and finds them.  Entries are identified by their index in the dense key arena.
+		 */
+		template <typename Inner>
+		class row_table {
+		public:
+			using key_type = Inner;
+			using key_reference = typename element_traits<Inner>::const_reference;
+			using key_extents_type = typename element_traits<Inner>::extents_type;
+			using size_type = size_t;
+			constexpr static size_type npos = static_cast<size_type>(-1);
+
+			explicit row_table(const key_extents_type& extents) : keys_(extents) {}
+
+			size_type size() const noexcept { return hashes_.size(); }
+			[[nodiscard]] bool empty() const noexcept { return hashes_.empty(); }
+			/**
+			 * Gets the number of slots in the table.
+			 */
+			size_type bucket_count() const noexcept { return ctrl_.size(); }
+			/**
+			 * Gets the keys, in the order of the entries.
+			 */
+			const multidim::vector<Inner>& keys() const noexcept { return keys_; }
+
+			/**
+			 * Gets the index of the entry with the given key, or npos if there is none.
+			 */
+			size_type find_index(key_reference key) const {
+				if (ctrl_.empty()) return npos;
+				const std::uint64_t hash = hash_key(key);
+				const size_type groups = ctrl_.size() / ctrl_group;
+				size_type group = static_cast<size_type>(hash >> 7) & (groups - 1);
+				for (size_type step = 1;; ++step) {
+					const std::int8_t* const ctrl = ctrl_.data() + group * ctrl_group;
+					for (unsigned mask = match_ctrl(ctrl, h2(hash)); mask != 0; mask &= mask - 1) {
+						const size_type entry = slots_[group * ctrl_group + count_trailing_zeros(mask)];
+						if (hashes_[entry] == hash && keys_[entry] == key) return entry;
+					}
+					if (match_ctrl(ctrl, ctrl_empty) != 0) return npos;
+					group = (group + step) & (groups - 1); // triangular probing visits every group
+				}
+			}
+
+			/**
+			 * Reserves space for at least count entries without rehashing.
+			 */
+			void reserve(size_type count) {
+				keys_.reserve(count);
+				hashes_.reserve(count);
+				if (count > growth_capacity(ctrl_.size())) rehash(capacity_for(count));
+			}
+
+			void clear() noexcept {
+				keys_.clear();
+				hashes_.clear();
+				std::fill(ctrl_.begin(), ctrl_.end(), ctrl_empty);
+				growth_left_ = growth_capacity(ctrl_.size());
+			}
+
+		protected:
+			/**
+			 * Gets the index of the entry with the given key, adding the key as a new last entry if it is not there yet.
+			 * @return the index, and whether the key was added
+			 */
+			std::pair<size_type, bool> insert_key(key_reference key) {
+				assert(key.size() * key.extents().stride() == keys_.extents().stride());
+				if (const size_type entry = find_index(key); entry != npos) return { entry, false };
+				if (growth_left_ == 0) {
+					// grow, or just clear out the deleted slots if at least half of the used slots are deleted
+					const size_type capacity = ctrl_.size();
+					rehash(size() + 1 > growth_capacity(capacity) / 2 ? capacity_for(size() + 1) : capacity);
+				}
+				const std::uint64_t hash = hash_key(key);
+				keys_.push_back(key);
+				hashes_.push_back(hash);
+				place(size() - 1, hash);
+				return { size() - 1, true };
+			}
+
+			/**
+			 * Removes the entry with the given index, and moves the last entry into its place.
+			 */
+			void erase_index(size_type entry) noexcept {
+				const size_type last = size() - 1;
+				ctrl_[slot_of(entry)] = ctrl_deleted;
+				if (entry != last) {
+					slots_[slot_of(last)] = entry;
+					keys_[entry] = keys_[last];
+					hashes_[entry] = hashes_[last];
+				}
+				keys_.pop_back();
+				hashes_.pop_back();
+			}
+
+		private:
+			static std::int8_t h2(std::uint64_t hash) noexcept { return static_cast<std::int8_t>(hash & 0x7F); }
+			std::uint64_t hash_key(key_reference key) const { return detail::hash_elements(key.data(), keys_.extents().stride()); }
+
+			/**
+			 * Gets the number of entries that a table with the given number of slots may hold (a maximum load factor of 7/8).
+			 */
+			static size_type growth_capacity(size_type capacity) noexcept { return capacity - capacity / 8; }
+			static size_type capacity_for(size_type count) noexcept {
+				size_type capacity = ctrl_group;
+				while (growth_capacity(capacity) < count) capacity *= 2;
+				return capacity;
+			}
+
+			/**
+			 * Puts an entry into the first free slot of its probe sequence.
+			 */
+			void place(size_type entry, std::uint64_t hash) noexcept {
+				const size_type groups = ctrl_.size() / ctrl_group;
+				size_type group = static_cast<size_type>(hash >> 7) & (groups - 1);
+				for (size_type step = 1;; ++step) {
+					if (const unsigned mask = match_ctrl_free(ctrl_.data() + group * ctrl_group); mask != 0) {
+						const size_type slot = group * ctrl_group + count_trailing_zeros(mask);
+						if (ctrl_[slot] == ctrl_empty) --growth_left_;
+						ctrl_[slot] = h2(hash);
+						slots_[slot] = entry;
+						return;
+					}
+					group = (group + step) & (groups - 1);
+				}
+			}
+			/**
+			 * Gets the slot that holds the given entry.
+			 */
+			size_type slot_of(size_type entry) const noexcept {
+				const std::uint64_t hash = hashes_[entry];
+				const size_type groups = ctrl_.size() / ctrl_group;
+				size_type group = static_cast<size_type>(hash >> 7) & (groups - 1);
+				for (size_type step = 1;; ++step) {
+					for (unsigned mask = match_ctrl(ctrl_.data() + group * ctrl_group, h2(hash)); mask != 0; mask &= mask - 1) {
+						const size_type slot = group * ctrl_group + count_trailing_zeros(mask);
+						if (slots_[slot] == entry) return slot;
+					}
+					group = (group + step) & (groups - 1);
+				}
+			}
+			void rehash(size_type capacity) {
+				ctrl_.assign(capacity, ctrl_empty);
+				slots_.resize(capacity);
+				growth_left_ = growth_capacity(capacity);
+				for (size_type entry = 0; entry != size(); ++entry) place(entry, hashes_[entry]);
+			}
+
+			multidim::vector<Inner> keys_;
+			std::vector<std::uint64_t> hashes_;
+			std::vector<std::int8_t> ctrl_;
+			std::vector<size_type> slots_;
+			size_type growth_left_ = 0; // the number of empty slots that may still be filled before rehashing
+		};
+	}
+
+	/**
+	 * A hash set of rows with the given inner container shape (e.g. inner_dynarray<int> or inner_array<std::uint8_t, 32>), for deduplicating rows.
+	 * All keys are stored contiguously in one multidim::vector<Inner>.  Iteration visits the keys in insertion order, except that erase() moves the last key into the place of the erased one.
+	 * Inserting invalidates references to keys (like push_back on a vector), and erasing invalidates references to the erased and the last key.
+	 */
+	template <typename Inner>
+	class row_hash_set : public detail::row_table<Inner> {
+	public:
+		using B = detail::row_table<Inner>;
+		using const_iterator = typename multidim::vector<Inner>::const_iterator;
+		using iterator = const_iterator;
+
+		/**
+		 * Constructs an empty set of rows with the given extents.
+		 */
+		explicit row_hash_set(const typename B::key_extents_type& extents) : B(extents) {}
+		/**
+		 * Constructs an empty set of rows with the given dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		explicit row_hash_set(TNs... ns) : B(typename B::key_extents_type(ns...)) {}
+
+		/**
+		 * Inserts a copy of the key if it is not present yet.  Returns an iterator to the key in the set, and whether it was inserted.
+		 */
+		std::pair<const_iterator, bool> insert(typename B::key_reference key) {
+			const auto [entry, inserted] = this->insert_key(key);
+			return { begin() + static_cast<std::ptrdiff_t>(entry), inserted };
+		}
+		/**
+		 * Removes the key if it is present.  Returns the number of keys removed (0 or 1).
+		 */
+		size_t erase(typename B::key_reference key) {
+			const size_t entry = this->find_index(key);
+			if (entry == B::npos) return 0;
+			this->erase_index(entry);
+			return 1;
+		}
+
+		const_iterator find(typename B::key_reference key) const {
+			const size_t entry = this->find_index(key);
+			return entry == B::npos ? end() : begin() + static_cast<std::ptrdiff_t>(entry);
+		}
+		bool contains(typename B::key_reference key) const { return this->find_index(key) != B::npos; }
+		size_t count(typename B::key_reference key) const { return contains(key) ? 1 : 0; }
+
+		const_iterator begin() const noexcept { return this->keys().begin(); }
+		const_iterator end() const noexcept { return this->keys().end(); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+	};
+
+	/**
+	 * A hash map from rows with the given inner container shape (e.g. inner_dynarray<int>) to values of type V.
+	 * All keys are stored contiguously in one multidim::vector<Inner>, and the values in one std::vector<V> in the same order, so there is no allocation per entry.
+	 * Iteration visits (key, value) pairs in insertion order, except that erase() moves the last entry into the place of the erased one.
+	 * Inserting invalidates references to keys and values (like push_back on a vector), and erasing invalidates references to the erased and the last entry.
+	 */
+	template <typename Inner, typename V>
+	class row_hash_map : public detail::row_table<Inner> {
+	public:
+		using B = detail::row_table<Inner>;
+		using mapped_type = V;
+
+		template <bool IsConst>
+		class iterator_impl {
+		public:
+			using map_type = std::conditional_t<IsConst, const row_hash_map, row_hash_map>;
+			using value_type = std::pair<typename B::key_reference, std::conditional_t<IsConst, const V&, V&>>;
+			using reference = value_type;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::forward_iterator_tag;
+
+			iterator_impl() noexcept = default;
+			iterator_impl(map_type* map, size_t index) noexcept : map_(map), index_(index) {}
+			template <bool C = IsConst, typename = std::enable_if_t<C>>
+			iterator_impl(const iterator_impl<false>& other) noexcept : map_(other.map_), index_(other.index_) {}
+
+			reference operator*() const { return { map_->keys()[index_], map_->values_[index_] }; }
+			iterator_impl& operator++() noexcept { ++index_; return *this; }
+			iterator_impl operator++(int) noexcept { iterator_impl tmp = *this; ++index_; return tmp; }
+			friend bool operator==(const iterator_impl& a, const iterator_impl& b) noexcept { return a.index_ == b.index_; }
+			friend bool operator!=(const iterator_impl& a, const iterator_impl& b) noexcept { return a.index_ != b.index_; }
+
+			/**
+			 * Gets the index of the entry in the map.
+			 */
+			size_t index() const noexcept { return index_; }
+
+		private:
+			friend class iterator_impl<!IsConst>;
+
+			map_type* map_ = nullptr;
+			size_t index_ = 0;
+		};
+		using iterator = iterator_impl<false>;
+		using const_iterator = iterator_impl<true>;
+
+		/**
+		 * Constructs an empty map with keys of the given extents.
+		 */
+		explicit row_hash_map(const typename B::key_extents_type& extents) : B(extents) {}
+		/**
+		 * Constructs an empty map with keys of the given dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		explicit row_hash_map(TNs... ns) : B(typename B::key_extents_type(ns...)) {}
+
+		/**
+		 * Inserts a copy of the key with a value constructed from args, if the key is not present yet.  Returns an iterator to the entry with the key, and whether it was inserted.
+		 */
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(typename B::key_reference key, Args&&... args) {
+			const auto [entry, inserted] = this->insert_key(key);
+			if (inserted) {
+				try {
+					values_.emplace_back(std::forward<Args>(args)...);
+				}
+				catch (...) {
+					// the new key is the last entry, so this just takes it out again and keeps keys and values in step
+					this->erase_index(entry);
+					throw;
+				}
+			}
+			return { iterator(this, entry), inserted };
+		}
+		/**
+		 * Gets the value for the key, inserting a value-initialized one if the key is not present yet.
+		 */
+		V& operator[](typename B::key_reference key) {
+			return values_[try_emplace(key).first.index()];
+		}
+		V& at(typename B::key_reference key) {
+			const size_t entry = this->find_index(key);
+			if (entry == B::npos) throw std::out_of_range("multidim: key not found in row_hash_map");
+			return values_[entry];
+		}
+		const V& at(typename B::key_reference key) const {
+			const size_t entry = this->find_index(key);
+			if (entry == B::npos) throw std::out_of_range("multidim: key not found in row_hash_map");
+			return values_[entry];
+		}
+
+		/**
+		 * Removes the entry with the key if it is present.  Returns the number of entries removed (0 or 1).
+		 */
+		size_t erase(typename B::key_reference key) {
+			const size_t entry = this->find_index(key);
+			if (entry == B::npos) return 0;
+			this->erase_index(entry);
+			if (entry != values_.size() - 1) values_[entry] = std::move(values_.back());
+			values_.pop_back();
+			return 1;
+		}
+
+		iterator find(typename B::key_reference key) {
+			const size_t entry = this->find_index(key);
+			return iterator(this, entry == B::npos ? this->size() : entry);
+		}
+		const_iterator find(typename B::key_reference key) const {
+			const size_t entry = this->find_index(key);
+			return const_iterator(this, entry == B::npos ? this->size() : entry);
+		}
+		bool contains(typename B::key_reference key) const { return this->find_index(key) != B::npos; }
+		size_t count(typename B::key_reference key) const { return contains(key) ? 1 : 0; }
+
+		void reserve(size_t count) {
+			B::reserve(count);
+			values_.reserve(count);
+		}
+		void clear() noexcept {
+			B::clear();
+			values_.clear();
+		}
+
+		/**
+		 * Gets the values, in the same order as keys().
+		 */
+		const std::vector<V>& values() const noexcept { return values_; }
+
+		iterator begin() noexcept { return iterator(this, 0); }
+		iterator end() noexcept { return iterator(this, this->size()); }
+		const_iterator begin() const noexcept { return const_iterator(this, 0); }
+		const_iterator end() const noexcept { return const_iterator(this, this->size()); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+
+	private:
+		std::vector<V> values_;
+	};
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility> // for std::move()
+
+#include "alg_heap.hpp"
+#include "compare.hpp" // for lex_less
+#include "core.hpp"
+#include "vector.hpp"
+
+namespace multidim {
+
+	/**
+	 * A priority queue of rows with the given inner container shape (e.g. inner_array<float, 16>), like std::priority_queue over a multidim::vector<Inner>.
+	 * top() is the greatest row according to Compare, which defaults to lexicographical order.
+	 * The rows are kept in an Arity-ary max-heap; a 4-ary or 8-ary heap is half or a third as deep as a binary heap, so push() and pop() touch fewer rows, which matters when rows are wide.
+	 * The rows are only ever swapped within the heap, never copied to temporaries.
+	 */
+	template <typename Inner, typename Compare = lex_less, size_t Arity = 2>
+	class row_priority_queue {
+		static_assert(Arity >= 2, "a heap must have at least two children per node");
+	public:
+		using container_type = multidim::vector<Inner>;
+		using value_compare = Compare;
+		using size_type = typename container_type::size_type;
+		using const_reference = typename container_type::const_reference;
+		using element_extents_type = typename container_type::element_extents_type;
+
+		/**
+		 * Constructs an empty queue of rows with the given extents.
+		 */
+		explicit row_priority_queue(const element_extents_type& extents, const Compare& comp = Compare()) : c_(extents), comp_(comp) {}
+		/**
+		 * Constructs an empty queue of rows with the given dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		explicit row_priority_queue(TNs... ns) : c_(ns...) {}
+		/**
+		 * Constructs an empty queue of rows whose extents are fixed (e.g. of inner_array), with the given comparator.
+		 */
+		template <typename E = element_extents_type, typename = std::enable_if_t<std::is_default_constructible_v<E>>>
+		explicit row_priority_queue(const Compare& comp) : c_(element_extents_type()), comp_(comp) {}
+		/**
+		 * Constructs a queue that takes the rows of an existing vector, and arranges them into a heap in O(N).
+		 */
+		explicit row_priority_queue(container_type&& c, const Compare& comp = Compare()) : c_(std::move(c)), comp_(comp) {
+			detail::make_heap_d<Arity>(c_.begin(), c_.end(), comp_);
+		}
+
+		const_reference top() const noexcept { return c_.front(); }
+		size_type size() const noexcept { return c_.size(); }
+		[[nodiscard]] bool empty() const noexcept { return c_.empty(); }
+		void reserve(size_type new_cap) { c_.reserve(new_cap); }
+		void clear() noexcept { c_.clear(); }
+		/**
+		 * Gets the rows, in heap order.
+		 */
+		const container_type& container() const noexcept { return c_; }
+		const Compare& comp() const noexcept { return comp_; }
+
+		/**
+		 * Adds a copy of the row.  This is safe even if `row` is a reference to a row of this queue.
+		 */
+		void push(const_reference row) {
+			c_.push_back(row);
+			detail::sift_up_d<Arity>(c_.begin(), static_cast<typename container_type::difference_type>(c_.size() - 1), comp_);
+		}
+		/**
+		 * Removes the top row.  The queue must not be empty.
+		 */
+		void pop() {
+			multidim::iter_swap(c_.begin(), c_.end() - 1);
+			c_.pop_back();
+			detail::sift_down_d<Arity>(c_.begin(), static_cast<typename container_type::difference_type>(c_.size()), 0, comp_);
+		}
+		/**
+		 * Overwrites the top row with a copy of the row, and restores the heap; this is cheaper than pop() followed by push().  The queue must not be empty.
+		 */
+		void replace_top(const_reference row) {
+			c_.front() = row;
+			detail::sift_down_d<Arity>(c_.begin(), static_cast<typename container_type::difference_type>(c_.size()), 0, comp_);
+		}
+		/**
+		 * Keeps the max_size least rows (according to Compare) seen so far: pushes the row if there are fewer than max_size rows, and otherwise replaces the top row if the row is less than it.
+		 * Pushing every row of a table into a queue this way leaves its max_size least rows in the queue, in O(N log max_size).
+		 * @return whether the row was added
+		 */
+		bool push_bounded(const_reference row, size_type max_size) {
+			if (c_.size() < max_size) {
+				push(row);
+				return true;
+			}
+			if (max_size == 0 || !comp_(row, c_.front())) return false;
+			replace_top(row);
+			return true;
+		}
+
+		/**
+		 * Takes the rows out of the queue, leaving it empty.
+		 */
+		container_type release() && noexcept {
+			container_type ret(std::move(c_));
+			c_.clear();
+			return ret;
+		}
+
+	private:
+		container_type c_;
+		Compare comp_;
+	};
+}
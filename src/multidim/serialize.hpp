@@ -0,0 +1,406 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memcpy()
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#if __has_include(<unistd.h>)
+#include <cerrno>
+#include <system_error>
+#include <unistd.h>
+#define MULTIDIM_SERIALIZE_HAS_FD 1
+#endif
+
+#include "array.hpp"
+#include "dynarray.hpp"
+#include "vector.hpp"
+#include "codec.hpp" // for binary_codec and format_error
+#include "core.hpp"
+
+/**
+ * A self-describing binary format for multidim containers.
+ *
+ * Layout (all integers are in the byte order named by the header):
+ *   binary_header (40 bytes)
+ *   binary_extent_entry[rank] (16 bytes each), outermost dimension first
+ *   zero padding up to header_size, which is a multiple of binary_alignment
+ *   payload: the base elements (payload_size bytes), either raw (i.e. exactly what data() points to) or as an encoded block of codec.hpp
+ *   zero padding up to a multiple of binary_alignment
+ *
+ * Since the payload is aligned, a file that is mapped into memory can be viewed with view() without copying.
+ */
+
+namespace multidim {
+
+	constexpr inline char binary_magic[8] = { 'M', 'D', 'I', 'M', 'B', 'I', 'N', '\0' };
+	constexpr inline std::uint16_t binary_version = 1;
+	/**
+	 * The alignment of the payload (and the granularity of all padding) in the binary format.
+	 */
+	constexpr inline size_t binary_alignment = 64;
+
+	enum class binary_endianness : std::uint8_t {
+		little = 1,
+		big = 2
+	};
+
+	struct binary_header {
+		char magic[8];
+		std::uint16_t version;
+		binary_endianness endianness;
+		char type_kind; // 'b' for bool, 'i' for signed integers, 'u' for unsigned integers, 'f' for floating point, 'V' for anything else
+		std::uint32_t element_size;
+		std::uint32_t element_alignment;
+		std::uint8_t rank;
+		binary_codec codec;
+		std::uint16_t reserved;
+		std::uint64_t header_size; // offset of the payload from the start of the header
+		std::uint64_t payload_size; // size of the (encoded) payload in bytes, excluding padding
+	};
+	static_assert(sizeof(binary_header) == 40 && std::is_trivially_copyable_v<binary_header>, "binary_header must have no padding");
+
+	struct binary_extent_entry {
+		std::uint8_t kind; // 0 for static_extent, 1 for dynamic_extent
+		std::uint8_t reserved[7];
+		std::uint64_t size;
+	};
+	static_assert(sizeof(binary_extent_entry) == 16 && std::is_trivially_copyable_v<binary_extent_entry>, "binary_extent_entry must have no padding");
+
+	namespace detail {
+		constexpr inline binary_endianness native_endianness() noexcept {
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			return binary_endianness::big;
+#else
+			return binary_endianness::little;
+#endif
+		}
+
+		template <typename T>
+		constexpr inline char type_kind() noexcept {
+			if constexpr (std::is_same_v<T, bool>) return 'b';
+			else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) return 'i';
+			else if constexpr (std::is_integral_v<T>) return 'u';
+			else if constexpr (std::is_floating_point_v<T>) return 'f';
+			else return 'V';
+		}
+
+		constexpr inline size_t pad_to_alignment(size_t sz) noexcept {
+			return (sz + binary_alignment - 1) / binary_alignment * binary_alignment;
+		}
+
+		/**
+		 * Gets the number of dimensions represented by an extent chain.
+		 */
+		template <typename E>
+		struct extent_rank : std::integral_constant<size_t, 0> {};
+		template <typename E, size_t N>
+		struct extent_rank<static_extent<E, N>> : std::integral_constant<size_t, 1 + extent_rank<E>::value> {};
+		template <typename E>
+		struct extent_rank<dynamic_extent<E>> : std::integral_constant<size_t, 1 + extent_rank<E>::value> {};
+
+		/**
+		 * Converts between an extent chain and its serialized entries (outermost dimension first).
+		 */
+		template <typename E>
+		struct extent_codec;
+		template <>
+		struct extent_codec<unit_extent> {
+			static void encode(const unit_extent&, binary_extent_entry*) noexcept {}
+			static unit_extent decode(const binary_extent_entry*) noexcept { return unit_extent{}; }
+		};
+		template <typename E, size_t N>
+		struct extent_codec<static_extent<E, N>> {
+			static void encode(const static_extent<E, N>& e, binary_extent_entry* out) noexcept {
+				*out = binary_extent_entry{ 0, {}, N };
+				extent_codec<E>::encode(e.inner(), out + 1);
+			}
+			static static_extent<E, N> decode(const binary_extent_entry* in) {
+				if (in->kind != 0 || in->size != N) throw format_error("multidim: compile-time extent does not match");
+				return static_extent<E, N>(extent_codec<E>::decode(in + 1));
+			}
+		};
+		template <typename E>
+		struct extent_codec<dynamic_extent<E>> {
+			static void encode(const dynamic_extent<E>& e, binary_extent_entry* out) noexcept {
+				*out = binary_extent_entry{ 1, {}, e.top_extent() };
+				extent_codec<E>::encode(e.inner(), out + 1);
+			}
+			static dynamic_extent<E> decode(const binary_extent_entry* in) {
+				if (in->kind != 1) throw format_error("multidim: expected a dynamic extent");
+				if (in->size > std::numeric_limits<size_t>::max()) throw format_error("multidim: extent too large");
+				return dynamic_extent<E>(static_cast<size_t>(in->size), extent_codec<E>::decode(in + 1));
+			}
+		};
+
+		/**
+		 * Gets the extents of the whole container (including the outermost dimension).
+		 */
+		template <typename X>
+		inline typename X::container_extents_type container_extents_of(const X& x) noexcept {
+			if constexpr (X::container_extents_type::is_dynamic) {
+				return typename X::container_extents_type(x.size(), x.extents());
+			}
+			else {
+				return typename X::container_extents_type(x.extents());
+			}
+		}
+
+		template <typename X>
+		inline binary_header make_header(size_t payload_size) noexcept {
+			using base_element = typename X::base_element;
+			using extents_type = typename X::container_extents_type;
+			binary_header header{};
+			std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+			header.version = binary_version;
+			header.endianness = native_endianness();
+			header.type_kind = type_kind<base_element>();
+			header.element_size = sizeof(base_element);
+			header.element_alignment = alignof(base_element);
+			header.rank = static_cast<std::uint8_t>(extent_rank<extents_type>::value);
+			header.codec = binary_codec::raw;
+			header.header_size = pad_to_alignment(sizeof(binary_header) + extent_rank<extents_type>::value * sizeof(binary_extent_entry));
+			header.payload_size = payload_size;
+			return header;
+		}
+
+		/**
+		 * Checks that the header matches the container type X.  Throws format_error if it does not.
+		 */
+		template <typename X>
+		inline void check_header(const binary_header& header) {
+			using base_element = typename X::base_element;
+			using extents_type = typename X::container_extents_type;
+			if (std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0) throw format_error("multidim: not a multidim binary file");
+			if (header.version != binary_version) throw format_error("multidim: unsupported binary format version");
+			if (header.endianness != native_endianness()) throw format_error("multidim: byte order does not match");
+			if (header.type_kind != type_kind<base_element>() || header.element_size != sizeof(base_element)) throw format_error("multidim: base element type does not match");
+			if (header.element_alignment != alignof(base_element)) throw format_error("multidim: base element alignment does not match");
+			if (header.rank != extent_rank<extents_type>::value) throw format_error("multidim: number of dimensions does not match");
+			if (header.header_size < sizeof(binary_header) + header.rank * sizeof(binary_extent_entry) || header.header_size % binary_alignment != 0) throw format_error("multidim: invalid header size");
+		}
+
+		/**
+		 * Decodes the extents from the entries, and checks that they agree with the payload size.
+		 */
+		template <typename X>
+		inline typename X::container_extents_type decode_extents(const binary_header& header, const binary_extent_entry* entries) {
+			using extents_type = typename X::container_extents_type;
+			const extents_type extents = extent_codec<extents_type>::decode(entries);
+			if (header.codec == binary_codec::raw && header.payload_size != extents.stride() * sizeof(typename X::base_element)) throw format_error("multidim: payload size does not match the extents");
+			return extents;
+		}
+
+		/**
+		 * Constructs a container of type X with the given extents.  The base elements are value-initialized.
+		 */
+		template <typename X>
+		inline X make_container(const typename X::container_extents_type& extents) {
+			if constexpr (!X::container_extents_type::is_dynamic) {
+				return X(extents.inner());
+			}
+			else if constexpr (std::is_constructible_v<X, size_t, const typename X::element_extents_type&>) {
+				return X(extents.top_extent(), extents.inner());
+			}
+			else {
+				X ret(extents.inner());
+				ret.resize(extents.top_extent());
+				return ret;
+			}
+		}
+
+		template <typename X>
+		inline void check_serializable() noexcept {
+			static_assert(std::is_trivially_copyable_v<typename X::base_element>, "only containers of trivially copyable base elements can be serialized");
+			static_assert(extent_rank<typename X::container_extents_type>::value <= std::numeric_limits<std::uint8_t>::max(), "too many dimensions");
+		}
+
+#ifdef MULTIDIM_SERIALIZE_HAS_FD
+		inline void write_all(int fd, const void* buf, size_t sz) {
+			const char* ptr = static_cast<const char*>(buf);
+			while (sz != 0) {
+				const ssize_t res = ::write(fd, ptr, sz);
+				if (res < 0) {
+					if (errno == EINTR) continue;
+					throw std::system_error(errno, std::generic_category(), "multidim: write() failed");
+				}
+				ptr += res;
+				sz -= static_cast<size_t>(res);
+			}
+		}
+		inline void read_all(int fd, void* buf, size_t sz) {
+			char* ptr = static_cast<char*>(buf);
+			while (sz != 0) {
+				const ssize_t res = ::read(fd, ptr, sz);
+				if (res < 0) {
+					if (errno == EINTR) continue;
+					throw std::system_error(errno, std::generic_category(), "multidim: read() failed");
+				}
+				if (res == 0) throw format_error("multidim: unexpected end of file");
+				ptr += res;
+				sz -= static_cast<size_t>(res);
+			}
+		}
+#endif
+
+		/**
+		 * Writes the container with the given byte sink, which is called as write(const void*, size_t).
+		 */
+		template <typename X, typename Write>
+		inline void save_with(const X& x, binary_codec codec, Write&& write) {
+			check_serializable<X>();
+			using extents_type = typename X::container_extents_type;
+			const extents_type extents = container_extents_of(x);
+			std::vector<unsigned char> encoded;
+			if (codec != binary_codec::raw) multidim::encode(codec, x.data(), extents.stride(), encoded);
+			const size_t payload_size = codec == binary_codec::raw ? extents.stride() * sizeof(typename X::base_element) : encoded.size();
+			binary_header header = make_header<X>(payload_size);
+			header.codec = codec;
+			binary_extent_entry entries[extent_rank<extents_type>::value + 1]{}; // +1 so that rank 0 is not a zero-sized array
+			extent_codec<extents_type>::encode(extents, entries);
+			static constexpr char zeros[binary_alignment] = {};
+			write(&header, sizeof(header));
+			write(entries, extent_rank<extents_type>::value * sizeof(binary_extent_entry));
+			write(zeros, header.header_size - sizeof(header) - extent_rank<extents_type>::value * sizeof(binary_extent_entry));
+			if (codec == binary_codec::raw) write(x.data(), payload_size);
+			else write(encoded.data(), payload_size);
+			write(zeros, pad_to_alignment(payload_size) - payload_size);
+		}
+
+		/**
+		 * Reads a container with the given byte source, which is called as read(void*, size_t) and must read exactly that many bytes.
+		 */
+		template <typename X, typename Read>
+		inline X load_with(Read&& read) {
+			check_serializable<X>();
+			using extents_type = typename X::container_extents_type;
+			binary_header header;
+			read(&header, sizeof(header));
+			check_header<X>(header);
+			binary_extent_entry entries[extent_rank<extents_type>::value + 1];
+			read(entries, extent_rank<extents_type>::value * sizeof(binary_extent_entry));
+			for (size_t skip = header.header_size - sizeof(header) - extent_rank<extents_type>::value * sizeof(binary_extent_entry); skip != 0;) {
+				char buf[binary_alignment];
+				const size_t amt = skip < sizeof(buf) ? skip : sizeof(buf);
+				read(buf, amt);
+				skip -= amt;
+			}
+			const extents_type extents = decode_extents<X>(header, entries);
+			X ret = make_container<X>(extents);
+			if (header.codec == binary_codec::raw) {
+				read(ret.data(), static_cast<size_t>(header.payload_size));
+			}
+			else {
+				if (!codec_supports<typename X::base_element>(header.codec)) throw format_error("multidim: unsupported codec");
+				std::vector<unsigned char> encoded(static_cast<size_t>(header.payload_size));
+				read(encoded.data(), encoded.size());
+				multidim::decode(encoded.data(), encoded.size(), ret.data(), extents.stride());
+			}
+			char buf[binary_alignment];
+			read(buf, pad_to_alignment(static_cast<size_t>(header.payload_size)) - static_cast<size_t>(header.payload_size));
+			return ret;
+		}
+	}
+
+	/**
+	 * Gets the type of the read-only view that view<X>() returns.
+	 * Specialize this for other containers that should be viewable.
+	 */
+	template <typename X>
+	struct const_view;
+	template <typename T, typename BufferKind>
+	struct const_view<dynarray<T, BufferKind>> { using type = dynarray_const_ref<T>; };
+	template <typename T>
+	struct const_view<dynarray_ref<T>> { using type = dynarray_const_ref<T>; };
+	template <typename T>
+	struct const_view<dynarray_const_ref<T>> { using type = dynarray_const_ref<T>; };
+	template <typename T, typename Growth, typename BufferKind>
+	struct const_view<vector<T, Growth, BufferKind>> { using type = dynarray_const_ref<T>; };
+	template <typename T, size_t N>
+	struct const_view<array<T, N>> { using type = array_const_ref<T, N>; };
+	template <typename T, size_t N>
+	struct const_view<array_ref<T, N>> { using type = array_const_ref<T, N>; };
+	template <typename T, size_t N>
+	struct const_view<array_const_ref<T, N>> { using type = array_const_ref<T, N>; };
+	template <typename X>
+	using const_view_t = typename const_view<X>::type;
+
+	/**
+	 * Gets the number of bytes that save() will write for the given container, without a codec.
+	 */
+	template <typename X>
+	inline size_t serialized_size(const X& x) noexcept {
+		using extents_type = typename X::container_extents_type;
+		return detail::pad_to_alignment(sizeof(binary_header) + detail::extent_rank<extents_type>::value * sizeof(binary_extent_entry))
+			+ detail::pad_to_alignment(detail::container_extents_of(x).stride() * sizeof(typename X::base_element));
+	}
+
+	/**
+	 * Writes a container (array, dynarray, vector, or a reference to one of them) to a stream.  The stream should be opened in binary mode.
+	 * If a codec is given, the payload is encoded with it (see codec.hpp); such a file can still be loaded, but not viewed.
+	 * Throws std::ios_base::failure if writing fails, or std::invalid_argument if the codec does not support the base element type.
+	 */
+	template <typename X>
+	inline void save(std::ostream& os, const X& x, binary_codec codec = binary_codec::raw) {
+		detail::save_with(x, codec, [&os](const void* buf, size_t sz) {
+			if (!os.write(static_cast<const char*>(buf), static_cast<std::streamsize>(sz))) throw std::ios_base::failure("multidim: stream write failed");
+		});
+	}
+
+	/**
+	 * Reads a container of type X (array, dynarray or vector) from a stream.  The stream should be opened in binary mode.
+	 * Throws format_error if the stream does not contain a container of type X.
+	 */
+	template <typename X>
+	inline X load(std::istream& is) {
+		return detail::load_with<X>([&is](void* buf, size_t sz) {
+			if (!is.read(static_cast<char*>(buf), static_cast<std::streamsize>(sz))) throw format_error("multidim: unexpected end of stream");
+		});
+	}
+
+#ifdef MULTIDIM_SERIALIZE_HAS_FD
+	/**
+	 * Writes a container to a file descriptor, starting at its current offset.
+	 */
+	template <typename X>
+	inline void save(int fd, const X& x, binary_codec codec = binary_codec::raw) {
+		detail::save_with(x, codec, [fd](const void* buf, size_t sz) { detail::write_all(fd, buf, sz); });
+	}
+
+	/**
+	 * Reads a container of type X from a file descriptor, starting at its current offset.
+	 */
+	template <typename X>
+	inline X load(int fd) {
+		return detail::load_with<X>([fd](void* buf, size_t sz) { detail::read_all(fd, buf, sz); });
+	}
+#endif
+
+	/**
+	 * Gets a read-only view of a container of type X that was serialized at the given address (e.g. a memory-mapped file), without copying the payload.
+	 * The address must be aligned to at least alignof(X::base_element), and the memory must stay alive for as long as the view is used.
+	 * If size is given, throws format_error if the serialized container does not fit in size bytes.
+	 */
+	template <typename X>
+	inline const_view_t<X> view(const void* mapped, size_t size = std::numeric_limits<size_t>::max()) {
+		detail::check_serializable<X>();
+		using extents_type = typename X::container_extents_type;
+		using base_element = typename X::base_element;
+		if (size < sizeof(binary_header)) throw format_error("multidim: unexpected end of buffer");
+		binary_header header;
+		std::memcpy(&header, mapped, sizeof(header));
+		detail::check_header<X>(header);
+		if (header.codec != binary_codec::raw) throw format_error("multidim: only raw payloads can be viewed");
+		if (header.header_size > size || header.payload_size > size - header.header_size) throw format_error("multidim: unexpected end of buffer");
+		binary_extent_entry entries[detail::extent_rank<extents_type>::value + 1];
+		std::memcpy(entries, static_cast<const char*>(mapped) + sizeof(header), detail::extent_rank<extents_type>::value * sizeof(binary_extent_entry));
+		const extents_type extents = detail::decode_extents<X>(header, entries);
+		const void* const payload = static_cast<const char*>(mapped) + header.header_size;
+		if (reinterpret_cast<std::uintptr_t>(payload) % alignof(base_element) != 0) throw format_error("multidim: payload is misaligned");
+		return const_view_t<X>(static_cast<const base_element*>(payload), extents);
+	}
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stdexcept> // for std::out_of_range and std::length_error
+#include <type_traits>
+
+#include "dynarray.hpp"
+#include "shared_memory.hpp"
+#include "core.hpp"
+#include "iterator.hpp"
+
+namespace multidim {
+
+	/**
+	 * Represents a multidimensional array whose base elements live in a named POSIX shared-memory segment, so that other processes can attach to it with shared_view (or with another shared_dynarray, to write to it) instead of holding their own copy.
+	 * The size is fixed when the segment is created.  Base elements must be trivially copyable, and are never constructed or destroyed.
+	 * Writes are not synchronized; processes that write concurrently with readers must coordinate by other means.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 */
+	template <typename T>
+	class shared_dynarray {
+	public:
+		using value_type = typename element_traits<T>::value_type;
+		using reference = typename element_traits<T>::reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using pointer = typename element_traits<T>::pointer;
+		using const_pointer = typename element_traits<T>::const_pointer;
+		using iterator = iterator_impl<T, false>;
+		using const_iterator = iterator_impl<T, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		static_assert(std::is_trivially_copyable_v<base_element>, "shared memory requires trivially copyable base elements");
+
+		/**
+		 * Maps an existing segment, given the element_extents_type (inner dimensions).
+		 * Throws std::invalid_argument if the segment holds a different base element type or has different extents.
+		 */
+		shared_dynarray(const char* name, map_mode mode, const element_extents_type& extents) : segment_(name, mode), size_(0), extents_(extents) {
+			const detail::shared_header* const header = detail::check_shared_header<base_element>(segment_.data(), segment_.size(), extents_.stride());
+			size_ = static_cast<size_type>(header->size.load(std::memory_order_acquire));
+			if (detail::shared_segment_bytes<base_element>(size_, extents_.stride()) > segment_.size()) throw std::length_error("multidim: shared memory segment is smaller than its size");
+		}
+		/**
+		 * Maps an existing segment, given the inner dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		shared_dynarray(const char* name, map_mode mode, TNs... ns) : shared_dynarray(name, mode, element_extents_type(ns...)) {}
+		/**
+		 * Creates (or truncates) a segment that holds an array with the given size and element_extents_type (inner dimensions).  The new elements are zero.
+		 */
+		static shared_dynarray create(const char* name, size_type size, const element_extents_type& extents) {
+			shared_segment segment = shared_segment::create(name, detail::shared_segment_bytes<base_element>(size, extents.stride()));
+			detail::init_shared_header<base_element>(segment.data(), extents.stride(), size);
+			return shared_dynarray(std::move(segment), size, extents);
+		}
+		/**
+		 * Creates (or truncates) a segment that holds an array of the given dimensions.  The new elements are zero.
+		 */
+		template <typename TN, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TN>, std::is_convertible<size_t, TNs>...>>>
+		static shared_dynarray create(const char* name, TN n, TNs... ns) {
+			return create(name, n, element_extents_type(ns...));
+		}
+		shared_dynarray(const shared_dynarray&) = delete;
+		shared_dynarray(shared_dynarray&&) noexcept = default;
+		shared_dynarray& operator=(const shared_dynarray&) = delete;
+		shared_dynarray& operator=(shared_dynarray&&) noexcept = default;
+
+		friend void swap(shared_dynarray& a, shared_dynarray& b) noexcept {
+			using std::swap;
+			swap(a.segment_, b.segment_);
+			swap(a.size_, b.size_);
+			swap(a.extents_, b.extents_);
+		}
+
+		/**
+		 * Converting operator to dynarray_ref.
+		 */
+		operator dynarray_ref<T>() noexcept {
+			return dynarray_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+		/**
+		 * Converting operator to dynarray_const_ref.
+		 */
+		operator dynarray_const_ref<T>() const noexcept {
+			return dynarray_const_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+
+		/**
+		 * Gets a pointer to the underlying base elements.
+		 */
+		base_element* data() noexcept { return reinterpret_cast<base_element*>(static_cast<char*>(segment_.data()) + sizeof(detail::shared_header)); }
+		const base_element* data() const noexcept { return reinterpret_cast<const base_element*>(static_cast<const char*>(segment_.data()) + sizeof(detail::shared_header)); }
+
+		reference operator[](size_type index) noexcept { return static_cast<dynarray_ref<T>>(*this)[index]; }
+		const_reference operator[](size_type index) const noexcept { return static_cast<dynarray_const_ref<T>>(*this)[index]; }
+		reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+
+		size_type size() const noexcept { return size_; }
+		size_type max_size() const noexcept { return size_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+		const_iterator cbegin() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).begin(); }
+		const_iterator cend() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).end(); }
+		const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+		const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+		const_iterator begin() const noexcept { return cbegin(); }
+		iterator begin() noexcept { return static_cast<dynarray_ref<T>>(*this).begin(); }
+		const_iterator end() const noexcept { return cend(); }
+		iterator end() noexcept { return static_cast<dynarray_ref<T>>(*this).end(); }
+		const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(end()); }
+		reverse_iterator rbegin() noexcept { return std::make_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(begin()); }
+		reverse_iterator rend() noexcept { return std::make_reverse_iterator(begin()); }
+
+		reference front() noexcept { return operator[](0); }
+		const_reference front() const noexcept { return operator[](0); }
+		reference back() noexcept { return operator[](size_ - 1); }
+		const_reference back() const noexcept { return operator[](size_ - 1); }
+
+		/**
+		 * Gets the extents of elements that are stored in this array.
+		 */
+		const element_extents_type& extents() const noexcept { return extents_; }
+		map_mode mode() const noexcept { return segment_.mode(); }
+
+		friend bool operator==(const shared_dynarray& a, const dynarray_const_ref<T>& b) {
+			return static_cast<dynarray_const_ref<T>>(a) == b;
+		}
+		friend bool operator!=(const shared_dynarray& a, const dynarray_const_ref<T>& b) { return !(a == b); };
+
+	private:
+		shared_dynarray(shared_segment&& segment, size_type size, const element_extents_type& extents) noexcept : segment_(std::move(segment)), size_(size), extents_(extents) {}
+
+		shared_segment segment_;
+		size_t size_; // the size of the current dimension
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+}
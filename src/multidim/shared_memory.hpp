@@ -0,0 +1,272 @@
+#pragma once
+
+#if !(__has_include(<sys/mman.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>))
+#error "multidim/shared_memory.hpp requires POSIX shared memory"
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for std::memcpy() and std::memcmp()
+#include <new> // for placement new
+#include <stdexcept> // for std::out_of_range, std::invalid_argument and std::length_error
+#include <system_error>
+#include <type_traits>
+#include <utility> // for std::move()
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "dynarray.hpp"
+#include "mapped_buffer.hpp"
+#include "core.hpp"
+#include "iterator.hpp"
+
+/**
+ * Containers in named POSIX shared-memory segments (see shm_open()), so that several processes can use the same elements without each holding a private copy.
+ * One process creates a shared_dynarray or shared_vector, and other processes attach to it with shared_view, which exposes the elements as a dynarray_const_ref.
+ *
+ * Layout of a segment:
+ *   detail::shared_header (64 bytes), which records the element type, the stride, the size, and a generation counter
+ *   the base elements
+ * The header is followed directly by the elements, so segments are not portable between machines; they only need to be understood by processes on the same host.
+ */
+
+namespace multidim {
+
+	namespace detail {
+		constexpr inline char shared_magic[8] = { 'M', 'D', 'I', 'M', 'S', 'H', 'M', '\0' };
+
+		struct shared_header {
+			char magic[8];
+			std::uint32_t element_size;
+			std::uint32_t element_alignment;
+			std::uint64_t stride; // base elements per element of the outermost dimension
+			std::atomic<std::uint64_t> generation; // incremented (with release semantics) whenever the segment is resized or the container shrinks
+			std::atomic<std::uint64_t> size; // the size of the outermost dimension; stored (with release semantics) after the elements are written
+			char reserved[24];
+		};
+		static_assert(sizeof(shared_header) == 64, "shared_header must be exactly one cache line");
+		static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared memory requires address-free 64-bit atomics");
+
+		/**
+		 * Gets the number of bytes of a segment that holds capacity elements with the given stride.
+		 */
+		template <typename Base>
+		constexpr inline size_t shared_segment_bytes(size_t capacity, size_t stride) noexcept {
+			return sizeof(shared_header) + capacity * stride * sizeof(Base);
+		}
+
+		template <typename Base>
+		inline shared_header* init_shared_header(void* segment, size_t stride, size_t size) noexcept {
+			shared_header* const header = ::new (segment) shared_header{};
+			std::memcpy(header->magic, shared_magic, sizeof(shared_magic));
+			header->element_size = sizeof(Base);
+			header->element_alignment = alignof(Base);
+			header->stride = stride;
+			header->generation.store(0, std::memory_order_relaxed);
+			header->size.store(size, std::memory_order_release);
+			return header;
+		}
+
+		/**
+		 * Checks that a segment was created for elements of the given base element type and stride.  Throws std::invalid_argument if it was not.
+		 */
+		template <typename Base>
+		inline const shared_header* check_shared_header(const void* segment, size_t segment_size, size_t stride) {
+			const shared_header* const header = static_cast<const shared_header*>(segment);
+			if (segment_size < sizeof(shared_header) || std::memcmp(header->magic, shared_magic, sizeof(shared_magic)) != 0) throw std::invalid_argument("multidim: not a multidim shared memory segment");
+			if (header->element_size != sizeof(Base) || header->element_alignment != alignof(Base)) throw std::invalid_argument("multidim: shared memory segment has a different base element type");
+			if (header->stride != stride) throw std::invalid_argument("multidim: shared memory segment has different extents");
+			return header;
+		}
+	}
+
+	/**
+	 * Class that owns a mapping of a named POSIX shared-memory segment, like mapped_file but for shm_open() names (e.g. "/embeddings").
+	 * Destroying a shared_segment unmaps it but does not remove the name; call shared_segment::remove() when no new process should attach any more.
+	 */
+	class shared_segment {
+	public:
+		shared_segment() = default;
+		/**
+		 * Maps the whole of an existing segment.
+		 */
+		shared_segment(const char* name, map_mode mode) : file_(open_segment(name, mode == map_mode::read_write ? O_RDWR : O_RDONLY), mode) {}
+		/**
+		 * Creates (or truncates) a segment with the given size and maps it with map_mode::read_write.  The new contents of the segment are zero.
+		 */
+		static shared_segment create(const char* name, size_t size) {
+			shared_segment ret(mapped_file(open_segment(name, O_RDWR | O_CREAT | O_TRUNC), map_mode::read_write));
+			ret.resize(size);
+			return ret;
+		}
+		/**
+		 * Removes the name of a segment.  Processes that have mapped it keep their mappings.  Does nothing if there is no such segment.
+		 */
+		static void remove(const char* name) {
+			if (::shm_unlink(name) != 0 && errno != ENOENT) {
+				throw std::system_error(errno, std::generic_category(), "multidim: shm_unlink() failed");
+			}
+		}
+
+		void* data() noexcept { return file_.data(); }
+		const void* data() const noexcept { return file_.data(); }
+		size_t size() const noexcept { return file_.size(); }
+		map_mode mode() const noexcept { return file_.mode(); }
+
+		/**
+		 * Changes the size of the segment.  Only allowed for map_mode::read_write.  The mapping may move.
+		 */
+		void resize(size_t new_size) { file_.resize(new_size); }
+		/**
+		 * Maps the segment again, at its current size (e.g. after another process has resized it).  The mapping may move.
+		 */
+		void remap() {
+			const int fd = ::dup(file_.native_handle());
+			if (fd == -1) throw std::system_error(errno, std::generic_category(), "multidim: dup() failed");
+			file_ = mapped_file(fd, file_.mode());
+		}
+
+	private:
+		explicit shared_segment(mapped_file&& file) noexcept : file_(std::move(file)) {}
+		static int open_segment(const char* name, int flags) {
+			const int fd = ::shm_open(name, flags | O_CLOEXEC, 0666);
+			if (fd == -1) throw std::system_error(errno, std::generic_category(), "multidim: shm_open() failed");
+			return fd;
+		}
+
+		mapped_file file_;
+	};
+
+	/**
+	 * A read-only view of a shared_dynarray or shared_vector that was created by (usually) another process.
+	 * The view sees the elements that existed when it was constructed or last refreshed.  refresh() picks up elements that were appended since then, and maps the segment again if the writer has grown it (which it announces by incrementing the generation counter in the header).
+	 * If the writer is a shared_vector that may shrink, elements that a reader reads might be overwritten while it reads them; call consistent() after reading them, and refresh() and read them again if it returns false.
+	 * Note: refresh() invalidates all references, iterators and dynarray_const_refs obtained from this view.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 */
+	template <typename T>
+	class shared_view {
+	public:
+		using value_type = typename element_traits<T>::value_type;
+		using reference = typename element_traits<T>::const_reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using const_iterator = iterator_impl<T, true>;
+		using iterator = const_iterator;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using reverse_iterator = const_reverse_iterator;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		static_assert(std::is_trivially_copyable_v<base_element>, "shared memory requires trivially copyable base elements");
+
+		/**
+		 * Attaches to the segment with the given name, given the element_extents_type (inner dimensions).
+		 * Throws std::invalid_argument if the segment holds a different base element type or has different extents.
+		 */
+		shared_view(const char* name, const element_extents_type& extents) : segment_(name, map_mode::read_only), size_(0), generation_(0), extents_(extents) {
+			detail::check_shared_header<base_element>(segment_.data(), segment_.size(), extents_.stride());
+			generation_ = header().generation.load(std::memory_order_acquire);
+			refresh();
+		}
+		/**
+		 * Attaches to the segment with the given name, given the inner dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		shared_view(const char* name, TNs... ns) : shared_view(name, element_extents_type(ns...)) {}
+
+		/**
+		 * Picks up the current size of the container, mapping the segment again if it has been resized.  Returns true if anything changed.
+		 */
+		bool refresh() {
+			// load the size first: the writer resizes the segment before it publishes a size that needs the extra space
+			const size_type size = static_cast<size_type>(header().size.load(std::memory_order_acquire));
+			const std::uint64_t generation = header().generation.load(std::memory_order_acquire);
+			const bool remapped = generation != generation_ || detail::shared_segment_bytes<base_element>(size, extents_.stride()) > segment_.size();
+			if (remapped) {
+				segment_.remap();
+				generation_ = generation;
+				if (detail::shared_segment_bytes<base_element>(size, extents_.stride()) > segment_.size()) throw std::length_error("multidim: shared memory segment is smaller than its size");
+			}
+			const bool changed = remapped || size != size_;
+			size_ = size;
+			return changed;
+		}
+		/**
+		 * Gets the generation of the segment that is currently mapped.
+		 */
+		std::uint64_t generation() const noexcept { return generation_; }
+		/**
+		 * Checks that the writer has not resized the segment or shrunk the container since the last refresh(), i.e. that none of the elements read since then could have been overwritten.
+		 */
+		bool consistent() const noexcept {
+			std::atomic_thread_fence(std::memory_order_acquire); // orders the reads of the elements before the load of the generation
+			return header().generation.load(std::memory_order_relaxed) == generation_;
+		}
+
+		/**
+		 * Converting operator to dynarray_const_ref.
+		 */
+		operator dynarray_const_ref<T>() const noexcept {
+			return dynarray_const_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+
+		/**
+		 * Gets a pointer to the underlying base elements.
+		 */
+		const base_element* data() const noexcept { return reinterpret_cast<const base_element*>(static_cast<const char*>(segment_.data()) + sizeof(detail::shared_header)); }
+
+		const_reference operator[](size_type index) const noexcept { return static_cast<dynarray_const_ref<T>>(*this)[index]; }
+		const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+
+		size_type size() const noexcept { return size_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+		const_iterator cbegin() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).begin(); }
+		const_iterator cend() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).end(); }
+		const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+		const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+		const_iterator begin() const noexcept { return cbegin(); }
+		const_iterator end() const noexcept { return cend(); }
+		const_reverse_iterator rbegin() const noexcept { return crbegin(); }
+		const_reverse_iterator rend() const noexcept { return crend(); }
+
+		const_reference front() const noexcept { return operator[](0); }
+		const_reference back() const noexcept { return operator[](size_ - 1); }
+
+		/**
+		 * Gets the extents of elements that are stored in this array.
+		 */
+		const element_extents_type& extents() const noexcept { return extents_; }
+
+		friend bool operator==(const shared_view& a, const dynarray_const_ref<T>& b) {
+			return static_cast<dynarray_const_ref<T>>(a) == b;
+		}
+		friend bool operator!=(const shared_view& a, const dynarray_const_ref<T>& b) { return !(a == b); };
+
+	private:
+		const detail::shared_header& header() const noexcept { return *static_cast<const detail::shared_header*>(segment_.data()); }
+
+		shared_segment segment_;
+		size_t size_; // the size of the current dimension, as of the last refresh()
+		std::uint64_t generation_; // the generation of the current mapping
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic> // for std::atomic_thread_fence()
+#include <cassert>
+#include <limits>
+#include <stdexcept> // for std::out_of_range and std::length_error
+#include <type_traits>
+
+#include "dynarray.hpp"
+#include "growth_policy.hpp"
+#include "shared_memory.hpp"
+#include "core.hpp"
+#include "iterator.hpp"
+
+namespace multidim {
+
+	/**
+	 * Represents a multidimensional array whose outermost dimension is a growable vector, and whose base elements live in a named POSIX shared-memory segment.
+	 * There must be at most one shared_vector (the writer) per segment; other processes attach to it with shared_view.
+	 * Growing past the capacity resizes the segment, then increments the generation counter in the header so that readers know to map it again on their next shared_view::refresh().
+	 * Each new element is written before the size in the header is updated (with release semantics), so readers never see partially written elements at indices below the size they loaded.
+	 * Shrinking (pop_back() or clear()) increments the generation counter before any removed slot can be written again, so a reader that is still reading up to an older size can tell afterwards with shared_view::consistent().
+	 * The segment never shrinks, since readers might still have the old size mapped.
+	 * Base elements must be trivially copyable, and are never constructed or destroyed.
+	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 * @tparam Growth the growth policy, which decides the new capacity when the vector runs out of space (see geometric_growth)
+	 */
+	template <typename T, typename Growth = default_growth>
+	class shared_vector {
+	public:
+		using value_type = typename element_traits<T>::value_type;
+		using reference = typename element_traits<T>::reference;
+		using const_reference = typename element_traits<T>::const_reference;
+		using pointer = typename element_traits<T>::pointer;
+		using const_pointer = typename element_traits<T>::const_pointer;
+		using iterator = iterator_impl<T, false>;
+		using const_iterator = iterator_impl<T, true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+		using difference_type = ptrdiff_t;
+		using size_type = size_t;
+		using element_extents_type = typename element_traits<T>::extents_type;
+		using container_extents_type = dynamic_extent<element_extents_type>;
+		using base_element = typename element_traits<T>::base_element;
+		using growth_policy = Growth;
+		static_assert(std::is_trivially_copyable_v<base_element>, "shared memory requires trivially copyable base elements");
+
+		/**
+		 * Maps an existing segment as its writer (e.g. after the previous writer has exited), given the element_extents_type (inner dimensions).
+		 * Throws std::invalid_argument if the segment holds a different base element type or has different extents.
+		 */
+		shared_vector(const char* name, const element_extents_type& extents) : segment_(name, map_mode::read_write), size_(0), capacity_(0), extents_(extents) {
+			detail::check_shared_header<base_element>(segment_.data(), segment_.size(), extents_.stride());
+			size_ = static_cast<size_type>(header().size.load(std::memory_order_acquire));
+			const size_type row_bytes = extents_.stride() * sizeof(base_element);
+			capacity_ = row_bytes != 0 ? (segment_.size() - sizeof(detail::shared_header)) / row_bytes : size_;
+			if (capacity_ < size_) throw std::length_error("multidim: shared memory segment is smaller than its size");
+		}
+		/**
+		 * Maps an existing segment as its writer, given the inner dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		shared_vector(const char* name, TNs... ns) : shared_vector(name, element_extents_type(ns...)) {}
+		/**
+		 * Creates (or truncates) a segment that holds an empty vector with the given element_extents_type (inner dimensions).
+		 */
+		static shared_vector create(const char* name, const element_extents_type& extents) {
+			shared_segment segment = shared_segment::create(name, detail::shared_segment_bytes<base_element>(0, extents.stride()));
+			detail::init_shared_header<base_element>(segment.data(), extents.stride(), 0);
+			return shared_vector(std::move(segment), extents);
+		}
+		/**
+		 * Creates (or truncates) a segment that holds an empty vector with the given inner dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		static shared_vector create(const char* name, TNs... ns) {
+			return create(name, element_extents_type(ns...));
+		}
+		shared_vector(const shared_vector&) = delete;
+		shared_vector(shared_vector&& other) noexcept : segment_(std::move(other.segment_)), size_(other.size_), capacity_(other.capacity_), extents_(other.extents_) {
+			other.size_ = 0;
+			other.capacity_ = 0;
+		}
+		shared_vector& operator=(const shared_vector&) = delete;
+		shared_vector& operator=(shared_vector&& other) noexcept {
+			shared_vector tmp(std::move(other));
+			swap(tmp);
+			return *this;
+		}
+
+		friend void swap(shared_vector& a, shared_vector& b) noexcept {
+			a.swap(b);
+		}
+		void swap(shared_vector& other) noexcept {
+			using std::swap;
+			swap(segment_, other.segment_);
+			swap(size_, other.size_);
+			swap(capacity_, other.capacity_);
+			swap(extents_, other.extents_);
+		}
+
+		/**
+		 * Converting operator to dynarray_ref.
+		 */
+		operator dynarray_ref<T>() noexcept {
+			return dynarray_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+		/**
+		 * Converting operator to dynarray_const_ref.
+		 */
+		operator dynarray_const_ref<T>() const noexcept {
+			return dynarray_const_ref<T>{ data(), container_extents_type{ size_, extents_ } };
+		}
+
+		/**
+		 * Gets a pointer to the underlying base elements.  This pointer is invalidated whenever the capacity changes.
+		 */
+		base_element* data() noexcept { return reinterpret_cast<base_element*>(static_cast<char*>(segment_.data()) + sizeof(detail::shared_header)); }
+		const base_element* data() const noexcept { return reinterpret_cast<const base_element*>(static_cast<const char*>(segment_.data()) + sizeof(detail::shared_header)); }
+
+		reference operator[](size_type index) noexcept { assert(index < size_); return static_cast<dynarray_ref<T>>(*this)[index]; }
+		const_reference operator[](size_type index) const noexcept { assert(index < size_); return static_cast<dynarray_const_ref<T>>(*this)[index]; }
+		reference at(size_type index) { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+		const_reference at(size_type index) const { if (index >= size_) throw std::out_of_range("element access index out of range"); else return operator[](index); }
+
+		size_type size() const noexcept { return size_; }
+		size_type max_size() const noexcept { return std::numeric_limits<difference_type>::max(); }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+		size_type capacity() const noexcept { return capacity_; }
+
+		const_iterator cbegin() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).begin(); }
+		const_iterator cend() const noexcept { return static_cast<dynarray_const_ref<T>>(*this).end(); }
+		const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+		const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+		const_iterator begin() const noexcept { return cbegin(); }
+		iterator begin() noexcept { return static_cast<dynarray_ref<T>>(*this).begin(); }
+		const_iterator end() const noexcept { return cend(); }
+		iterator end() noexcept { return static_cast<dynarray_ref<T>>(*this).end(); }
+		const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(end()); }
+		reverse_iterator rbegin() noexcept { return std::make_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(begin()); }
+		reverse_iterator rend() noexcept { return std::make_reverse_iterator(begin()); }
+
+		reference front() noexcept { return operator[](0); }
+		const_reference front() const noexcept { return operator[](0); }
+		reference back() noexcept { return operator[](size_ - 1); }
+		const_reference back() const noexcept { return operator[](size_ - 1); }
+
+		/**
+		 * Reserves enough space in the segment to store at least new_cap elements, without further remapping.
+		 */
+		void reserve(size_type new_cap) {
+			if (new_cap <= capacity_) return;
+			segment_.resize(detail::shared_segment_bytes<base_element>(new_cap, extents_.stride()));
+			capacity_ = new_cap;
+			header().generation.fetch_add(1, std::memory_order_release);
+		}
+		/**
+		 * Removes all existing elements from the vector.  The segment keeps its size.
+		 */
+		void clear() noexcept {
+			if (size_ != 0) shrink(0);
+		}
+
+		/**
+		 * Adds an element to the back of the vector, growing the segment if necessary.  This is safe even if `value` is a reference to an element of this same vector.
+		 */
+		void push_back(const_reference value) {
+			if (size_ == capacity_) {
+				// the mapping might move, so remember where the value is if it is part of this vector
+				const base_element* src = value_data(value);
+				const bool internal = src >= data() && src < data() + size_ * extents_.stride();
+				const size_type offset = internal ? static_cast<size_type>(src - data()) : 0;
+				reserve(Growth::next_capacity(capacity_, size_ + 1));
+				if (internal) src = data() + offset;
+				std::copy_n(src, extents_.stride(), data() + size_ * extents_.stride());
+			}
+			else {
+				std::copy_n(value_data(value), extents_.stride(), data() + size_ * extents_.stride());
+			}
+			set_size(size_ + 1);
+		}
+		/**
+		 * Removes the back element from this vector.  This is undefined behaviour if size()==0.
+		 */
+		void pop_back() noexcept { shrink(size_ - 1); }
+
+		/**
+		 * Gets the extents of elements that are stored in this vector.
+		 */
+		const element_extents_type& extents() const noexcept { return extents_; }
+		/**
+		 * Gets the generation of the segment, i.e. the number of times that it has been resized or the vector has shrunk.
+		 */
+		std::uint64_t generation() const noexcept { return header().generation.load(std::memory_order_relaxed); }
+
+		friend bool operator==(const shared_vector& a, const dynarray_const_ref<T>& b) {
+			return static_cast<dynarray_const_ref<T>>(a) == b;
+		}
+		friend bool operator!=(const shared_vector& a, const dynarray_const_ref<T>& b) { return !(a == b); };
+
+	private:
+		shared_vector(shared_segment&& segment, const element_extents_type& extents) noexcept : segment_(std::move(segment)), size_(0), capacity_(0), extents_(extents) {}
+
+		detail::shared_header& header() noexcept { return *static_cast<detail::shared_header*>(segment_.data()); }
+		const detail::shared_header& header() const noexcept { return *static_cast<const detail::shared_header*>(segment_.data()); }
+		void set_size(size_type size) noexcept {
+			size_ = size;
+			header().size.store(size, std::memory_order_release); // publishes the elements to readers
+		}
+
+		/**
+		 * Lowers the size.  The slots past the new size will be written again by push_back(), so the generation counter is incremented (and fenced) before that, like the sequence number of a seqlock.
+		 */
+		void shrink(size_type size) noexcept {
+			header().generation.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			set_size(size);
+		}
+
+		static const base_element* value_data(const_reference value) noexcept {
+			if constexpr (element_traits<T>::is_inner_container) {
+				return value.data();
+			}
+			else {
+				return &value;
+			}
+		}
+
+		shared_segment segment_;
+		size_t size_; // the size of the current dimension
+		size_t capacity_; // the capacity of the current dimension
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4848)
+#endif
+		[[no_unique_address]] element_extents_type extents_;
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm> // for std::min() and std::copy_n()
+#include <cassert>
+#include <cstddef>
+#include <iterator> // for std::iterator_traits
+#include <type_traits>
+#include <utility> // for std::pair
+#include <vector>
+
+#include "compare.hpp"
+
+/**
+ * A search index over a large table of rows sorted by lex_less.
+ * Binary search over the rows themselves touches a whole row (often in a different page) at each of its O(log N) steps.
+ * The index instead keeps a short prefix of every row in Eytzinger (breadth-first) order, so that the first steps of every lookup share the same few cache lines, and each later step loads one small prefix that was already prefetched.
+ * Rows are only read when their prefix ties with the key.
+ */
+
+namespace multidim {
+
+	/**
+	 * Index for lower_bound() / upper_bound() / equal_range() lookups of keys in a range of rows that is sorted by lex_less.
+	 * The index refers to the rows through iterators, so the rows must not be modified or moved while it is in use.
+	 * It takes prefix_size base elements and one size_t of memory per row, where prefix_size is the number of base elements kept per row.
+	 */
+	template <typename RandomIt>
+	class sorted_row_index {
+	public:
+		using iterator = RandomIt;
+		using row_reference = typename std::iterator_traits<RandomIt>::reference;
+		using base_element = typename std::decay_t<row_reference>::base_element;
+		using size_type = size_t;
+
+		/**
+		 * The default number of base elements of each row that is kept in the index: 8 bytes' worth.
+		 */
+		constexpr static size_type default_prefix_size = sizeof(base_element) >= 8 ? 1 : 8 / sizeof(base_element);
+
+		sorted_row_index() = default;
+		/**
+		 * Builds the index for the rows in [first, last), which must be sorted by lex_less and have the same extents.
+		 * @param prefix_size the number of base elements of each row to keep in the index (at least 1); longer prefixes cost memory, but make ties (and hence reads of the rows) rarer
+		 */
+		sorted_row_index(RandomIt first, RandomIt last, size_type prefix_size = default_prefix_size) : first_(first), size_(static_cast<size_type>(last - first)) {
+			if (size_ == 0) return;
+			const row_reference front = *first;
+			row_elements_ = front.size() * front.extents().stride();
+			prefix_size_ = std::min(std::max(prefix_size, size_type{ 1 }), row_elements_);
+			prefixes_.resize((size_ + 1) * prefix_size_);
+			order_.resize(size_ + 1);
+			size_type i = 0;
+			build(1, i);
+		}
+
+		size_type size() const noexcept { return size_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+		size_type prefix_size() const noexcept { return prefix_size_; }
+
+		/**
+		 * Gets the first row that does not compare less than key (like multidim::lower_bound(first, last, key, lex_less{})).
+		 */
+		template <typename Key>
+		RandomIt lower_bound(const Key& key) const {
+			return first_ + static_cast<typename std::iterator_traits<RandomIt>::difference_type>(search<false>(key));
+		}
+		/**
+		 * Gets the first row that compares greater than key (like multidim::upper_bound(first, last, key, lex_less{})).
+		 */
+		template <typename Key>
+		RandomIt upper_bound(const Key& key) const {
+			return first_ + static_cast<typename std::iterator_traits<RandomIt>::difference_type>(search<true>(key));
+		}
+		template <typename Key>
+		std::pair<RandomIt, RandomIt> equal_range(const Key& key) const {
+			return { lower_bound(key), upper_bound(key) };
+		}
+		template <typename Key>
+		bool contains(const Key& key) const {
+			const size_type index = search<false>(key);
+			return index != size_ && lex_compare(first_[static_cast<typename std::iterator_traits<RandomIt>::difference_type>(index)], key) == 0;
+		}
+
+	private:
+		/**
+		 * Fills the subtree rooted at node k with the rows from index i onwards (an in-order traversal), and advances i past them.
+		 */
+		void build(size_type k, size_type& i) {
+			if (k > size_) return;
+			build(2 * k, i);
+			const row_reference row = first_[static_cast<typename std::iterator_traits<RandomIt>::difference_type>(i)];
+			std::copy_n(row.data(), prefix_size_, prefixes_.data() + k * prefix_size_);
+			order_[k] = i++;
+			build(2 * k + 1, i);
+		}
+
+		/**
+		 * Gets the index of the first row that compares greater than key (if Upper) or not less than key (otherwise).
+		 */
+		template <bool Upper, typename Key>
+		size_type search(const Key& key) const {
+			if (size_ == 0) return 0;
+			assert(key.size() * key.extents().stride() == row_elements_);
+			const base_element* const key_prefix = key.data();
+			size_type k = 1;
+			while (k <= size_) {
+#if defined(__GNUC__) || defined(__clang__)
+				// nodes 16k to 16k + 15 are the great-great-grandchildren of k, and are usually a few cache lines in total
+				__builtin_prefetch(prefixes_.data() + std::min(16 * k, size_) * prefix_size_);
+#endif
+				int c = detail::compare_n(prefixes_.data() + k * prefix_size_, key_prefix, prefix_size_);
+				if (c == 0 && prefix_size_ != row_elements_) c = lex_compare(first_[static_cast<typename std::iterator_traits<RandomIt>::difference_type>(order_[k])], key);
+				k = 2 * k + static_cast<size_type>(Upper ? c <= 0 : c < 0);
+			}
+			// the answer is the last node at which the search went left: strip the trailing right turns and that left turn
+			while (k & 1) k >>= 1;
+			k >>= 1;
+			return k == 0 ? size_ : order_[k];
+		}
+
+		RandomIt first_{};
+		size_type size_ = 0;
+		size_type row_elements_ = 0;
+		size_type prefix_size_ = 0;
+		std::vector<base_element> prefixes_; // the prefix of node k is at [k * prefix_size_, (k + 1) * prefix_size_); node 0 is unused
+		std::vector<size_type> order_; // the row index of each node
+	};
+}
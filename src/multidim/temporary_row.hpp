@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm> // for std::copy_n()
+#include <cassert>
+#include <cstddef>
+#include <memory> // for std::unique_ptr, std::uninitialized_value_construct_n() and std::destroy_n()
+#include <new> // for std::nothrow and std::nothrow_t
+#include <type_traits>
+
+#include "core.hpp"
+#include "array.hpp"
+#include "dynarray.hpp"
+
+/**
+ * Temporary rows, for algorithms that need to hold the value of a row while the row itself is overwritten (e.g. a cycle-leader rotation).
+ * Their sizes are only known at runtime, so their memory comes from a small per-thread stack arena, or from the heap when the arena is full.
+ */
+
+namespace multidim {
+
+	namespace detail {
+		/**
+		 * A stack of memory for temporary_row, one per thread.  Blocks must be freed in the reverse order of allocation.
+		 * The arena allocates its storage the first time it is used, so threads that never use temporary rows do not pay for it.
+		 */
+		class temporary_arena {
+		public:
+			constexpr static size_t capacity = size_t{ 64 } << 10;
+
+			/**
+			 * Allocates a block of the given size, aligned for any scalar type, or returns nullptr if it does not fit.
+			 */
+			void* allocate(size_t bytes) noexcept {
+				bytes = round_up(bytes);
+				if (bytes > capacity - top_) return nullptr;
+				if (!storage_) {
+					storage_.reset(new (std::nothrow) std::max_align_t[capacity / sizeof(std::max_align_t)]);
+					if (!storage_) return nullptr;
+				}
+				void* const ret = reinterpret_cast<unsigned char*>(storage_.get()) + top_;
+				top_ += bytes;
+				return ret;
+			}
+			/**
+			 * Frees the most recently allocated block.
+			 */
+			void deallocate([[maybe_unused]] void* ptr, size_t bytes) noexcept {
+				top_ -= round_up(bytes);
+				assert(ptr == reinterpret_cast<unsigned char*>(storage_.get()) + top_);
+			}
+
+		private:
+			constexpr static size_t round_up(size_t bytes) noexcept {
+				return (bytes + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+			}
+
+			std::unique_ptr<std::max_align_t[]> storage_;
+			size_t top_ = 0;
+		};
+
+		inline temporary_arena& this_thread_temporary_arena() noexcept {
+			thread_local temporary_arena arena;
+			return arena;
+		}
+
+		/**
+		 * Gets the extents of the container that a row is a reference to (or of the row itself, if it is a container).
+		 */
+		template <typename Extents, typename R>
+		constexpr inline Extents container_extents_of(const R& row) noexcept {
+			if constexpr (Extents::is_dynamic) {
+				return Extents{ row.size(), row.extents() };
+			}
+			else {
+				return Extents{ row.extents() };
+			}
+		}
+	}
+
+	/**
+	 * Gets the inner container type (e.g. inner_dynarray<int>) that corresponds to a container or reference type (e.g. dynarray_ref<int>).
+	 */
+	template <typename T>
+	struct inner_container_of {};
+	template <typename T, typename BufferKind>
+	struct inner_container_of<dynarray<T, BufferKind>> { using type = inner_dynarray<T>; };
+	template <typename T>
+	struct inner_container_of<dynarray_ref<T>> { using type = inner_dynarray<T>; };
+	template <typename T>
+	struct inner_container_of<dynarray_const_ref<T>> { using type = inner_dynarray<T>; };
+	template <typename T, size_t N>
+	struct inner_container_of<array<T, N>> { using type = inner_array<T, N>; };
+	template <typename T, size_t N>
+	struct inner_container_of<array_ref<T, N>> { using type = inner_array<T, N>; };
+	template <typename T, size_t N>
+	struct inner_container_of<array_const_ref<T, N>> { using type = inner_array<T, N>; };
+	template <typename T>
+	using inner_container_of_t = typename inner_container_of<T>::type;
+
+	/**
+	 * A row with the given inner container shape (e.g. inner_dynarray<int>) whose extents are only known at runtime, to be used as a temporary inside algorithms.
+	 * The elements live in a per-thread stack arena of 64 KiB if they fit, and on the heap otherwise, so temporary rows must be automatic variables: they cannot be copied or moved, and must be destroyed on the thread that created them, in the reverse order of creation.
+	 * A temporary row can be assigned from the rows of containers, and converts to const_reference so that it can be assigned to them; ref() gives a mutable reference to it.
+	 */
+	template <typename Inner>
+	class temporary_row {
+		static_assert(element_traits<Inner>::is_inner_container, "temporary_row needs an inner container type, e.g. inner_dynarray<T>");
+	public:
+		using reference = typename element_traits<Inner>::reference;
+		using const_reference = typename element_traits<Inner>::const_reference;
+		using extents_type = typename element_traits<Inner>::extents_type;
+		using base_element = typename element_traits<Inner>::base_element;
+
+		/**
+		 * Constructs a row of the given extents, with value-initialized elements.
+		 */
+		explicit temporary_row(const extents_type& extents) : extents_(extents) {
+			allocate(nullptr);
+		}
+		/**
+		 * Constructs a copy of a row (a container or a reference with the same shape).
+		 */
+		template <typename R, typename = std::enable_if_t<std::is_same_v<inner_container_of_t<R>, Inner>>>
+		explicit temporary_row(const R& row) : extents_(detail::container_extents_of<extents_type>(row)) {
+			allocate(row.data());
+		}
+		/**
+		 * Constructs a copy of a row (a container or a reference with the same shape) in the per-thread arena, without allocating from the heap and without throwing.
+		 * If the row does not fit in the arena, the temporary row is empty (it converts to false, and must not be used otherwise).
+		 */
+		template <typename R, typename = std::enable_if_t<std::is_same_v<inner_container_of_t<R>, Inner>>>
+		temporary_row(std::nothrow_t, const R& row) noexcept : extents_(detail::container_extents_of<extents_type>(row)) {
+			static_assert(std::is_nothrow_copy_constructible_v<base_element>, "only rows of nothrow copy constructible elements can be copied without throwing");
+			if constexpr (alignof(base_element) <= alignof(std::max_align_t)) {
+				const size_t n = extents_.stride();
+				if (void* const ptr = detail::this_thread_temporary_arena().allocate(n * sizeof(base_element))) {
+					std::uninitialized_copy_n(row.data(), n, static_cast<base_element*>(ptr));
+					data_ = static_cast<base_element*>(ptr);
+				}
+			}
+		}
+		temporary_row(const temporary_row&) = delete;
+		temporary_row(temporary_row&&) = delete;
+		~temporary_row() {
+			if (data_ && !heap_) {
+				const size_t n = extents_.stride();
+				std::destroy_n(data_, n);
+				detail::this_thread_temporary_arena().deallocate(data_, n * sizeof(base_element));
+			}
+		}
+
+		/**
+		 * Copies the elements of a row with the same extents into this row.
+		 */
+		temporary_row& operator=(const_reference other) {
+			ref() = other;
+			return *this;
+		}
+		temporary_row& operator=(const temporary_row& other) {
+			ref() = other.cref();
+			return *this;
+		}
+
+		reference ref() noexcept { return reference{ data_, extents_ }; }
+		const_reference cref() const noexcept { return const_reference{ data_, extents_ }; }
+		operator const_reference() const noexcept { return cref(); }
+		/**
+		 * Checks whether the temporary row holds a row; this is false only for a row constructed with std::nothrow that did not fit in the arena.
+		 */
+		explicit operator bool() const noexcept { return data_ != nullptr; }
+
+		base_element* data() noexcept { return data_; }
+		const base_element* data() const noexcept { return data_; }
+		const extents_type& extents() const noexcept { return extents_; }
+
+	private:
+		/**
+		 * Allocates the elements, and copies them from src, or value-initializes them if src is nullptr.
+		 */
+		void allocate(const base_element* src) {
+			const size_t n = extents_.stride();
+			if constexpr (alignof(base_element) <= alignof(std::max_align_t)) {
+				detail::temporary_arena& arena = detail::this_thread_temporary_arena();
+				if (void* const ptr = arena.allocate(n * sizeof(base_element))) {
+					try {
+						if (src) std::uninitialized_copy_n(src, n, static_cast<base_element*>(ptr));
+						else std::uninitialized_value_construct_n(static_cast<base_element*>(ptr), n);
+					}
+					catch (...) {
+						arena.deallocate(ptr, n * sizeof(base_element));
+						throw;
+					}
+					data_ = static_cast<base_element*>(ptr);
+					return;
+				}
+			}
+			// over-aligned elements and rows that do not fit in the arena go on the heap
+			if (src) {
+				heap_.reset(new base_element[n]);
+				std::copy_n(src, n, heap_.get());
+			}
+			else {
+				heap_.reset(new base_element[n]());
+			}
+			data_ = heap_.get();
+		}
+
+		extents_type extents_;
+		base_element* data_ = nullptr;
+		std::unique_ptr<base_element[]> heap_; // nullptr if the elements are in the arena
+	};
+
+	/**
+	 * Constructs a temporary copy of a row, e.g. `auto tmp = multidim::make_temporary_row(*it);`.
+	 */
+	template <typename R>
+	inline temporary_row<inner_container_of_t<R>> make_temporary_row(const R& row) {
+		return temporary_row<inner_container_of_t<R>>(row);
+	}
+}
@@ -1,32 +1,134 @@
 #pragma once
 
+#include <memory>
 #include <type_traits>
+#include <utility> // for std::move()
 
 #include "dynamic_buffer.hpp"
 
 namespace multidim {
 	/**
 	 * A dynamic_buffer that does not construct/destruct its elements.
+	 * @tparam Kind plain_buffer or managed_buffer (see dynamic_buffer)
 	 */
-	template <typename T>
+	template <typename T, typename Kind = plain_buffer>
 	class uninitialized_dynamic_buffer {
+		constexpr static bool is_managed = std::is_same_v<Kind, managed_buffer>;
 	public:
-		using storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+		// trivial elements are stored as themselves, so that a plain buffer of them is a real T[] that can change owners as a std::unique_ptr<T[]>
+		using storage = std::conditional_t<std::is_trivial_v<T>, T, std::aligned_storage_t<sizeof(T), alignof(T)>>;
+		/**
+		 * The owning pointer that release() returns: a std::unique_ptr<T[]> for plain buffers, or a buffer_ptr<T> for managed buffers.
+		 */
+		using owning_ptr = std::conditional_t<is_managed, buffer_ptr<T>, std::unique_ptr<T[]>>;
 
 		constexpr T* data() noexcept { return reinterpret_cast<T*>(buf_.data()); }
 		constexpr const T* data() const noexcept { return reinterpret_cast<const T*>(buf_.data()); }
 		constexpr uninitialized_dynamic_buffer() = default;
-		constexpr uninitialized_dynamic_buffer(size_t sz) noexcept : buf_(std::make_unique<storage[]>(sz)) {}
+		constexpr uninitialized_dynamic_buffer(size_t sz) noexcept : buf_(allocate_storage(sz)) {}
+		/**
+		 * Constructs an empty managed buffer that remembers the given policy.
+		 */
+		constexpr explicit uninitialized_dynamic_buffer(const buffer_policy& policy) noexcept : buf_(policy) {}
+		/**
+		 * Constructs a managed buffer for sz elements, allocated according to the given policy.
+		 */
+		uninitialized_dynamic_buffer(size_t sz, const buffer_policy& policy) : buf_(detail::use_page_allocation(sz * sizeof(storage), policy) ? buffer_type(sz, policy) : buffer_type(allocate_storage(sz), policy)) {}
+		/**
+		 * Takes ownership of a buffer, for a managed buffer.  Its deleter will be called without destroying any elements first, so that the owner must destroy the elements that it constructed.
+		 * For non-trivial elements this allocates a small deleter object; if that throws, the buffer is freed with its own deleter.
+		 */
+		explicit uninitialized_dynamic_buffer(buffer_ptr<T>&& ptr) : buf_(adopt_storage(std::move(ptr))) {
+			static_assert(is_managed, "only managed buffers can hold a custom deleter");
+		}
+		/**
+		 * Takes ownership of a heap buffer of trivial elements.
+		 */
+		constexpr explicit uninitialized_dynamic_buffer(std::unique_ptr<T[]>&& ptr) noexcept : buf_(std::move(ptr)) {
+			static_assert(std::is_same_v<storage, T>, "only buffers of trivial elements can adopt a std::unique_ptr<T[]>");
+		}
 		constexpr uninitialized_dynamic_buffer(const uninitialized_dynamic_buffer&) noexcept = delete;
 		constexpr uninitialized_dynamic_buffer(uninitialized_dynamic_buffer&&) noexcept = default;
 		constexpr uninitialized_dynamic_buffer& operator=(const uninitialized_dynamic_buffer&) noexcept = delete;
 		constexpr uninitialized_dynamic_buffer& operator=(uninitialized_dynamic_buffer&&) noexcept = default;
-		
+
+		/**
+		 * Creates a new buffer for sz elements, allocated the same way as this one (i.e. with the same policy, for a managed buffer).
+		 */
+		constexpr uninitialized_dynamic_buffer allocate_like(size_t sz) const {
+			if constexpr (is_managed) return uninitialized_dynamic_buffer(sz, policy());
+			else return uninitialized_dynamic_buffer(sz);
+		}
+		/**
+		 * Gets the policy that this managed buffer was allocated with.
+		 */
+		constexpr const buffer_policy& policy() const noexcept { return buf_.policy(); }
+		/**
+		 * Gives up ownership of the buffer, leaving this buffer empty.  The first `constructed` elements of the buffer are destroyed when the returned pointer frees it.
+		 * A plain buffer can only be released if its elements are trivial, so that delete[] frees it.
+		 * For a managed buffer of non-trivial elements, this allocates a small deleter object; if that throws, this buffer keeps ownership of the buffer.
+		 */
+		owning_ptr release([[maybe_unused]] size_t constructed) {
+			if constexpr (std::is_same_v<storage, T>) {
+				return buf_.release(); // trivial elements need not be destroyed
+			}
+			else {
+				static_assert(is_managed, "only plain buffers of trivial elements can be released; use managed_buffer for other elements");
+				const buffer_policy policy = buf_.policy();
+				if (!buf_.data()) return buffer_ptr<T>(nullptr, buffer_deleter<T>(policy));
+				T* const ptr = data();
+				destroying_deleter deleter{ buf_.release(), constructed };
+				try {
+					return buffer_ptr<T>(ptr, buffer_deleter<T>(std::move(deleter), policy));
+				}
+				catch (...) {
+					// the deleter object could not be allocated, so the inner buffer was not moved from
+					buf_ = buffer_type(std::move(deleter.inner));
+					throw;
+				}
+			}
+		}
 		friend void swap(uninitialized_dynamic_buffer& a, uninitialized_dynamic_buffer& b) noexcept {
 			using std::swap;
 			swap(a.buf_, b.buf_);
 		}
 	private:
-		multidim::dynamic_buffer<storage> buf_;
+		using buffer_type = multidim::dynamic_buffer<storage, Kind>;
+
+		static std::unique_ptr<storage[]> allocate_storage(size_t sz) {
+#if defined(__cpp_lib_smart_ptr_for_overwrite) && __cpp_lib_smart_ptr_for_overwrite >= 202002L
+			return std::make_unique_for_overwrite<storage[]>(sz);
+#else
+			return std::unique_ptr<storage[]>(new storage[sz]); // default-initialized, so that allocating does not touch every page
+#endif
+		}
+
+		/**
+		 * Destroys the constructed elements of a released buffer, then frees it with its original deleter.
+		 */
+		struct destroying_deleter {
+			buffer_ptr<storage> inner;
+			size_t constructed;
+			void operator()(T* p) noexcept {
+				std::destroy_n(p, constructed);
+				inner.reset();
+			}
+		};
+
+		static buffer_type adopt_storage(buffer_ptr<T>&& ptr) {
+			if constexpr (std::is_same_v<storage, T>) {
+				return buffer_type(std::move(ptr));
+			}
+			else {
+				const buffer_policy policy = ptr.get_deleter().policy();
+				if (!ptr) return buffer_type(policy);
+				storage* const raw = reinterpret_cast<storage*>(ptr.get());
+				return buffer_type(buffer_ptr<storage>(raw, buffer_deleter<storage>([inner = std::move(ptr)](storage*) mutable noexcept {
+					inner.reset();
+				}, policy)));
+			}
+		}
+
+		buffer_type buf_;
 	};
 }
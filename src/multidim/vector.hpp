@@ -7,6 +7,7 @@
 #include <type_traits>
 
 #include "dynarray.hpp"
+#include "growth_policy.hpp"
 #include "uninitialized_dynamic_buffer.hpp"
 #include "core.hpp"
 #include "iterator.hpp"
@@ -18,8 +19,10 @@ namespace multidim {
 	/**
 	 * Represents a multidimensional array whose outermost dimension is a growable vector.
 	 * @tparam T the element type; if this is the innermost dimension then T is the base element type, otherwise T is an inner container (i.e. something that extends from enable_inner_container)
+	 * @tparam Growth the growth policy, which decides the new capacity when the vector runs out of space (see geometric_growth)
+	 * @tparam BufferKind plain_buffer, or managed_buffer to support buffer policies and adopting buffers with custom deleters (see dynamic_buffer)
 	 */
-	template <typename T>
+	template <typename T, typename Growth = default_growth, typename BufferKind = plain_buffer>
 	class vector {
 	public:
 		using value_type = typename element_traits<T>::value_type;
@@ -36,10 +39,11 @@ namespace multidim {
 		using element_extents_type = typename element_traits<T>::extents_type;
 		using container_extents_type = dynamic_extent<element_extents_type>;
 		using base_element = typename element_traits<T>::base_element;
-		using buffer_type = uninitialized_dynamic_buffer<base_element>;
+		using buffer_type = uninitialized_dynamic_buffer<base_element, BufferKind>;
+		using growth_policy = Growth;
 
 
-		constexpr vector(const vector& other) : data_(other.size_* other.extents_.stride()), size_(other.size_), capacity_(other.size_), extents_(other.extents_) {
+		constexpr vector(const vector& other) : data_(other.data_.allocate_like(other.size_ * other.extents_.stride())), size_(other.size_), capacity_(other.size_), extents_(other.extents_) {
 			std::uninitialized_copy_n(other.data_.data(), other.size_ * other.extents_.stride(), data_.data());
 		}
 		constexpr vector(vector&& other) noexcept(std::is_nothrow_move_constructible_v<buffer_type>) : data_(std::move(other.data_)), size_(other.size_), capacity_(other.capacity_), extents_(other.extents_) {
@@ -57,6 +61,53 @@ namespace multidim {
 		 */
 		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
 		constexpr explicit vector(TNs... ns) noexcept : vector(element_extents_type(ns...)) {}
+		/**
+		 * Constructs an empty vector whose buffers will be allocated according to the given policy, given the element_extents_type (inner dimensions).  The vector must use managed_buffer.
+		 */
+		constexpr explicit vector(const buffer_policy& policy, const element_extents_type& extents) noexcept : data_(policy), size_(0), capacity_(0), extents_(extents) {
+			static_assert(std::is_same_v<BufferKind, managed_buffer>, "buffer policies need a vector with managed_buffer");
+		}
+		/**
+		 * Constructs an empty vector whose buffers will be allocated according to the given policy, given the inner dimensions.
+		 */
+		template <typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		constexpr explicit vector(const buffer_policy& policy, TNs... ns) noexcept : vector(policy, element_extents_type(ns...)) {}
+		/**
+		 * Constructs a vector that takes ownership of an existing buffer with space for capacity elements, of which the first size are initialized, given the element_extents_type (inner dimensions).
+		 * Nothing is copied, and the buffer is eventually freed by its own deleter.  Other deleters than std::default_delete (e.g. one from the library that produced the buffer) need a vector with managed_buffer.
+		 * The deleter must only free the memory, since the vector destroys its own elements; hence the base elements must be trivially destructible (and trivial, for a vector with plain_buffer).
+		 * Holding a custom deleter allocates a small object; if that throws, the buffer is freed with its own deleter.
+		 */
+		template <typename D>
+		static vector adopt(std::unique_ptr<base_element[], D>&& buf, size_type size, size_type capacity, const element_extents_type& extents) {
+			static_assert(std::is_trivially_destructible_v<base_element>, "vector can only adopt buffers of trivially destructible base elements");
+			assert(size <= capacity);
+			vector ret(extents);
+			if constexpr (std::is_same_v<BufferKind, managed_buffer>) {
+				ret.data_ = buffer_type(to_buffer_ptr(std::move(buf)));
+			}
+			else {
+				static_assert(std::is_same_v<D, std::default_delete<base_element[]>>, "adopting a buffer with a custom deleter needs a vector with managed_buffer");
+				ret.data_ = buffer_type(std::move(buf));
+			}
+			ret.size_ = size;
+			ret.capacity_ = capacity;
+			return ret;
+		}
+		/**
+		 * Constructs a vector that takes ownership of an existing buffer, given the inner dimensions.
+		 */
+		template <typename D, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		static vector adopt(std::unique_ptr<base_element[], D>&& buf, size_type size, size_type capacity, TNs... ns) {
+			return adopt(std::move(buf), size, capacity, element_extents_type(ns...));
+		}
+		/**
+		 * Constructs a vector that takes ownership of an existing buffer, which will be freed with deleter(ptr), given the inner dimensions.
+		 */
+		template <typename D, typename... TNs, typename = std::enable_if_t<std::conjunction_v<std::is_convertible<size_t, TNs>...>>>
+		static vector adopt(base_element* ptr, D deleter, size_type size, size_type capacity, TNs... ns) {
+			return adopt(std::unique_ptr<base_element[], D>(ptr, std::move(deleter)), size, capacity, element_extents_type(ns...));
+		}
 		constexpr vector& operator=(const vector& other) {
 			clear();
 			if (extents_ == other.extents_) {
@@ -72,7 +123,7 @@ namespace multidim {
 			}
 			size_ = other.size_;
 			capacity_ = other.size_;
-			data_ = buffer_type(size_ * extents_.stride());
+			data_ = data_.allocate_like(size_ * extents_.stride());
 			std::uninitialized_copy_n(other.data_.data(), size_ * extents_.stride(), data_.data()); // construct/copy the new stuff
 			return *this;
 		}
@@ -126,7 +177,7 @@ namespace multidim {
 				// our existing data_ has enough space
 			}
 			else {
-				data_ = buffer_type(dist * extents_.stride());
+				data_ = data_.allocate_like(dist * extents_.stride());
 				capacity_ = dist;
 			}
 			multidim::uninitialized_copy(first, last, begin()); // construct/copy the new stuff
@@ -149,7 +200,7 @@ namespace multidim {
 				// our existing data_ has enough space
 			}
 			else {
-				data_ = buffer_type(count * extents_.stride());
+				data_ = data_.allocate_like(count * extents_.stride());
 				capacity_ = count;
 			}
 			multidim::uninitialized_fill_n(begin(), count, value); // construct/copy the new stuff
@@ -194,7 +245,7 @@ namespace multidim {
 				return base[index];
 			}
 		}
-		constexpr const_reference get_element(base_element* base, size_type index) const noexcept {
+		constexpr const_reference get_element(const base_element* base, size_type index) const noexcept {
 			assert(index < this->size_);
 			if constexpr (element_traits<T>::is_inner_container) {
 				return const_reference{ base + index * extents_.stride(), this->extents_ };
@@ -252,20 +303,33 @@ namespace multidim {
 		 */
 		constexpr void reserve(size_type new_cap) {
 			if (new_cap <= capacity_) return;
-			buffer_type tmp_buf(new_cap * extents_.stride());
+			buffer_type tmp_buf = data_.allocate_like(new_cap * extents_.stride());
 			multidim::uninitialized_move_if_noexcept(data(), data_offset(size_), tmp_buf.data());
 			std::destroy(data(), data_offset(size_)); // destroy existing data
 			data_ = std::move(tmp_buf);
 			capacity_ = new_cap;
 		}
 
+		/**
+		 * Gives up ownership of the buffer, which has space for capacity() elements of which the first size() are initialized, leaving this vector empty.  Nothing is copied.
+		 * For a vector with plain_buffer, this returns a std::unique_ptr<base_element[]>, and the base elements must be trivial.
+		 * For a vector with managed_buffer, this returns a buffer_ptr<base_element> that destroys the elements when it frees the buffer, and the buffer policy is kept for future allocations.  For non-trivial base elements this allocates a small deleter object; if that throws, the vector is left unchanged.
+		 * Note: The size and capacity are reset too, so read them before calling this.
+		 */
+		typename buffer_type::owning_ptr release() {
+			typename buffer_type::owning_ptr ret = data_.release(size_ * extents_.stride());
+			size_ = 0;
+			capacity_ = 0;
+			return ret;
+		}
+
 		/**
 		 * Requests the removal of unused capacity.
 		 */
 		constexpr void shrink_to_fit() {
 			if (size_ == capacity_) return;
 			assert(size_ < capacity_);
-			buffer_type tmp_buf(size_ * extents_.stride());
+			buffer_type tmp_buf = data_.allocate_like(size_ * extents_.stride());
 			multidim::uninitialized_move(data(), data_offset(size_), tmp_buf.data());
 			std::destroy(data(), data_offset(size_)); // destroy existing data
 			data_ = std::move(tmp_buf);
@@ -280,13 +344,71 @@ namespace multidim {
 			size_ = 0;
 		}
 
+		/**
+		 * Resizes the vector to contain count elements.  New base elements are value-initialized.
+		 */
+		constexpr void resize(size_type count) {
+			if (count <= size_) {
+				std::destroy(data_offset(count), data_offset(size_));
+			}
+			else {
+				if (count > capacity_) {
+					reserve(Growth::next_capacity(capacity_, count));
+				}
+				std::uninitialized_value_construct(data_offset(size_), data_offset(count));
+			}
+			size_ = count;
+		}
+		/**
+		 * Resizes the vector to contain count elements.  New base elements are default-initialized, so for trivial types they have indeterminate values and must be written before they are read.
+		 * This avoids zeroing memory that is about to be overwritten anyway (e.g. by a parser).
+		 */
+		constexpr void resize_for_overwrite(size_type count) {
+			if (count <= size_) {
+				std::destroy(data_offset(count), data_offset(size_));
+			}
+			else {
+				if (count > capacity_) {
+					reserve(Growth::next_capacity(capacity_, count));
+				}
+				std::uninitialized_default_construct(data_offset(size_), data_offset(count));
+			}
+			size_ = count;
+		}
+		/**
+		 * Resizes the vector to contain count elements.  New elements are copies of value.  This is safe even if `value` is a reference to an element of this same vector.
+		 */
+		constexpr void resize(size_type count, const_reference value) {
+			if (count <= size_) {
+				std::destroy(data_offset(count), data_offset(size_));
+			}
+			else if (count <= capacity_) {
+				for (size_type i = size_; i != count; ++i) {
+					multidim::uninitialized_copy_at(value, get_element(data_.data(), i));
+				}
+			}
+			else {
+				// copy the new elements before the old ones are moved out, like push_back()
+				size_type new_capacity;
+				buffer_type tmp_buf = create_new_buffer_amortized(count, new_capacity);
+				for (size_type i = size_; i != count; ++i) {
+					multidim::uninitialized_copy_at(value, get_element(tmp_buf.data(), i));
+				}
+				multidim::uninitialized_move_if_noexcept(data(), data_offset(size_), tmp_buf.data());
+				std::destroy(data(), data_offset(size_));
+				data_ = std::move(tmp_buf);
+				capacity_ = new_capacity;
+			}
+			size_ = count;
+		}
+
 	private:
 		/**
-		 * Creates and returns a new buffer of at least the desired capacity, but also at least twice of the original capacity (in order to provide amortized guarantees).
+		 * Creates and returns a new buffer of at least the desired capacity, but also at least as large as the growth policy demands (in order to provide amortized guarantees).
 		 */
 		constexpr buffer_type create_new_buffer_amortized(size_type min_capacity, size_type& out_capacity) {
-			const size_type new_capacity = std::max(min_capacity, capacity_ * 2);
-			buffer_type new_buffer(new_capacity); // might throw std::bad_alloc()
+			const size_type new_capacity = Growth::next_capacity(capacity_, min_capacity);
+			buffer_type new_buffer = data_.allocate_like(new_capacity * extents_.stride()); // might throw std::bad_alloc()
 			out_capacity = new_capacity; // assign the new capacity after allocating the buffer, in order to provide strong exception guarantee
 			return new_buffer; // implicit move
 		}
@@ -452,10 +574,10 @@ namespace multidim {
 		 * Compares if two vectors are elementwise equal.  If they have different shape or different number of elements, then it will also return false.
 		 */
 		friend constexpr MULTIDIM_FORCEINLINE bool operator==(const vector& a, const vector& b) {
-			return a.size_ == b.size_ && a.extents_ == b.extents_ && std::equal(a.data(), a.data_offset(a.size_), b.data());
+			return a.size_ == b.size_ && a.extents_ == b.extents_ && detail::equal_n(a.data(), b.data(), a.size_ * a.extents_.stride());
 		}
 		friend constexpr MULTIDIM_FORCEINLINE bool operator!=(const vector& a, const vector& b) { return !(a == b); };
-		// Note: We don't provide lexicographical comparison because it isn't clear what it means to compare arrays of different shape.
+		// Note: We don't provide lexicographical comparison operators because it isn't clear what it means to compare arrays of different shape.  Use lex_compare() or lex_less for arrays of the same shape.
 
 	private:
 
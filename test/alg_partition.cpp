@@ -43,6 +43,17 @@ TEST_CASE("algorithms partition and partition_copy", "[algorithm]") {
 		std::stable_partition(arr_2.begin(), arr_2.end(), pred);
 		REQUIRE(arr_1 == arr_2);
 		REQUIRE(std::distance(arr_1.begin(), it) == expect);
+		// with scratch ranges that fit everything, some of it, or just one element
+		for (size_t scratch : { 10, 4, 1 }) {
+			std::array<int, 10> arr_3 = orig, buffer{};
+			std::forward_list<int> list(orig.begin(), orig.end());
+			auto it_3 = multidim::stable_partition(arr_3.begin(), arr_3.end(), buffer.begin(), buffer.begin() + scratch, pred);
+			auto it_4 = multidim::stable_partition(list.begin(), list.end(), buffer.begin(), buffer.begin() + scratch, pred);
+			REQUIRE(arr_3 == arr_2);
+			REQUIRE(std::distance(arr_3.begin(), it_3) == expect);
+			REQUIRE(std::equal(list.begin(), list.end(), arr_2.begin()));
+			REQUIRE(std::distance(list.begin(), it_4) == expect);
+		}
 	};
 	{
 		std::array<int, 10> arr = { { 1,5,3,4,7,9,6,10,8,8 } };
@@ -0,0 +1,75 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/compare.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+#include <multidim/sorted_row_index.hpp>
+
+TEST_CASE("binary search over rows", "[2d][binary_search]") {
+	for (size_t n : { 0, 1, 2, 3, 7, 16, 100, 1000 }) {
+		multidim::dynarray<multidim::inner_array<int, 2>> arr(n);
+		std::mt19937 gen(static_cast<unsigned>(n));
+		std::uniform_int_distribution<int> dist(0, 20);
+		for (size_t i = 0; i < n; ++i) {
+			arr[i][0] = dist(gen);
+			arr[i][1] = dist(gen);
+		}
+		multidim::sort(arr.begin(), arr.end(), multidim::lex_less{});
+		multidim::array<int, 2> key;
+		for (int a = -1; a <= 21; ++a) {
+			for (int b = -1; b <= 21; b += 3) {
+				key[0] = a;
+				key[1] = b;
+				const auto lower = multidim::lower_bound(arr.begin(), arr.end(), key, multidim::lex_less{});
+				const auto upper = multidim::upper_bound(arr.begin(), arr.end(), key, multidim::lex_less{});
+				const auto count = std::count_if(arr.begin(), arr.end(), [&](const auto& row) { return row == key; });
+				REQUIRE(upper - lower == count);
+				REQUIRE(std::all_of(arr.begin(), lower, [&](const auto& row) { return multidim::lex_compare(row, key) < 0; }));
+				REQUIRE(std::all_of(upper, arr.end(), [&](const auto& row) { return multidim::lex_compare(row, key) > 0; }));
+				REQUIRE(multidim::equal_range(arr.begin(), arr.end(), key, multidim::lex_less{}) == std::make_pair(lower, upper));
+				REQUIRE(multidim::binary_search(arr.begin(), arr.end(), key, multidim::lex_less{}) == (count != 0));
+			}
+		}
+	}
+
+	// forward iterators take the branchy path
+	const std::vector<int> values{ 1, 2, 2, 2, 5, 8 };
+	REQUIRE(multidim::lower_bound(values.begin(), values.end(), 2) - values.begin() == 1);
+	REQUIRE(multidim::upper_bound(values.begin(), values.end(), 2) - values.begin() == 4);
+	REQUIRE(!multidim::binary_search(values.begin(), values.end(), 3));
+}
+
+TEST_CASE("sorted_row_index agrees with lower_bound and upper_bound", "[2d][binary_search]") {
+	for (size_t width : { 1, 3, 8, 20 }) {
+		for (size_t n : { 0, 1, 2, 5, 15, 16, 17, 1000 }) {
+			multidim::dynarray<multidim::inner_dynarray<std::uint16_t>> rows(n, width);
+			std::mt19937 gen(static_cast<unsigned>(n * 31 + width));
+			for (size_t i = 0; i != n; ++i) {
+				for (size_t j = 0; j != width; ++j) rows[i][j] = static_cast<std::uint16_t>(j + 1 < width ? gen() % 2 : gen() % 8); // long ties, so that rows are read
+			}
+			multidim::sort(rows.begin(), rows.end(), multidim::lex_less{});
+			for (size_t prefix : { size_t{ 1 }, multidim::sorted_row_index<decltype(rows.cbegin())>::default_prefix_size, width }) {
+				const multidim::sorted_row_index index(rows.cbegin(), rows.cend(), prefix);
+				REQUIRE(index.size() == n);
+				multidim::dynarray<std::uint16_t> key(width);
+				for (size_t trial = 0; trial != 200; ++trial) {
+					for (size_t j = 0; j != width; ++j) key[j] = static_cast<std::uint16_t>(j + 1 < width ? gen() % 2 : gen() % 9);
+					REQUIRE(index.lower_bound(key) == multidim::lower_bound(rows.cbegin(), rows.cend(), key, multidim::lex_less{}));
+					REQUIRE(index.upper_bound(key) == multidim::upper_bound(rows.cbegin(), rows.cend(), key, multidim::lex_less{}));
+					REQUIRE(index.contains(key) == multidim::binary_search(rows.cbegin(), rows.cend(), key, multidim::lex_less{}));
+				}
+				if (n != 0) {
+					const auto [lower, upper] = index.equal_range(rows[n / 2]);
+					REQUIRE(lower <= rows.cbegin() + static_cast<std::ptrdiff_t>(n / 2));
+					REQUIRE(upper > rows.cbegin() + static_cast<std::ptrdiff_t>(n / 2));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#include "catch.hpp"
+
+#include <cstdint>
+
+#include <multidim/dynarray.hpp>
+#include <multidim/vector.hpp>
+#include <multidim/array.hpp>
+
+TEST_CASE("dynarray with huge page buffer policies", "[2d][dynarray][buffer_policy]") {
+	constexpr size_t rows = (size_t{ 4 } << 20) / (4 * sizeof(int)); // 4 MiB
+	for (multidim::buffer_policy policy : { multidim::buffer_policy{ multidim::huge_pages::none, true }, multidim::buffer_policy{ multidim::huge_pages::transparent, false }, multidim::buffer_policy{ multidim::huge_pages::transparent, true }, multidim::buffer_policy{ multidim::huge_pages::hugetlbfs, true } }) {
+		multidim::dynarray<multidim::inner_array<int, 4>, multidim::managed_buffer> a(policy, rows);
+		REQUIRE(a.size() == rows);
+		if (policy.pages == multidim::huge_pages::transparent) REQUIRE(reinterpret_cast<std::uintptr_t>(a.data()) % (size_t{ 2 } << 20) == 0);
+		bool all_zero = true;
+		for (size_t i = 0; i < rows; i += 4093) all_zero = all_zero && a[i][0] == 0 && a[i][3] == 0;
+		REQUIRE(all_zero);
+		a[rows - 1][3] = 7;
+		const multidim::dynarray<multidim::inner_array<int, 4>, multidim::managed_buffer> b = a;
+		REQUIRE(b == a);
+		if (policy.pages == multidim::huge_pages::transparent) REQUIRE(reinterpret_cast<std::uintptr_t>(b.data()) % (size_t{ 2 } << 20) == 0);
+	}
+
+	// small buffers use the heap as usual
+	multidim::dynarray<multidim::inner_dynarray<int>, multidim::managed_buffer> small(multidim::buffer_policy{ multidim::huge_pages::transparent, true }, 3, 5);
+	REQUIRE(small.size() == 3);
+	REQUIRE(small[2][4] == 0);
+}
+
+TEST_CASE("vector keeps its buffer policy when it grows", "[2d][vector][buffer_policy]") {
+	multidim::vector<multidim::inner_dynarray<int>, multidim::default_growth, multidim::managed_buffer> v(multidim::buffer_policy{ multidim::huge_pages::transparent, false }, 4);
+	multidim::dynarray<int> row(4);
+	for (int i = 0; i < 300000; ++i) {
+		row[0] = i;
+		v.push_back(row);
+	}
+	REQUIRE(v.size() == 300000);
+	REQUIRE(v[123456][0] == 123456);
+	REQUIRE(reinterpret_cast<std::uintptr_t>(v.data()) % (size_t{ 2 } << 20) == 0);
+}
+
+TEST_CASE("containers with plain buffers hold just a pointer", "[2d][buffer_policy]") {
+	REQUIRE(sizeof(multidim::dynamic_buffer<int>) == sizeof(int*));
+	REQUIRE(sizeof(multidim::uninitialized_dynamic_buffer<int>) == sizeof(int*));
+	REQUIRE(sizeof(multidim::dynarray<int>) == sizeof(int*) + sizeof(size_t));
+	REQUIRE(sizeof(multidim::vector<int>) == sizeof(int*) + 2 * sizeof(size_t));
+}
@@ -0,0 +1,64 @@
+#include "catch.hpp"
+#include "temp_path.hpp"
+
+#include <cstdio>
+#include <string>
+
+#include <multidim/chunked_array.hpp>
+#include <multidim/array.hpp>
+#include <multidim/alg_modify.hpp>
+
+TEST_CASE("chunked_array in a single file", "[2d][chunked_array]") {
+	const std::string path = test_util::temp_path("chunked_file");
+	std::remove(path.c_str());
+	multidim::chunk_options options;
+	options.cache_chunks = 2;
+	{
+		multidim::chunked_array<multidim::inner_dynarray<int>> arr(path.c_str(), options, 100, 7, 3);
+		REQUIRE(arr.chunk_count() == 15);
+		REQUIRE(arr.read_chunk(14).size() == 2);
+		REQUIRE(arr.read(50)[1] == 0); // never written
+		for (size_t i = 0; i < arr.size(); ++i) {
+			for (size_t j = 0; j < 3; ++j) {
+				arr[i][j] = static_cast<int>(i * 10 + j);
+			}
+		}
+		// a chunk view works with the existing algorithms
+		auto c = arr.chunk(3);
+		multidim::reverse(c.begin(), c.end());
+		REQUIRE(arr[21][0] == 270);
+	}
+	{
+		multidim::chunked_array<multidim::inner_dynarray<int>> arr(path.c_str(), options, 100, 7, 3);
+		for (size_t i = 0; i < arr.size(); ++i) {
+			const size_t row = i / 7 == 3 ? 48 - i : i;
+			REQUIRE(arr.read(i)[0] == static_cast<int>(row * 10));
+			REQUIRE(arr.read(i)[2] == static_cast<int>(row * 10 + 2));
+		}
+	}
+	std::remove(path.c_str());
+}
+
+TEST_CASE("chunked_array in a directory", "[2d][chunked_array]") {
+	const std::string path = test_util::temp_path("chunked_dir");
+	multidim::chunk_options options;
+	options.storage = multidim::chunk_storage::directory;
+	options.cache_chunks = 1;
+	{
+		multidim::chunked_array<multidim::inner_array<double, 2>> arr(path.c_str(), options, 10, 4);
+		arr[9][1] = 2.5;
+		arr[0][0] = 1.5;
+		arr.flush();
+	}
+	{
+		multidim::chunked_array<multidim::inner_array<double, 2>> arr(path.c_str(), options, 10, 4);
+		REQUIRE(arr.read(9)[1] == 2.5);
+		REQUIRE(arr.read(0)[0] == 1.5);
+		REQUIRE(arr.read(5)[0] == 0);
+		REQUIRE_THROWS_AS(arr.at(10), std::out_of_range);
+	}
+	for (int i = 0; i < 3; ++i) {
+		std::remove((path + "/chunk_" + std::to_string(i)).c_str());
+	}
+	std::remove(path.c_str());
+}
@@ -0,0 +1,102 @@
+#include "catch.hpp"
+#include "temp_path.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <multidim/codec.hpp>
+#include <multidim/serialize.hpp>
+#include <multidim/chunked_array.hpp>
+
+namespace {
+	template <typename T>
+	std::vector<T> round_trip(multidim::binary_codec codec, const std::vector<T>& data, size_t& encoded_size) {
+		std::vector<unsigned char> encoded;
+		multidim::encode(codec, data.data(), data.size(), encoded);
+		encoded_size = encoded.size();
+		std::vector<T> ret(data.size());
+		multidim::decode(encoded.data(), encoded.size(), ret.data(), ret.size());
+		return ret;
+	}
+}
+
+TEST_CASE("codecs round trip", "[codec]") {
+	size_t encoded_size;
+
+	std::vector<std::int32_t> ints(1000);
+	for (size_t i = 0; i < ints.size(); ++i) ints[i] = 1000 + static_cast<std::int32_t>(i % 7) - 3 * static_cast<std::int32_t>(i % 3);
+	ints[500] = -2000000000; // an outlier only widens its own block
+	REQUIRE(round_trip(multidim::binary_codec::delta_bitpack, ints, encoded_size) == ints);
+	REQUIRE(encoded_size < ints.size() * sizeof(std::int32_t) / 3);
+	REQUIRE(round_trip(multidim::binary_codec::shuffle_lz, ints, encoded_size) == ints);
+	REQUIRE(encoded_size < ints.size() * sizeof(std::int32_t) / 3);
+
+	std::vector<std::uint8_t> bytes{ 0, 255, 1, 254, 128 };
+	REQUIRE(round_trip(multidim::binary_codec::delta_bitpack, bytes, encoded_size) == bytes);
+	std::vector<std::uint64_t> wide{ 0, ~std::uint64_t{ 0 }, 1, std::uint64_t{ 1 } << 63 };
+	REQUIRE(round_trip(multidim::binary_codec::delta_bitpack, wide, encoded_size) == wide);
+
+	std::vector<double> smooth(1000);
+	for (size_t i = 0; i < smooth.size(); ++i) smooth[i] = std::floor(std::sin(static_cast<double>(i) * 0.01) * 1000.0) / 8.0;
+	REQUIRE(round_trip(multidim::binary_codec::xor_float, smooth, encoded_size) == smooth);
+	REQUIRE(encoded_size < smooth.size() * sizeof(double) / 2);
+	REQUIRE(round_trip(multidim::binary_codec::shuffle_lz, smooth, encoded_size) == smooth);
+	std::vector<float> floats{ 0.0f, -0.0f, 1.5f, 1.5f, 3.25f, -1e30f };
+	REQUIRE(round_trip(multidim::binary_codec::xor_float, floats, encoded_size) == floats);
+
+	// incompressible data falls back to raw
+	std::vector<std::uint32_t> noise(256);
+	std::uint32_t state = 12345;
+	for (std::uint32_t& x : noise) x = state = state * 1664525u + 1013904223u;
+	REQUIRE(round_trip(multidim::binary_codec::shuffle_lz, noise, encoded_size) == noise);
+	REQUIRE(encoded_size == 1 + noise.size() * sizeof(std::uint32_t));
+
+	REQUIRE(round_trip(multidim::binary_codec::shuffle_lz, std::vector<int>{}, encoded_size).empty());
+	REQUIRE_THROWS_AS(round_trip(multidim::binary_codec::xor_float, ints, encoded_size), std::invalid_argument);
+
+	std::vector<unsigned char> encoded;
+	multidim::encode(multidim::binary_codec::shuffle_lz, ints.data(), ints.size(), encoded);
+	REQUIRE_THROWS_AS(multidim::decode(encoded.data(), encoded.size() / 2, ints.data(), ints.size()), multidim::format_error);
+	REQUIRE_THROWS_AS(multidim::decode(encoded.data(), encoded.size(), ints.data(), ints.size() - 1), multidim::format_error);
+}
+
+TEST_CASE("codecs in serialized and chunked containers", "[codec][2d]") {
+	using grid = multidim::dynarray<multidim::inner_dynarray<float>>;
+	grid g(100, 20);
+	for (size_t i = 0; i < g.size(); ++i) {
+		for (size_t j = 0; j < 20; ++j) g[i][j] = static_cast<float>(i) * 0.5f + static_cast<float>(j);
+	}
+	std::stringstream raw, packed;
+	multidim::save(raw, g);
+	multidim::save(packed, g, multidim::binary_codec::xor_float);
+	REQUIRE(packed.str().size() < raw.str().size());
+	REQUIRE(multidim::load<grid>(packed) == g);
+	REQUIRE_THROWS_AS(multidim::view<grid>(packed.str().data(), packed.str().size()), multidim::format_error);
+
+	const std::string path = test_util::temp_path("chunked_codec");
+	std::remove(path.c_str());
+	multidim::chunk_options options;
+	options.cache_chunks = 1;
+	options.codec = multidim::binary_codec::delta_bitpack;
+	{
+		multidim::chunked_array<multidim::inner_array<std::int64_t, 2>> arr(path.c_str(), options, 1000, 64);
+		for (size_t i = 0; i < arr.size(); i += 2) {
+			arr[i][0] = static_cast<std::int64_t>(i) * 3;
+			arr[i][1] = -static_cast<std::int64_t>(i);
+		}
+	}
+	{
+		multidim::chunked_array<multidim::inner_array<std::int64_t, 2>> arr(path.c_str(), options, 1000, 64);
+		for (size_t i = 0; i < arr.size(); ++i) {
+			REQUIRE(arr.read(i)[0] == (i % 2 == 0 ? static_cast<std::int64_t>(i) * 3 : 0));
+			REQUIRE(arr.read(i)[1] == (i % 2 == 0 ? -static_cast<std::int64_t>(i) : 0));
+		}
+	}
+	options.codec = multidim::binary_codec::xor_float;
+	REQUIRE_THROWS_AS((multidim::chunked_array<multidim::inner_array<std::int64_t, 2>>(path.c_str(), options, 1000, 64)), std::invalid_argument);
+	std::remove(path.c_str());
+}
@@ -0,0 +1,101 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+#include <multidim/compare.hpp>
+
+namespace {
+	template <typename T>
+	int reference_compare(const T* a, const T* b, size_t n) {
+		if (std::lexicographical_compare(a, a + n, b, b + n)) return -1;
+		if (std::lexicographical_compare(b, b + n, a, a + n)) return 1;
+		return 0;
+	}
+	int sign(int x) {
+		return (x > 0) - (x < 0);
+	}
+
+	template <typename T>
+	void check_random_rows() {
+		std::mt19937 rng(7);
+		std::uniform_int_distribution<int> value(-3, 3); // few distinct values, so that rows often share long prefixes
+		for (size_t width : { 1, 3, 15, 16, 17, 33, 64, 100 }) {
+			multidim::dynarray<multidim::inner_dynarray<T>> rows(40, width);
+			for (size_t i = 0; i != rows.size(); ++i) {
+				for (size_t j = 0; j != width; ++j) rows[i][j] = static_cast<T>(i % 4 == 0 ? 1 : value(rng));
+			}
+			for (size_t i = 0; i != rows.size(); ++i) {
+				for (size_t j = 0; j != rows.size(); ++j) {
+					const int expected = reference_compare(rows[i].data(), rows[j].data(), width);
+					REQUIRE(sign(multidim::lex_compare(rows[i], rows[j])) == expected);
+					REQUIRE(multidim::lex_less{}(rows[i], rows[j]) == (expected < 0));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("lex_compare agrees with std::lexicographical_compare", "[2d][compare]") {
+	check_random_rows<unsigned char>();
+	check_random_rows<signed char>();
+	check_random_rows<std::int32_t>();
+	check_random_rows<std::uint16_t>();
+	check_random_rows<long long>();
+	check_random_rows<double>();
+
+	// a proper prefix compares less
+	multidim::dynarray<int> shorter(3);
+	multidim::dynarray<int> longer(4);
+	REQUIRE(multidim::lex_compare(shorter, longer) < 0);
+	REQUIRE(multidim::lex_compare(longer, shorter) > 0);
+	longer[1] = -1;
+	REQUIRE(multidim::lex_compare(shorter, longer) > 0);
+}
+
+TEST_CASE("sorting rows with lex_less", "[2d][compare][sort]") {
+	multidim::dynarray<multidim::inner_array<int, 64>> rows(200);
+	std::mt19937 rng(11);
+	for (size_t i = 0; i != rows.size(); ++i) {
+		for (size_t j = 0; j != 64; ++j) rows[i][j] = j < 60 ? 5 : static_cast<int>(rng() % 7) - 3;
+	}
+	multidim::sort(rows.begin(), rows.end(), multidim::lex_less{});
+	REQUIRE(multidim::is_sorted(rows.begin(), rows.end(), multidim::lex_less{}));
+	for (size_t i = 1; i != rows.size(); ++i) REQUIRE(reference_compare(rows[i - 1].data(), rows[i].data(), 64) <= 0);
+
+#ifdef MULTIDIM_HAS_THREE_WAY_COMPARISON
+	REQUIRE(rows[0] <= rows[1]);
+	REQUIRE(std::is_eq(rows[0] <=> rows[0]));
+	multidim::sort(rows.begin(), rows.end(), [](auto a, auto b) { return b < a; });
+	REQUIRE(rows[1] <= rows[0]);
+#endif
+}
+
+#ifdef MULTIDIM_HAS_THREE_WAY_COMPARISON
+TEST_CASE("three-way comparison picks the ordering category of the base elements", "[2d][compare]") {
+	static_assert(std::is_same_v<decltype(std::declval<multidim::dynarray_const_ref<multidim::inner_dynarray<int>>>() <=> std::declval<multidim::dynarray_const_ref<multidim::inner_dynarray<int>>>()), std::strong_ordering>);
+	static_assert(std::is_same_v<decltype(std::declval<multidim::array_const_ref<multidim::inner_array<double, 2>, 3>>() <=> std::declval<multidim::array_const_ref<multidim::inner_array<double, 2>, 3>>()), std::partial_ordering>);
+
+	multidim::dynarray<multidim::inner_dynarray<double>> rows(3, 4);
+	for (size_t i = 0; i != rows.size(); ++i) {
+		for (size_t j = 0; j != 4; ++j) rows[i][j] = static_cast<double>(j);
+	}
+	rows[1][2] = std::numeric_limits<double>::quiet_NaN();
+	rows[2][3] = -1.0;
+	REQUIRE(std::is_eq(rows[0] <=> rows[0]));
+	REQUIRE((rows[0] <=> rows[1]) == std::partial_ordering::unordered);
+	REQUIRE((rows[1] <=> rows[1]) == std::partial_ordering::unordered);
+	REQUIRE(!(rows[0] < rows[1]));
+	REQUIRE(!(rows[1] < rows[0]));
+	REQUIRE(!(rows[0] >= rows[1]));
+	// the first difference decides, even if a later element is NaN
+	rows[1][1] = 5.0;
+	REQUIRE(rows[0] < rows[1]);
+	REQUIRE(rows[2] < rows[0]);
+}
+#endif
@@ -0,0 +1,67 @@
+#include "catch.hpp"
+
+#include <multidim/cow_dynarray.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+
+TEST_CASE("cow_dynarray copies on write", "[2d][cow_dynarray]") {
+	multidim::cow_dynarray<multidim::inner_dynarray<int>> a(4, 3);
+	for (size_t i = 0; i < 4; ++i) {
+		for (size_t j = 0; j < 3; ++j) a[i][j] = static_cast<int>(i * 10 + j);
+	}
+	REQUIRE(!a.shared());
+
+	const multidim::cow_dynarray<multidim::inner_dynarray<int>> snapshot = a;
+	REQUIRE(a.shared());
+	REQUIRE(snapshot.data() == static_cast<const decltype(a)&>(a).data());
+	REQUIRE(snapshot[2][1] == 21); // const access does not copy
+	REQUIRE(a.shared());
+
+	a[2][1] = -1;
+	REQUIRE(!a.shared());
+	REQUIRE(!snapshot.shared());
+	REQUIRE(a[2][1] == -1);
+	REQUIRE(snapshot[2][1] == 21);
+	REQUIRE(a[3][2] == 32);
+
+	multidim::dynarray<multidim::inner_dynarray<int>> plain(2, 3);
+	plain[1][2] = 7;
+	const multidim::cow_dynarray<multidim::inner_dynarray<int>> copied(plain);
+	REQUIRE(copied == plain);
+	REQUIRE(copied.at(1)[2] == 7);
+	REQUIRE_THROWS_AS(copied.at(2), std::out_of_range);
+}
+
+TEST_CASE("paged_cow_dynarray copies only the chunks it touches", "[2d][cow_dynarray]") {
+	multidim::dynarray<multidim::inner_array<double, 4>> plain(100);
+	for (size_t i = 0; i < plain.size(); ++i) {
+		for (size_t j = 0; j < 4; ++j) plain[i][j] = static_cast<double>(i) + static_cast<double>(j) / 4;
+	}
+	multidim::paged_cow_dynarray<multidim::inner_array<double, 4>> a(plain, 16);
+	REQUIRE(a.chunk_count() == 7);
+	REQUIRE(a.read_chunk(6).size() == 4);
+	REQUIRE(a == plain);
+
+	const auto snapshot = a;
+	for (size_t i = 0; i < a.chunk_count(); ++i) REQUIRE(a.shared(i));
+	a[40][3] = -1.0;
+	REQUIRE(!a.shared(2));
+	for (size_t i = 0; i < a.chunk_count(); ++i) {
+		if (i != 2) REQUIRE(a.shared(i));
+	}
+	REQUIRE(a.read(40)[3] == -1.0);
+	REQUIRE(snapshot[40][3] == 40.75);
+	REQUIRE(snapshot == plain);
+	REQUIRE(a != plain);
+
+	// writes through a chunk view
+	auto c = a.chunk(0);
+	c[0][0] = 5.0;
+	REQUIRE(a.read(0)[0] == 5.0);
+	REQUIRE(snapshot.read(0)[0] == 0.0);
+
+	const multidim::paged_cow_dynarray<multidim::inner_array<double, 4>> defaults(10, multidim::static_extent<multidim::unit_extent, 4>());
+	REQUIRE(defaults.chunk_rows() == 65536 / 32);
+	REQUIRE(defaults.chunk_count() == 1);
+	REQUIRE(defaults[9][3] == 0.0);
+}
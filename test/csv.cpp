@@ -0,0 +1,58 @@
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+
+#include <multidim/csv.hpp>
+
+TEST_CASE("parse_csv infers columns", "[2d][csv]") {
+	const std::string text = "a,b,c\r\n1, 2.5 ,-3\r\n\r\n+4,5e1,6\n7,8,9";
+	multidim::csv_options options;
+	options.skip_header = true;
+	const auto arr = multidim::parse_csv<multidim::dynarray<multidim::inner_dynarray<double>>>(text, options);
+	REQUIRE(arr.size() == 3);
+	REQUIRE(arr[0].size() == 3);
+	REQUIRE(arr[0][1] == 2.5);
+	REQUIRE(arr[0][2] == -3);
+	REQUIRE(arr[1][0] == 4);
+	REQUIRE(arr[1][1] == 50);
+	REQUIRE(arr[2][2] == 9);
+
+	const auto ints = multidim::parse_csv<multidim::vector<multidim::inner_array<int, 3>>>("1,2,3\n4,5,6\n7,8,9\n");
+	REQUIRE(ints.size() == 3);
+	REQUIRE(ints[2][0] == 7);
+
+	REQUIRE(multidim::parse_csv<multidim::dynarray<multidim::inner_dynarray<double>>>("").empty());
+	REQUIRE_THROWS_AS(multidim::parse_csv<multidim::dynarray<multidim::inner_dynarray<double>>>("1,2\n3\n"), multidim::format_error);
+	REQUIRE_THROWS_AS(multidim::parse_csv<multidim::dynarray<multidim::inner_dynarray<double>>>("1,2\n3,4,5\n"), multidim::format_error);
+	REQUIRE_THROWS_AS(multidim::parse_csv<multidim::dynarray<multidim::inner_dynarray<double>>>("1,2\n3,x\n"), multidim::format_error);
+	REQUIRE_THROWS_AS(multidim::parse_csv<multidim::dynarray<multidim::inner_dynarray<int>>>("1,2\n3,4.5\n"), multidim::format_error);
+}
+
+TEST_CASE("read_csv in small parallel chunks", "[2d][csv]") {
+	std::string text = "x\ty\n";
+	for (int i = 0; i < 20000; ++i) {
+		text += std::to_string(i) + '\t' + std::to_string(i * 2) + '\n';
+	}
+	text.pop_back(); // no terminator on the last line
+	multidim::csv_options options;
+	options.delimiter = '\t';
+	options.skip_header = true;
+	options.chunk_size = 9000;
+	options.threads = 3;
+	for (size_t chunk_size : { size_t{ 1 }, size_t{ 2 }, size_t{ 9000 }, size_t{ 1 } << 20 }) {
+		options.chunk_size = chunk_size;
+		std::istringstream is(text);
+		const auto vec = multidim::read_csv<multidim::vector<multidim::inner_dynarray<long>>>(is, options);
+		REQUIRE(vec.size() == 20000);
+		for (int i = 0; i < 20000; ++i) {
+			REQUIRE(vec[i][0] == i);
+			REQUIRE(vec[i][1] == i * 2);
+		}
+	}
+	REQUIRE(multidim::parse_csv<multidim::dynarray<multidim::inner_array<long, 2>>>(text, options) == multidim::parse_csv<multidim::dynarray<multidim::inner_array<long, 2>>>(text, multidim::csv_options{ '\t', true }));
+
+	text += "\n1\t2\t3\n";
+	std::istringstream is(text);
+	REQUIRE_THROWS_AS(multidim::read_csv<multidim::vector<multidim::inner_dynarray<long>>>(is, options), multidim::format_error);
+}
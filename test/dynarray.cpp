@@ -1,6 +1,7 @@
 #include "catch.hpp"
 
 #include <algorithm>
+#include <limits>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -339,3 +340,86 @@ TEST_CASE("dynarray operator== for different lengths", "[2d][dynarray][operator=
 	REQUIRE(arr != tmp2);
 	REQUIRE(arr[0] == tmp2[0]);
 }
+
+TEST_CASE("2D dynarray adopt and release", "[2d][dynarray][adopt]") {
+	int freed = 0;
+	int* const raw = new int[6]{ 0, 1, 2, 10, 11, 12 };
+	{
+		auto deleter = [&freed](int* p) { ++freed; delete[] p; };
+		using managed_dynarray = multidim::dynarray<multidim::inner_dynarray<int>, multidim::managed_buffer>;
+		managed_dynarray arr = managed_dynarray::adopt(raw, deleter, 2, 3);
+		REQUIRE(arr.data() == raw);
+		REQUIRE(arr.size() == 2);
+		REQUIRE(arr[1][2] == 12);
+
+		multidim::buffer_ptr<int> buf = arr.release();
+		REQUIRE(arr.empty());
+		REQUIRE(buf.get() == raw);
+		REQUIRE(freed == 0);
+
+		multidim::dynarray<int, multidim::managed_buffer> flat = multidim::dynarray<int, multidim::managed_buffer>::adopt(std::move(buf), 6);
+		REQUIRE(flat.data() == raw);
+		REQUIRE(flat[4] == 11);
+		REQUIRE(freed == 0);
+	}
+	REQUIRE(freed == 1);
+
+	using managed_dynarray = multidim::dynarray<multidim::inner_dynarray<int>, multidim::managed_buffer>;
+	managed_dynarray from_unique = managed_dynarray::adopt(std::make_unique<int[]>(4), 2, 2);
+	from_unique[1][1] = 5;
+	const managed_dynarray copy = from_unique;
+	REQUIRE(copy == from_unique);
+
+	// a dynarray with plain_buffer adopts and releases std::unique_ptr<T[]>
+	std::unique_ptr<int[]> plain_buf(new int[6]{ 0, 1, 2, 10, 11, 12 });
+	int* const plain_raw = plain_buf.get();
+	multidim::dynarray<multidim::inner_dynarray<int>> plain = multidim::dynarray<multidim::inner_dynarray<int>>::adopt(std::move(plain_buf), 2, 3);
+	REQUIRE(plain.data() == plain_raw);
+	REQUIRE(plain[1][2] == 12);
+	const std::unique_ptr<int[]> released = plain.release();
+	REQUIRE(plain.empty());
+	REQUIRE(released.get() == plain_raw);
+}
+
+namespace {
+	struct rgb {
+		unsigned char r, g, b;
+		friend bool operator==(const rgb& a, const rgb& b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+		friend bool operator!=(const rgb& a, const rgb& b) { return !(a == b); }
+	};
+}
+template <>
+struct multidim::is_bitwise_equality_comparable<rgb> : std::true_type {};
+
+TEST_CASE("2D dynarray equality of bitwise and non-bitwise base elements", "[2d][dynarray][operator equal]") {
+	static_assert(multidim::is_bitwise_equality_comparable_v<int>);
+	static_assert(!multidim::is_bitwise_equality_comparable_v<double>);
+	static_assert(multidim::is_bitwise_equality_comparable_v<rgb>);
+
+	multidim::dynarray<multidim::inner_dynarray<long long>> a(50, 37);
+	for (size_t i = 0; i != 50; ++i) {
+		for (size_t j = 0; j != 37; ++j) a[i][j] = static_cast<long long>(i * 100 + j);
+	}
+	multidim::dynarray<multidim::inner_dynarray<long long>> b = a;
+	REQUIRE(a == b);
+	REQUIRE(a[49] == b[49]);
+	b[49][36] = -1;
+	REQUIRE(a != b);
+	REQUIRE(a[48] == b[48]);
+	REQUIRE(a[49] != b[49]);
+
+	// floating point elements must not be compared bitwise
+	multidim::dynarray<multidim::inner_dynarray<double>> f(2, 2);
+	multidim::dynarray<multidim::inner_dynarray<double>> g(2, 2);
+	f[1][1] = -0.0;
+	REQUIRE(f == g);
+	f[0][0] = std::numeric_limits<double>::quiet_NaN();
+	g[0][0] = f[0][0];
+	REQUIRE(f != g);
+
+	multidim::dynarray<rgb> p(3);
+	multidim::dynarray<rgb> q(3);
+	REQUIRE(p == q);
+	q[2].b = 1;
+	REQUIRE(p != q);
+}
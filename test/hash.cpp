@@ -0,0 +1,62 @@
+#include "catch.hpp"
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <multidim/hash.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+#include <multidim/vector.hpp>
+
+TEST_CASE("row hashes agree with equality", "[2d][hash]") {
+	for (size_t width : { 0, 1, 3, 4, 5, 8, 9, 16, 17, 31, 32, 33, 64, 100 }) {
+		multidim::dynarray<multidim::inner_dynarray<int>> rows(40, width);
+		std::mt19937 rng(static_cast<unsigned>(width));
+		for (size_t i = 0; i != rows.size(); ++i) {
+			for (size_t j = 0; j != width; ++j) rows[i][j] = i % 2 == 0 ? static_cast<int>(rng() % 3) : static_cast<int>(rng());
+		}
+		multidim::dynarray<int> copy(width);
+		for (size_t j = 0; j != width; ++j) copy[j] = rows[7][j];
+		REQUIRE(std::hash<multidim::dynarray<int>>{}(copy) == std::hash<multidim::dynarray_const_ref<int>>{}(rows[7]));
+		REQUIRE(multidim::row_hash{}(copy) == multidim::row_hash{}(rows[7]));
+
+		std::vector<size_t> hashes(rows.size());
+		REQUIRE(multidim::hash_rows(rows.begin(), rows.end(), hashes.begin()) == hashes.end());
+		for (size_t i = 0; i != rows.size(); ++i) {
+			REQUIRE(hashes[i] == multidim::row_hash{}(rows[i]));
+			for (size_t j = 0; j != i; ++j) {
+				if (rows[i] == rows[j]) REQUIRE(hashes[i] == hashes[j]);
+			}
+		}
+	}
+
+	// floating point rows hash element-wise, so that 0.0 and -0.0 collide like they compare
+	multidim::dynarray<double> a(3);
+	multidim::dynarray<double> b(3);
+	b[1] = -0.0;
+	REQUIRE(a == b);
+	REQUIRE(multidim::row_hash{}(a) == multidim::row_hash{}(b));
+}
+
+TEST_CASE("rows as keys of unordered containers", "[2d][hash]") {
+	multidim::dynarray<multidim::inner_array<unsigned char, 12>> rows(20000);
+	std::mt19937 rng(5);
+	for (size_t i = 0; i != rows.size(); ++i) {
+		for (size_t j = 0; j != 12; ++j) rows[i][j] = static_cast<unsigned char>(j < 8 ? 0 : rng() % 16); // 65536 distinct rows, so there are duplicates
+	}
+	std::unordered_set<multidim::array<unsigned char, 12>> distinct;
+	std::unordered_set<size_t> distinct_hashes;
+	for (size_t i = 0; i != rows.size(); ++i) {
+		multidim::array<unsigned char, 12> key;
+		for (size_t j = 0; j != 12; ++j) key[j] = rows[i][j];
+		distinct.insert(key);
+		distinct_hashes.insert(multidim::row_hash{}(rows[i]));
+	}
+	REQUIRE(distinct.size() < rows.size());
+	REQUIRE(distinct_hashes.size() == distinct.size()); // no collisions among these few keys
+
+	multidim::vector<multidim::inner_dynarray<int>> v(2);
+	multidim::vector<multidim::inner_dynarray<int>> w(2);
+	REQUIRE(std::hash<multidim::vector<multidim::inner_dynarray<int>>>{}(v) == std::hash<multidim::vector<multidim::inner_dynarray<int>>>{}(w));
+}
@@ -0,0 +1,118 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+#include <multidim/vector.hpp>
+#include <multidim/row_priority_queue.hpp>
+
+TEST_CASE("heap operations on rows", "[2d][heap]") {
+	const auto comp = [](const auto& a, const auto& b) { return a[0] < b[0]; };
+	for (size_t n : { 0, 1, 2, 5, 16, 17, 100 }) {
+		multidim::vector<multidim::inner_array<int, 2>> heap;
+		std::mt19937 gen(static_cast<unsigned>(n));
+		std::uniform_int_distribution<int> dist(0, 50);
+		multidim::array<int, 2> row;
+		for (size_t i = 0; i < n; ++i) {
+			row[0] = dist(gen);
+			row[1] = static_cast<int>(i);
+			heap.push_back(row);
+			multidim::push_heap(heap.begin(), heap.end(), comp);
+			REQUIRE(multidim::is_heap(heap.begin(), heap.end(), comp));
+		}
+		// the layout is the standard one
+		std::vector<int> keys;
+		for (size_t i = 0; i < n; ++i) keys.push_back(heap[i][0]);
+		REQUIRE(std::is_heap(keys.begin(), keys.end()));
+
+		for (size_t len = n; len > 0; --len) {
+			const int greatest = heap[0][0];
+			multidim::pop_heap(heap.begin(), heap.begin() + static_cast<std::ptrdiff_t>(len), comp);
+			REQUIRE(heap[len - 1][0] == greatest);
+			REQUIRE(multidim::is_heap(heap.begin(), heap.begin() + static_cast<std::ptrdiff_t>(len - 1), comp));
+		}
+		REQUIRE(multidim::is_sorted(heap.begin(), heap.end(), comp));
+
+		const auto reversed = [&](const auto& a, const auto& b) { return comp(b, a); };
+		multidim::reverse(heap.begin(), heap.end());
+		multidim::make_heap(heap.begin(), heap.end(), reversed);
+		REQUIRE(multidim::is_heap(heap.begin(), heap.end(), reversed));
+		multidim::make_heap(heap.begin(), heap.end(), comp);
+		multidim::sort_heap(heap.begin(), heap.end(), comp);
+		REQUIRE(multidim::is_sorted(heap.begin(), heap.end(), comp));
+		// the rows were moved as a whole
+		std::vector<int> seen;
+		for (size_t i = 0; i < n; ++i) seen.push_back(heap[i][1]);
+		std::sort(seen.begin(), seen.end());
+		for (size_t i = 0; i < n; ++i) REQUIRE(seen[i] == static_cast<int>(i));
+	}
+
+	multidim::dynarray<int> ints(4);
+	ints[0] = 5;
+	ints[1] = 3;
+	ints[2] = 6;
+	ints[3] = 1;
+	REQUIRE(multidim::is_heap_until(ints.begin(), ints.end()) == ints.begin() + 2);
+}
+
+TEMPLATE_TEST_CASE_SIG("row_priority_queue", "[2d][heap]", ((size_t Arity), Arity), 2, 3, 4, 8) {
+	std::mt19937 gen(static_cast<unsigned>(Arity));
+	std::uniform_int_distribution<int> dist(-100, 100);
+	multidim::row_priority_queue<multidim::inner_dynarray<int>, multidim::lex_less, Arity> queue(3);
+	std::vector<std::vector<int>> expected;
+	multidim::dynarray<int> row(3);
+	for (size_t i = 0; i != 500; ++i) {
+		for (size_t j = 0; j != 3; ++j) row[j] = dist(gen);
+		queue.push(row);
+		expected.emplace_back(row.begin(), row.end());
+		if (i % 3 == 0) {
+			const auto greatest = std::max_element(expected.begin(), expected.end());
+			REQUIRE(std::equal(queue.top().begin(), queue.top().end(), greatest->begin()));
+			expected.erase(greatest);
+			queue.pop();
+		}
+		REQUIRE(queue.size() == expected.size());
+	}
+	queue.push(queue.top()); // pushing a row of the queue itself
+	REQUIRE(queue.size() == expected.size() + 1);
+	REQUIRE(queue.container()[0] == queue.top());
+
+	std::sort(expected.begin(), expected.end());
+	expected.push_back(expected.back());
+	while (!queue.empty()) {
+		REQUIRE(std::equal(queue.top().begin(), queue.top().end(), expected.back().begin()));
+		expected.pop_back();
+		queue.pop();
+	}
+	REQUIRE(expected.empty());
+}
+
+TEST_CASE("row_priority_queue keeps the least rows", "[2d][heap]") {
+	multidim::dynarray<multidim::inner_array<float, 4>> table(1000);
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+	for (auto row : table) {
+		for (float& x : row) x = dist(gen);
+	}
+	const auto by_score = [](const auto& a, const auto& b) { return a[0] < b[0]; };
+	multidim::row_priority_queue<multidim::inner_array<float, 4>, decltype(by_score), 4> queue(by_score);
+	for (const auto& row : table) queue.push_bounded(row, 10);
+	REQUIRE(queue.size() == 10);
+	REQUIRE(!queue.push_bounded(queue.top(), 10));
+
+	multidim::partial_sort(table.begin(), table.begin() + 10, table.end(), by_score);
+	auto rows = std::move(queue).release();
+	multidim::sort(rows.begin(), rows.end(), by_score);
+	for (size_t i = 0; i != 10; ++i) REQUIRE(rows[i] == table[i]);
+
+	// building from an existing vector
+	multidim::vector<multidim::inner_array<float, 4>> all;
+	for (const auto& row : table) all.push_back(row);
+	multidim::row_priority_queue<multidim::inner_array<float, 4>, decltype(by_score), 4> full(std::move(all), by_score);
+	REQUIRE(full.size() == 1000);
+	REQUIRE(full.top()[0] == std::max_element(table.begin(), table.end(), by_score)->operator[](0));
+}
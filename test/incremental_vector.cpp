@@ -0,0 +1,113 @@
+#include "catch.hpp"
+
+#include <vector>
+
+#include <multidim/incremental_vector.hpp>
+#include <multidim/vector.hpp>
+
+TEST_CASE("1D incremental_vector push_back and pop_back", "[1d][incremental_vector]") {
+	multidim::incremental_vector<int> arr;
+	std::vector<int> expected;
+	for (int i = 0; i < 1000; ++i) {
+		arr.push_back(i * 3);
+		expected.push_back(i * 3);
+		REQUIRE(arr.size() == expected.size());
+		REQUIRE(arr.back() == expected.back());
+		REQUIRE(arr.front() == 0);
+	}
+	REQUIRE(std::equal(arr.begin(), arr.end(), expected.begin(), expected.end()));
+	for (int i = 0; i < 600; ++i) {
+		arr.pop_back();
+		expected.pop_back();
+	}
+	REQUIRE(std::equal(arr.begin(), arr.end(), expected.begin(), expected.end()));
+	arr.push_back(arr[5]); // copying an element of the same vector
+	REQUIRE(arr.back() == 15);
+}
+
+TEST_CASE("1D incremental_vector migrates in bounded steps", "[1d][incremental_vector]") {
+	multidim::incremental_vector<int> arr;
+	for (int i = 0; i < 64; ++i) {
+		arr.push_back(i);
+	}
+	REQUIRE(arr.capacity() == 64);
+	REQUIRE(!arr.migrating());
+	arr.push_back(64); // grows the capacity, but only migrates a few elements
+	REQUIRE(arr.capacity() == 128);
+	REQUIRE(arr.migrating());
+	for (int i = 0; i <= 64; ++i) {
+		REQUIRE(arr[i] == i);
+	}
+	arr.migrate(10);
+	REQUIRE(arr.migrating());
+	for (int i = 0; i <= 64; ++i) {
+		REQUIRE(arr[i] == i);
+	}
+	arr.finish_migration();
+	REQUIRE(!arr.migrating());
+	for (int i = 0; i <= 64; ++i) {
+		REQUIRE(arr[i] == i);
+	}
+	for (int i = 65; i < 128; ++i) {
+		arr.push_back(i);
+		REQUIRE(arr.capacity() == 128);
+	}
+	REQUIRE(!arr.migrating());
+}
+
+TEST_CASE("1D incremental_vector pop_back during migration", "[1d][incremental_vector]") {
+	multidim::incremental_vector<int> arr;
+	arr.set_migration_step(0);
+	for (int i = 0; i < 5; ++i) {
+		arr.push_back(i);
+	}
+	REQUIRE(arr.migrating());
+	while (!arr.empty()) {
+		REQUIRE(arr.back() == static_cast<int>(arr.size()) - 1);
+		arr.pop_back();
+	}
+	REQUIRE(!arr.migrating());
+}
+
+TEST_CASE("2D incremental_vector", "[2d][incremental_vector]") {
+	multidim::incremental_vector<multidim::inner_dynarray<int>> arr(3);
+	multidim::vector<multidim::inner_dynarray<int>> ans(3);
+	multidim::dynarray<int> row(3);
+	for (int i = 0; i < 100; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			row[j] = i * 10 + j;
+		}
+		arr.push_back(row);
+		ans.push_back(row);
+	}
+	for (int i = 0; i < 100; ++i) {
+		REQUIRE(arr[i] == ans[i]);
+	}
+	auto copy = arr;
+	REQUIRE(copy == arr);
+	copy[4][1] = -1;
+	REQUIRE(copy != arr);
+	multidim::dynarray_const_ref<multidim::inner_dynarray<int>> ref = arr;
+	REQUIRE(!arr.migrating());
+	REQUIRE(ref == ans);
+}
+
+TEST_CASE("const incremental_vector converts to dynarray_const_ref", "[2d][incremental_vector]") {
+	multidim::incremental_vector<multidim::inner_dynarray<int>> arr(2);
+	arr.set_migration_step(0);
+	multidim::dynarray<int> row(2);
+	for (int i = 0; i < 5; ++i) {
+		row[0] = i;
+		row[1] = -i;
+		arr.push_back(row);
+	}
+	REQUIRE(arr.migrating());
+	arr.finish_migration(); // a const incremental_vector cannot finish the migration itself
+	const auto& carr = arr;
+	const multidim::dynarray_const_ref<multidim::inner_dynarray<int>> ref = carr;
+	REQUIRE(ref.size() == 5);
+	for (int i = 0; i < 5; ++i) {
+		REQUIRE(ref[i][0] == i);
+		REQUIRE(ref[i][1] == -i);
+	}
+}
@@ -1,2 +1,3 @@
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS // the bundled Catch2 uses SIGSTKSZ as a constant, which newer glibc no longer guarantees
 #include "catch.hpp"
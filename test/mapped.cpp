@@ -0,0 +1,92 @@
+#include "catch.hpp"
+#include "temp_path.hpp"
+
+#include <cstdio>
+#include <string>
+
+#include <multidim/mapped_dynarray.hpp>
+#include <multidim/mapped_vector.hpp>
+#include <multidim/array.hpp>
+
+namespace {
+	multidim::array<int, 2> make_pair(int a, int b) {
+		multidim::array<int, 2> ret;
+		ret[0] = a;
+		ret[1] = b;
+		return ret;
+	}
+}
+
+TEST_CASE("mapped_dynarray modes", "[2d][mapped]") {
+	const std::string path = test_util::temp_path("mapped_dynarray");
+	{
+		auto arr = multidim::mapped_dynarray<multidim::inner_dynarray<int>>::create(path.c_str(), 4, 3);
+		REQUIRE(arr.size() == 4);
+		REQUIRE(arr[3][2] == 0);
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 3; ++j) {
+				arr[i][j] = i * 10 + j;
+			}
+		}
+		arr.flush();
+	}
+	{
+		multidim::mapped_dynarray<multidim::inner_dynarray<int>> arr(path.c_str(), multidim::map_mode::read_only, 3);
+		REQUIRE(arr.size() == 4);
+		REQUIRE(arr.mode() == multidim::map_mode::read_only);
+		REQUIRE(arr[2][1] == 21);
+		REQUIRE_THROWS_AS(arr.at(4), std::out_of_range);
+	}
+	{
+		multidim::mapped_dynarray<multidim::inner_dynarray<int>> arr(path.c_str(), multidim::map_mode::copy_on_write, 3);
+		arr[0][0] = 42;
+		REQUIRE(arr[0][0] == 42);
+	}
+	{
+		multidim::mapped_dynarray<multidim::inner_array<int, 2>> arr(path.c_str(), multidim::map_mode::read_only);
+		REQUIRE(arr.size() == 6);
+		REQUIRE(arr[0][0] == 0); // the copy-on-write change was not written back
+		REQUIRE(arr[5][1] == 32);
+	}
+	REQUIRE_THROWS_AS(multidim::mapped_dynarray<multidim::inner_dynarray<int>>(path.c_str(), multidim::map_mode::read_only, 5), std::length_error);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("mapped_vector growth", "[2d][mapped]") {
+	const std::string path = test_util::temp_path("mapped_vector");
+	{
+		auto vec = multidim::mapped_vector<multidim::inner_array<int, 2>>::create(path.c_str());
+		REQUIRE(vec.empty());
+		for (int i = 0; i < 100; ++i) {
+			vec.push_back(make_pair(i, -i));
+		}
+		vec.push_back(vec[50]);
+		REQUIRE(vec.size() == 101);
+		REQUIRE(vec.capacity() >= 101);
+		REQUIRE(vec.back() == vec[50]);
+		vec.pop_back();
+		int i = 0;
+		for (auto&& row : vec) {
+			REQUIRE(row[0] == i);
+			REQUIRE(row[1] == -i);
+			++i;
+		}
+	}
+	{
+		// the destructor truncated the file to exactly size() elements
+		multidim::mapped_vector<multidim::inner_array<int, 2>> vec(path.c_str());
+		REQUIRE(vec.size() == 100);
+		REQUIRE(vec.capacity() == 100);
+		REQUIRE(vec[99][1] == -99);
+		vec.clear();
+		vec.push_back(make_pair(7, 8));
+		vec.shrink_to_fit();
+		REQUIRE(vec.capacity() == 1);
+	}
+	{
+		multidim::mapped_dynarray<int> arr(path.c_str(), multidim::map_mode::read_only);
+		REQUIRE(arr.size() == 2);
+		REQUIRE(arr[1] == 8);
+	}
+	std::remove(path.c_str());
+}
@@ -0,0 +1,99 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+
+namespace {
+	// rows of (key, tag); comparisons only look at the key, so that stability can be checked with the tag
+	using rows_type = multidim::dynarray<multidim::inner_array<int, 2>>;
+	const auto by_key = [](const auto& a, const auto& b) { return a[0] < b[0]; };
+
+	rows_type make_sorted_rows(size_t n, int max_key, int tag_base, unsigned seed) {
+		rows_type rows(n);
+		std::mt19937 gen(seed);
+		std::uniform_int_distribution<int> dist(0, max_key);
+		std::vector<int> keys(n);
+		for (int& k : keys) k = dist(gen);
+		std::sort(keys.begin(), keys.end());
+		for (size_t i = 0; i != n; ++i) {
+			rows[i][0] = keys[i];
+			rows[i][1] = tag_base + static_cast<int>(i);
+		}
+		return rows;
+	}
+	std::vector<std::pair<int, int>> to_pairs(const rows_type& rows) {
+		std::vector<std::pair<int, int>> ret;
+		for (const auto& row : rows) ret.emplace_back(row[0], row[1]);
+		return ret;
+	}
+	std::vector<std::pair<int, int>> expected_merge(const rows_type& a, const rows_type& b) {
+		const auto pa = to_pairs(a);
+		const auto pb = to_pairs(b);
+		std::vector<std::pair<int, int>> ret;
+		std::merge(pa.begin(), pa.end(), pb.begin(), pb.end(), std::back_inserter(ret), [](const auto& x, const auto& y) { return x.first < y.first; });
+		return ret;
+	}
+}
+
+TEST_CASE("merge and inplace_merge are stable", "[2d][merge]") {
+	for (size_t n1 : { 0, 1, 2, 7, 50, 300 }) {
+		for (size_t n2 : { 0, 1, 3, 64, 257 }) {
+			const rows_type a = make_sorted_rows(n1, 20, 0, static_cast<unsigned>(n1 * 1000 + n2));
+			const rows_type b = make_sorted_rows(n2, 20, 10000, static_cast<unsigned>(n2 * 1000 + n1));
+			const auto expected = expected_merge(a, b);
+
+			rows_type out(n1 + n2);
+			REQUIRE(multidim::merge(a.begin(), a.end(), b.begin(), b.end(), out.begin(), by_key) == out.end());
+			REQUIRE(to_pairs(out) == expected);
+
+			rows_type both(n1 + n2);
+			multidim::copy(b.begin(), b.end(), multidim::copy(a.begin(), a.end(), both.begin()));
+			for (size_t scratch : { size_t{ 0 }, size_t{ 1 }, std::min(n1, n2) / 3, std::min(n1, n2), n1 + n2 }) {
+				rows_type merged = both;
+				rows_type buffer(scratch);
+				const auto merged_middle = merged.begin() + static_cast<std::ptrdiff_t>(n1);
+				if (scratch == 0) multidim::inplace_merge(merged.begin(), merged_middle, merged.end(), by_key);
+				else multidim::inplace_merge(merged.begin(), merged_middle, merged.end(), buffer.begin(), buffer.end(), by_key);
+				REQUIRE(to_pairs(merged) == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("set operations on rows", "[2d][merge]") {
+	const auto lex = [](const auto& a, const auto& b) { return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]); };
+	multidim::dynarray<multidim::inner_array<int, 2>> a(6);
+	multidim::dynarray<multidim::inner_array<int, 2>> b(4);
+	const int av[6][2] = { { 1, 1 }, { 1, 1 }, { 2, 0 }, { 3, 5 }, { 4, 4 }, { 6, 0 } };
+	const int bv[4][2] = { { 1, 1 }, { 3, 5 }, { 5, 0 }, { 6, 0 } };
+	for (size_t i = 0; i != 6; ++i) std::copy(av[i], av[i] + 2, a[i].begin());
+	for (size_t i = 0; i != 4; ++i) std::copy(bv[i], bv[i] + 2, b[i].begin());
+
+	multidim::dynarray<multidim::inner_array<int, 2>> out(10);
+	const auto keys = [&](auto end) {
+		std::vector<int> ret;
+		for (auto it = out.begin(); it != end; ++it) ret.push_back((*it)[0]);
+		return ret;
+	};
+	REQUIRE(keys(multidim::set_union(a.begin(), a.end(), b.begin(), b.end(), out.begin(), lex)) == std::vector<int>{ 1, 1, 2, 3, 4, 5, 6 });
+	REQUIRE(keys(multidim::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out.begin(), lex)) == std::vector<int>{ 1, 3, 6 });
+	REQUIRE(keys(multidim::set_difference(a.begin(), a.end(), b.begin(), b.end(), out.begin(), lex)) == std::vector<int>{ 1, 2, 4 });
+	REQUIRE(keys(multidim::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), out.begin(), lex)) == std::vector<int>{ 1, 2, 4, 5 });
+	REQUIRE(!multidim::includes(a.begin(), a.end(), b.begin(), b.end(), lex));
+	REQUIRE(multidim::includes(a.begin(), a.end(), b.begin(), b.begin() + 2, lex));
+	REQUIRE(multidim::includes(a.begin(), a.end(), a.begin() + 1, a.end(), lex));
+
+	// plain elements with the default comparator
+	const std::vector<int> x{ 1, 2, 4 };
+	const std::vector<int> y{ 2, 3 };
+	std::vector<int> z(5);
+	REQUIRE(multidim::merge(x.begin(), x.end(), y.begin(), y.end(), z.begin()) == z.end());
+	REQUIRE(z == std::vector<int>{ 1, 2, 2, 3, 4 });
+	REQUIRE(multidim::includes(z.begin(), z.end(), x.begin(), x.end()));
+}
@@ -0,0 +1,117 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <multidim/npy.hpp>
+
+namespace {
+	std::string npy_file(const std::string& dict, const void* data, size_t size) {
+		std::string header = dict;
+		while ((10 + header.size() + 1) % 64 != 0) header += ' ';
+		header += '\n';
+		std::string ret("\x93NUMPY\x01\x00", 8);
+		ret += static_cast<char>(header.size() & 0xFF);
+		ret += static_cast<char>(header.size() >> 8);
+		ret += header;
+		ret.append(static_cast<const char*>(data), size);
+		return ret;
+	}
+}
+
+TEST_CASE("npy round trip", "[2d][npy]") {
+	using arr_t = multidim::dynarray<multidim::inner_array<std::int16_t, 3>>;
+	using wrong_static_t = multidim::dynarray<multidim::inner_array<std::int16_t, 4>>;
+	using wrong_type_t = multidim::dynarray<multidim::inner_array<std::int32_t, 3>>;
+	arr_t arr(5);
+	for (size_t i = 0; i < 5; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			arr[i][j] = static_cast<std::int16_t>(i * 10 + j);
+		}
+	}
+	std::stringstream ss;
+	multidim::save_npy(ss, arr);
+	const std::string str = ss.str();
+	const std::string dict = "{'descr': '<i2', 'fortran_order': False, 'shape': (5, 3), }";
+	REQUIRE(str.compare(10, dict.size(), dict) == 0);
+	REQUIRE((str.size() - 5 * 3 * sizeof(std::int16_t)) % 64 == 0);
+
+	REQUIRE(multidim::load_npy<arr_t>(ss) == arr);
+	ss.seekg(0);
+	REQUIRE(multidim::load_npy<multidim::vector<multidim::inner_dynarray<std::int16_t>>>(ss)[4][2] == 42);
+	ss.seekg(0);
+	REQUIRE_THROWS_AS(multidim::load_npy<wrong_static_t>(ss), multidim::format_error);
+	ss.seekg(0);
+	REQUIRE_THROWS_AS(multidim::load_npy<wrong_type_t>(ss), multidim::format_error);
+
+	std::vector<std::uint64_t> buf(str.size() / sizeof(std::uint64_t) + 1);
+	std::memcpy(buf.data(), str.data(), str.size());
+	const auto view = multidim::view_npy<arr_t>(buf.data(), str.size());
+	REQUIRE(view == arr);
+	REQUIRE_THROWS_AS(multidim::view_npy<arr_t>(buf.data(), str.size() - 1), multidim::format_error);
+
+	multidim::dynarray<double> one(3);
+	one[2] = 2.5;
+	std::stringstream ss1;
+	multidim::save_npy(ss1, one);
+	const std::string dict1 = "{'descr': '<f8', 'fortran_order': False, 'shape': (3,), }";
+	REQUIRE(ss1.str().compare(10, dict1.size(), dict1) == 0);
+	REQUIRE(multidim::load_npy<multidim::array<double, 3>>(ss1)[2] == 2.5);
+}
+
+TEST_CASE("npy fortran order", "[3d][npy]") {
+	// shape (2, 3, 4), element (i, j, k) has value i*100 + j*10 + k, stored with i varying fastest
+	std::vector<std::int32_t> data;
+	for (int k = 0; k < 4; ++k) {
+		for (int j = 0; j < 3; ++j) {
+			for (int i = 0; i < 2; ++i) {
+				data.push_back(i * 100 + j * 10 + k);
+			}
+		}
+	}
+	const std::string str = npy_file("{'descr': '<i4', 'fortran_order': True, 'shape': (2, 3, 4), }", data.data(), data.size() * sizeof(std::int32_t));
+	std::stringstream ss(str);
+	const auto arr = multidim::load_npy<multidim::array<multidim::inner_dynarray<multidim::inner_dynarray<std::int32_t>>, 2>>(ss);
+	for (int i = 0; i < 2; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			for (int k = 0; k < 4; ++k) {
+				REQUIRE(arr[i][j][k] == i * 100 + j * 10 + k);
+			}
+		}
+	}
+	std::vector<std::uint64_t> buf(str.size() / sizeof(std::uint64_t) + 1);
+	std::memcpy(buf.data(), str.data(), str.size());
+	REQUIRE_THROWS_AS(multidim::view_npy<multidim::dynarray<multidim::inner_dynarray<multidim::inner_dynarray<std::int32_t>>>>(buf.data(), str.size()), multidim::format_error);
+
+	std::stringstream bad(npy_file("{'descr': '<i4', 'fortran_order': True, 'shape': (2, 3, 4 }", data.data(), data.size() * sizeof(std::int32_t)));
+	REQUIRE_THROWS_AS(multidim::load_npy<multidim::dynarray<multidim::inner_dynarray<multidim::inner_dynarray<std::int32_t>>>>(bad), multidim::format_error);
+}
+
+TEST_CASE("npy fortran order rank 4", "[4d][npy]") {
+	// shape (2, 2, 3, 2), element (i, j, k, l) has value i*1000 + j*100 + k*10 + l, stored with i varying fastest
+	std::vector<std::int32_t> data;
+	for (int l = 0; l < 2; ++l) {
+		for (int k = 0; k < 3; ++k) {
+			for (int j = 0; j < 2; ++j) {
+				for (int i = 0; i < 2; ++i) {
+					data.push_back(i * 1000 + j * 100 + k * 10 + l);
+				}
+			}
+		}
+	}
+	std::stringstream ss(npy_file("{'descr': '<i4', 'fortran_order': True, 'shape': (2, 2, 3, 2), }", data.data(), data.size() * sizeof(std::int32_t)));
+	const auto arr = multidim::load_npy<multidim::dynarray<multidim::inner_dynarray<multidim::inner_dynarray<multidim::inner_dynarray<std::int32_t>>>>>(ss);
+	REQUIRE(arr.size() == 2);
+	for (int i = 0; i < 2; ++i) {
+		for (int j = 0; j < 2; ++j) {
+			for (int k = 0; k < 3; ++k) {
+				for (int l = 0; l < 2; ++l) {
+					REQUIRE(arr[i][j][k][l] == i * 1000 + j * 100 + k * 10 + l);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,110 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <multidim/numa.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+
+TEST_CASE("partition_rows covers every row once", "[numa]") {
+	for (size_t size : { 0, 1, 7, 64, 1001 }) {
+		for (size_t parts : { 1, 3, 4, 16 }) {
+			size_t expected = 0;
+			for (size_t i = 0; i != parts; ++i) {
+				const auto [first, last] = multidim::partition_rows(size, parts, i);
+				REQUIRE(first == expected);
+				REQUIRE(last >= first);
+				REQUIRE(last - first <= size / parts + 1);
+				expected = last;
+			}
+			REQUIRE(expected == size);
+		}
+	}
+	REQUIRE(multidim::numa_node_count() >= 1);
+}
+
+TEST_CASE("make_numa_dynarray value-initializes with every policy", "[2d][numa]") {
+	for (multidim::numa_policy policy : { multidim::numa_policy::first_touch, multidim::numa_policy::interleave, multidim::numa_policy::bind }) {
+		multidim::numa_options options;
+		options.policy = policy;
+		options.threads = 4;
+		multidim::dynarray<multidim::inner_dynarray<int>> a = multidim::make_numa_dynarray<multidim::inner_dynarray<int>>(options, 5000, 3);
+		REQUIRE(a.size() == 5000);
+		REQUIRE(a.extents().top_extent() == 3);
+		bool all_zero = true;
+		for (size_t i = 0; i != a.size(); ++i) {
+			for (size_t j = 0; j != 3; ++j) all_zero = all_zero && a[i][j] == 0;
+		}
+		REQUIRE(all_zero);
+
+		std::vector<std::atomic<int>> visits(a.size());
+		multidim::numa_parallel_for(a.size(), options, [&](size_t first, size_t last) {
+			for (size_t i = first; i != last; ++i) {
+				a[i][2] = static_cast<int>(i);
+				visits[i].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+		bool once = true;
+		for (size_t i = 0; i != a.size(); ++i) once = once && visits[i].load() == 1 && a[i][2] == static_cast<int>(i);
+		REQUIRE(once);
+	}
+
+	multidim::numa_options options;
+	options.threads = 8;
+	const multidim::dynarray<multidim::inner_array<double, 2>> small = multidim::make_numa_dynarray<multidim::inner_array<double, 2>>(options, 3);
+	REQUIRE(small.size() == 3);
+	REQUIRE(small[2][1] == 0.0);
+	const multidim::dynarray<int> empty = multidim::make_numa_dynarray<int>(options, 0);
+	REQUIRE(empty.empty());
+}
+
+TEST_CASE("make_numa_dynarray constructs non-trivial elements with every policy", "[2d][numa]") {
+	for (multidim::numa_policy policy : { multidim::numa_policy::first_touch, multidim::numa_policy::interleave, multidim::numa_policy::bind }) {
+		multidim::numa_options options;
+		options.policy = policy;
+		options.threads = 3;
+		multidim::dynarray<multidim::inner_dynarray<std::string>, multidim::managed_buffer> a = multidim::make_numa_dynarray<multidim::inner_dynarray<std::string>, multidim::managed_buffer>(options, 2000, 4);
+		REQUIRE(a.size() == 2000);
+		bool all_empty = true;
+		for (size_t i = 0; i != a.size(); ++i) {
+			for (size_t j = 0; j != 4; ++j) all_empty = all_empty && a[i][j].empty();
+		}
+		REQUIRE(all_empty);
+		a[1999][3] = std::string(100, 'x'); // destroyed by the buffer's deleter
+		REQUIRE(a[1999][3].size() == 100);
+	}
+}
+
+namespace {
+	struct limited_element {
+		static std::atomic<int> live;
+		static std::atomic<int> budget;
+		limited_element() {
+			if (--budget < 0) throw std::runtime_error("out of budget");
+			++live;
+		}
+		limited_element(const limited_element&) { ++live; }
+		~limited_element() { --live; }
+	};
+	std::atomic<int> limited_element::live{ 0 };
+	std::atomic<int> limited_element::budget{ 0 };
+}
+
+TEST_CASE("make_numa_dynarray destroys the constructed elements if a constructor throws", "[2d][numa]") {
+	multidim::numa_options options;
+	options.threads = 4;
+	const auto make = [&options]() { return multidim::make_numa_dynarray<multidim::inner_array<limited_element, 4>, multidim::managed_buffer>(options, 2000); };
+	limited_element::live = 0;
+	limited_element::budget = 5000; // enough for some of the row ranges, but not all of them
+	REQUIRE_THROWS_AS(make(), std::runtime_error);
+	REQUIRE(limited_element::live == 0);
+	limited_element::budget = 8000;
+	{
+		const auto a = make();
+		REQUIRE(limited_element::live == 8000);
+	}
+	REQUIRE(limited_element::live == 0);
+}
@@ -0,0 +1,70 @@
+#include "catch.hpp"
+
+#include <multidim/pitched_vector.hpp>
+#include <multidim/array.hpp>
+
+TEST_CASE("pitched_vector push_back and resize_inner", "[2d][pitched_vector]") {
+	multidim::pitched_vector<int> arr(3);
+	REQUIRE(arr.inner_size() == 3);
+	REQUIRE(arr.inner_capacity() == 3);
+	multidim::dynarray<int> row(3);
+	for (int i = 0; i < 20; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			row[j] = i * 10 + j;
+		}
+		arr.push_back(row);
+	}
+	arr.push_back(arr[7]);
+	REQUIRE(arr.size() == 21);
+	REQUIRE(arr.back() == arr[7]);
+	arr.pop_back();
+
+	arr.resize_inner(4); // reallocates
+	REQUIRE(arr.inner_size() == 4);
+	REQUIRE(arr.inner_capacity() == 6);
+	for (int i = 0; i < 20; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			REQUIRE(arr[i][j] == i * 10 + j);
+		}
+		REQUIRE(arr[i][3] == 0);
+		arr[i][3] = i * 10 + 3;
+	}
+
+	arr.resize_inner(6); // fits in the pitch
+	REQUIRE(arr.inner_capacity() == 6);
+	REQUIRE(arr[19][3] == 193);
+	REQUIRE(arr[19][5] == 0);
+
+	arr.resize_inner(2);
+	REQUIRE(arr.inner_capacity() == 6);
+	int i = 0;
+	for (auto r : arr) {
+		REQUIRE(r.size() == 2);
+		REQUIRE(r[0] == i * 10);
+		REQUIRE(r[1] == i * 10 + 1);
+		++i;
+	}
+	REQUIRE(i == 20);
+
+	auto copy = arr;
+	REQUIRE(copy == arr);
+	copy.shrink_to_fit();
+	REQUIRE(copy.inner_capacity() == 2);
+	REQUIRE(copy == arr);
+	copy[3][1] = -1;
+	REQUIRE(copy != arr);
+}
+
+TEST_CASE("pitched_vector of inner arrays", "[3d][pitched_vector]") {
+	multidim::pitched_vector<multidim::inner_array<int, 2>> arr(1);
+	multidim::dynarray<multidim::inner_array<int, 2>> row(1);
+	row[0][0] = 4;
+	row[0][1] = 5;
+	arr.push_back(row);
+	arr.push_back(row);
+	arr.reserve_inner(8);
+	REQUIRE(arr.inner_capacity() == 8);
+	arr.resize_inner(3);
+	REQUIRE(arr[1][0][1] == 5);
+	REQUIRE(arr[1][2][1] == 0);
+}
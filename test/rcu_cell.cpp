@@ -0,0 +1,70 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <multidim/rcu_cell.hpp>
+#include <multidim/dynarray.hpp>
+
+namespace {
+	using table = multidim::dynarray<multidim::inner_dynarray<std::int32_t>>;
+	table make_table(std::int32_t version) {
+		table ret(64, 8);
+		for (size_t i = 0; i < ret.size(); ++i) {
+			for (size_t j = 0; j < 8; ++j) ret[i][j] = version;
+		}
+		return ret;
+	}
+}
+
+TEST_CASE("rcu_cell keeps pinned versions alive", "[rcu_cell]") {
+	multidim::rcu_cell<table> cell(make_table(0));
+	{
+		const auto pinned = cell.read();
+		cell.publish(make_table(1));
+		cell.publish(make_table(2));
+		REQUIRE(cell.retired() == 2);
+		REQUIRE((*pinned)[63][7] == 0);
+		REQUIRE((*cell.read())[0][0] == 2);
+	}
+	cell.reclaim();
+	REQUIRE(cell.retired() == 0);
+
+	auto moved = cell.read();
+	cell.publish(make_table(3));
+	const auto other = std::move(moved);
+	REQUIRE((*other)[0][0] == 2);
+	REQUIRE(cell.retired() == 1);
+}
+
+TEST_CASE("rcu_cell with concurrent readers", "[rcu_cell]") {
+	multidim::rcu_cell<table> cell(make_table(0));
+	std::atomic<bool> done{ false };
+	std::atomic<bool> torn{ false };
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 4; ++t) {
+		readers.emplace_back([&]() {
+			std::int32_t last = 0;
+			while (!done.load(std::memory_order_relaxed)) {
+				const auto ref = cell.read();
+				const std::int32_t version = (*ref)[0][0];
+				for (size_t i = 0; i < ref->size(); ++i) {
+					for (size_t j = 0; j < 8; ++j) {
+						if ((*ref)[i][j] != version) torn = true;
+					}
+				}
+				if (version < last) torn = true; // versions only move forwards
+				last = version;
+			}
+		});
+	}
+	for (std::int32_t v = 1; v <= 2000; ++v) cell.publish(make_table(v));
+	done = true;
+	for (std::thread& reader : readers) reader.join();
+	cell.synchronize();
+	REQUIRE(!torn);
+	REQUIRE(cell.retired() == 0);
+	REQUIRE((*cell.read())[5][5] == 2000);
+}
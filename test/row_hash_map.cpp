@@ -0,0 +1,172 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <multidim/row_hash_map.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+
+TEST_CASE("row_hash_map agrees with std::map", "[2d][hash]") {
+	using map_t = multidim::row_hash_map<multidim::inner_dynarray<int>, size_t>;
+	for (size_t width : { 1, 3, 8, 17 }) {
+		map_t map(width);
+		std::map<std::vector<int>, size_t> expected;
+		std::mt19937 rng(static_cast<unsigned>(width));
+		multidim::dynarray<int> key(width);
+		for (size_t step = 0; step != 5000; ++step) {
+			std::vector<int> k(width);
+			for (size_t j = 0; j != width; ++j) key[j] = k[j] = static_cast<int>(rng() % 4);
+			switch (rng() % 3) {
+			case 0: {
+				const auto [it, inserted] = map.try_emplace(key, step);
+				const bool expected_inserted = expected.try_emplace(k, step).second;
+				REQUIRE(inserted == expected_inserted);
+				REQUIRE((*it).first == key);
+				REQUIRE((*it).second == expected[k]);
+				break;
+			}
+			case 1:
+				REQUIRE(map.erase(key) == expected.erase(k));
+				break;
+			default:
+				REQUIRE(map.contains(key) == (expected.count(k) != 0));
+				if (map.contains(key)) REQUIRE(map.at(key) == expected[k]);
+				else REQUIRE(map.find(key) == map.end());
+			}
+			REQUIRE(map.size() == expected.size());
+		}
+		size_t visited = 0;
+		for (const auto& [k, v] : map) {
+			REQUIRE(expected.at(std::vector<int>(k.begin(), k.end())) == v);
+			++visited;
+		}
+		REQUIRE(visited == expected.size());
+		REQUIRE(map.keys().size() == map.values().size());
+	}
+}
+
+TEST_CASE("row_hash_map grows and reuses deleted slots", "[2d][hash]") {
+	multidim::row_hash_map<multidim::inner_array<std::uint8_t, 32>, std::string> map;
+	multidim::array<std::uint8_t, 32> key{};
+	for (unsigned i = 0; i != 1000; ++i) {
+		key[0] = static_cast<std::uint8_t>(i);
+		key[31] = static_cast<std::uint8_t>(i >> 8);
+		map[key] = std::to_string(i);
+	}
+	REQUIRE(map.size() == 1000);
+	REQUIRE(map.bucket_count() * 7 / 8 >= 1000);
+	const size_t buckets = map.bucket_count();
+	for (unsigned round = 0; round != 20; ++round) {
+		for (unsigned i = 0; i != 1000; i += 2) {
+			key[0] = static_cast<std::uint8_t>(i);
+			key[31] = static_cast<std::uint8_t>(i >> 8);
+			REQUIRE(map.erase(key) == 1);
+		}
+		for (unsigned i = 0; i != 1000; i += 2) {
+			key[0] = static_cast<std::uint8_t>(i);
+			key[31] = static_cast<std::uint8_t>(i >> 8);
+			REQUIRE(map.try_emplace(key, std::to_string(i)).second);
+		}
+	}
+	REQUIRE(map.bucket_count() == buckets); // tombstones are cleaned up in place rather than growing the table
+	for (unsigned i = 0; i != 1000; ++i) {
+		key[0] = static_cast<std::uint8_t>(i);
+		key[31] = static_cast<std::uint8_t>(i >> 8);
+		REQUIRE(map.at(key) == std::to_string(i));
+	}
+	key[0] = 0;
+	key[31] = 200;
+	REQUIRE_THROWS_AS(map.at(key), std::out_of_range);
+	map.clear();
+	REQUIRE(map.empty());
+	REQUIRE(map.begin() == map.end());
+}
+
+namespace {
+	struct counted_value {
+		static inline size_t moves = 0;
+		int value = 0;
+		counted_value() = default;
+		counted_value(counted_value&& other) noexcept : value(other.value) { ++moves; }
+		counted_value& operator=(counted_value&& other) noexcept { value = other.value; ++moves; return *this; }
+	};
+}
+
+TEST_CASE("row_hash_map grows its values geometrically without reserve()", "[2d][hash]") {
+	multidim::row_hash_map<multidim::inner_array<unsigned, 2>, counted_value> map;
+	multidim::array<unsigned, 2> key{};
+	constexpr unsigned count = 50000;
+	counted_value::moves = 0;
+	for (unsigned i = 0; i != count; ++i) {
+		key[0] = i;
+		key[1] = ~i;
+		map[key].value = static_cast<int>(i);
+	}
+	REQUIRE(map.size() == count);
+	REQUIRE(counted_value::moves < 2 * count); // reallocating for every insert would move O(count^2) values
+	for (unsigned i = 0; i < count; i += 997) {
+		key[0] = i;
+		key[1] = ~i;
+		REQUIRE(map.at(key).value == static_cast<int>(i));
+	}
+}
+
+namespace {
+	struct throwing_value {
+		int value;
+		explicit throwing_value(int v) : value(v) {
+			if (v < 0) throw std::invalid_argument("negative");
+		}
+	};
+}
+
+TEST_CASE("row_hash_map try_emplace keeps keys and values in step when the value throws", "[2d][hash]") {
+	multidim::row_hash_map<multidim::inner_array<int, 2>, throwing_value> map;
+	multidim::array<int, 2> key{};
+	for (int i = 1; i <= 100; ++i) {
+		key[0] = i;
+		key[1] = -i;
+		REQUIRE(map.try_emplace(key, i).second);
+		key[1] = i;
+		REQUIRE_THROWS_AS(map.try_emplace(key, -1), std::invalid_argument);
+	}
+	REQUIRE(map.size() == 100);
+	REQUIRE(map.values().size() == 100);
+	for (int i = 1; i <= 100; ++i) {
+		key[0] = i;
+		key[1] = i;
+		REQUIRE(map.find(key) == map.end());
+		REQUIRE(map.try_emplace(key, 1000 + i).second);
+		key[1] = -i;
+		REQUIRE(map.at(key).value == i);
+	}
+	for (const auto& [k, v] : map) {
+		REQUIRE(v.value == (k[0] == k[1] ? 1000 + k[0] : k[0]));
+	}
+}
+
+TEST_CASE("row_hash_set deduplicates rows", "[2d][hash]") {
+	multidim::dynarray<multidim::inner_dynarray<int>> rows(100, 5);
+	for (size_t i = 0; i != rows.size(); ++i) {
+		for (size_t j = 0; j != 5; ++j) rows[i][j] = static_cast<int>((i % 7) * j);
+	}
+	multidim::row_hash_set<multidim::inner_dynarray<int>> set(5);
+	set.reserve(7);
+	const size_t buckets = set.bucket_count();
+	for (const auto& row : rows) set.insert(row);
+	REQUIRE(set.size() == 7);
+	REQUIRE(set.bucket_count() == buckets);
+	REQUIRE(*set.find(rows[3]) == rows[3]);
+	REQUIRE(set.count(rows[10]) == 1);
+	REQUIRE(set.erase(rows[0]) == 1);
+	REQUIRE(set.erase(rows[7]) == 0);
+	REQUIRE(set.size() == 6);
+	for (size_t i = 1; i != 7; ++i) REQUIRE(set.contains(rows[i]));
+	REQUIRE(!set.insert(rows[8]).second);
+	REQUIRE(set.insert(rows[14]).second);
+}
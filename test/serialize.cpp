@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <multidim/serialize.hpp>
+
+TEST_CASE("save and load round trip", "[2d][serialize]") {
+	using arr_t = multidim::dynarray<multidim::inner_array<multidim::inner_dynarray<int>, 3>>;
+	using wrong_static_t = multidim::dynarray<multidim::inner_array<multidim::inner_dynarray<int>, 2>>;
+	using wrong_type_t = multidim::dynarray<multidim::inner_array<multidim::inner_dynarray<float>, 3>>;
+	using wrong_rank_t = multidim::dynarray<multidim::inner_dynarray<int>>;
+	arr_t arr(4, 5);
+	for (size_t i = 0; i < 4; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			for (size_t k = 0; k < 5; ++k) {
+				arr[i][j][k] = static_cast<int>(i * 100 + j * 10 + k);
+			}
+		}
+	}
+	std::stringstream ss;
+	multidim::save(ss, arr);
+	REQUIRE(ss.str().size() == multidim::serialized_size(arr));
+	REQUIRE(ss.str().size() % multidim::binary_alignment == 0);
+
+	const auto loaded = multidim::load<arr_t>(ss);
+	REQUIRE(loaded.size() == 4);
+	REQUIRE(loaded == arr);
+
+	ss.seekg(0);
+	const auto vec = multidim::load<multidim::vector<multidim::inner_array<multidim::inner_dynarray<int>, 3>>>(ss);
+	REQUIRE(vec.size() == 4);
+	REQUIRE(vec[3][2][4] == 324);
+
+	ss.seekg(0);
+	REQUIRE_THROWS_AS(multidim::load<wrong_static_t>(ss), multidim::format_error);
+	ss.seekg(0);
+	REQUIRE_THROWS_AS(multidim::load<wrong_type_t>(ss), multidim::format_error);
+	ss.seekg(0);
+	REQUIRE_THROWS_AS(multidim::load<wrong_rank_t>(ss), multidim::format_error);
+
+	std::stringstream truncated(ss.str().substr(0, 100));
+	REQUIRE_THROWS_AS(multidim::load<arr_t>(truncated), multidim::format_error);
+}
+
+TEST_CASE("view serialized array without copying", "[2d][serialize]") {
+	using arr_t = multidim::array<multidim::inner_dynarray<double>, 2>;
+	using wrong_static_t = multidim::array<multidim::inner_dynarray<double>, 3>;
+	arr_t arr(3);
+	for (size_t i = 0; i < 2; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			arr[i][j] = static_cast<double>(i) + static_cast<double>(j) / 4;
+		}
+	}
+	std::stringstream ss;
+	multidim::save(ss, arr);
+	const std::string str = ss.str();
+	std::vector<std::uint64_t> buf(str.size() / sizeof(std::uint64_t));
+	std::memcpy(buf.data(), str.data(), str.size());
+
+	const multidim::array_const_ref<multidim::inner_dynarray<double>, 2> view = multidim::view<arr_t>(buf.data(), str.size());
+	REQUIRE(view.data() == reinterpret_cast<const double*>(reinterpret_cast<const char*>(buf.data()) + 2 * multidim::binary_alignment)); // header and two extent entries, padded
+	REQUIRE(view == arr);
+	REQUIRE(view[1][2] == 1.5);
+
+	REQUIRE_THROWS_AS(multidim::view<arr_t>(buf.data(), str.size() - 64), multidim::format_error);
+	REQUIRE_THROWS_AS(multidim::view<wrong_static_t>(buf.data(), str.size()), multidim::format_error);
+}
@@ -0,0 +1,95 @@
+#include "catch.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <multidim/shared_dynarray.hpp>
+#include <multidim/shared_vector.hpp>
+#include <multidim/array.hpp>
+
+TEST_CASE("shared_dynarray attached from another process", "[2d][shared_memory]") {
+	using narrow_view = multidim::shared_view<multidim::inner_array<float, 64>>;
+	using double_view = multidim::shared_view<multidim::inner_array<double, 128>>;
+	using float_view = multidim::shared_view<multidim::inner_array<float, 128>>;
+	const char* const name = "/multidim_test_shared_dynarray";
+	auto table = multidim::shared_dynarray<multidim::inner_array<float, 128>>::create(name, 100);
+	for (size_t i = 0; i < table.size(); ++i) {
+		for (size_t j = 0; j < 128; ++j) table[i][j] = static_cast<float>(i) + static_cast<float>(j) / 128.0f;
+	}
+
+	const pid_t pid = ::fork();
+	REQUIRE(pid != -1);
+	if (pid == 0) {
+		int status = 0;
+		try {
+			const multidim::shared_view<multidim::inner_array<float, 128>> view(name);
+			const multidim::dynarray_const_ref<multidim::inner_array<float, 128>> ref = view;
+			if (ref.size() != 100 || ref[42][64] != 42.5f) status = 1;
+		}
+		catch (...) {
+			status = 2;
+		}
+		::_exit(status);
+	}
+	int status;
+	REQUIRE(::waitpid(pid, &status, 0) == pid);
+	REQUIRE(WIFEXITED(status));
+	REQUIRE(WEXITSTATUS(status) == 0);
+
+	REQUIRE_THROWS_AS(narrow_view(name), std::invalid_argument);
+	REQUIRE_THROWS_AS(double_view(name), std::invalid_argument);
+	multidim::shared_segment::remove(name);
+	REQUIRE_THROWS_AS(float_view(name), std::system_error);
+}
+
+TEST_CASE("shared_vector growth is seen by views", "[2d][shared_memory]") {
+	const char* const name = "/multidim_test_shared_vector";
+	auto vec = multidim::shared_vector<multidim::inner_dynarray<int>>::create(name, 3);
+	multidim::shared_view<multidim::inner_dynarray<int>> view(name, 3);
+	REQUIRE(view.empty());
+	REQUIRE(!view.refresh());
+
+	multidim::dynarray<int> row(3);
+	for (int i = 0; i < 100; ++i) {
+		row[0] = i;
+		row[1] = -i;
+		row[2] = i * i;
+		vec.push_back(row);
+	}
+	vec.push_back(vec[10]); // self-reference across growth
+	REQUIRE(vec.generation() > 0);
+
+	REQUIRE(view.size() == 0);
+	REQUIRE(view.refresh());
+	REQUIRE(view.generation() == vec.generation());
+	REQUIRE(view.size() == 101);
+	REQUIRE(view[99][2] == 99 * 99);
+	REQUIRE(view[100][1] == -10);
+	REQUIRE(view == static_cast<multidim::dynarray_const_ref<multidim::inner_dynarray<int>>>(vec));
+
+	REQUIRE(view.consistent());
+	vec.pop_back();
+	REQUIRE(!view.consistent()); // the writer may now write row 100 again
+	REQUIRE(view.refresh());
+	REQUIRE(view.size() == 100);
+	REQUIRE(view.consistent());
+	REQUIRE(!view.refresh());
+	vec.clear();
+	vec.push_back(row);
+	REQUIRE(!view.consistent());
+	REQUIRE(view.refresh());
+	REQUIRE(view.size() == 1);
+	REQUIRE(view[0][2] == 99 * 99);
+	REQUIRE(view.consistent());
+	vec.push_back(row);
+	vec.push_back(row);
+	REQUIRE(view.consistent()); // appending does not overwrite anything the view has seen
+	REQUIRE(view.refresh());
+	REQUIRE(view.size() == 3);
+
+	// a new writer picks up where the old one stopped
+	multidim::shared_vector<multidim::inner_dynarray<int>> reopened(name, 3);
+	REQUIRE(reopened.size() == 3);
+	REQUIRE(reopened.capacity() >= 100);
+	multidim::shared_segment::remove(name);
+}
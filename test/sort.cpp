@@ -0,0 +1,171 @@
+#include "catch.hpp"
+#include "temp_path.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+#include <multidim/external_sort.hpp>
+
+namespace {
+	template <typename X>
+	X load_file(const std::string& path) {
+		std::ifstream ifs(path, std::ios::binary);
+		return multidim::load<X>(ifs);
+	}
+}
+
+TEST_CASE("sort rows with a comparator", "[2d][sort]") {
+	for (size_t n : { 0, 1, 5, 16, 17, 100, 1000 }) {
+		multidim::dynarray<multidim::inner_array<int, 2>> arr(n);
+		std::mt19937 gen(static_cast<unsigned>(n));
+		std::uniform_int_distribution<int> dist(0, 50);
+		for (size_t i = 0; i < n; ++i) {
+			arr[i][0] = dist(gen);
+			arr[i][1] = static_cast<int>(i);
+		}
+		const auto comp = [](const auto& a, const auto& b) { return a[0] < b[0]; };
+		multidim::sort(arr.begin(), arr.end(), comp);
+		REQUIRE(multidim::is_sorted(arr.begin(), arr.end(), comp));
+		// the rows were moved as a whole
+		std::vector<int> seen;
+		for (size_t i = 0; i < n; ++i) seen.push_back(arr[i][1]);
+		std::sort(seen.begin(), seen.end());
+		for (size_t i = 0; i < n; ++i) REQUIRE(seen[i] == static_cast<int>(i));
+	}
+
+	// already sorted and reversed input (the worst cases for a naive quicksort)
+	multidim::dynarray<int> ints(5000);
+	for (size_t i = 0; i < ints.size(); ++i) ints[i] = static_cast<int>(ints.size() - i);
+	multidim::sort(ints.begin(), ints.end());
+	REQUIRE(multidim::is_sorted(ints.begin(), ints.end()));
+	multidim::sort(ints.begin(), ints.end());
+	REQUIRE(ints.front() == 1);
+	REQUIRE(ints.back() == 5000);
+	REQUIRE(multidim::is_sorted_until(ints.begin(), ints.end(), std::greater<>()) == ints.begin() + 1);
+}
+
+TEST_CASE("select rows with a comparator", "[2d][sort]") {
+	const auto comp = [](const auto& a, const auto& b) { return a[0] < b[0]; };
+	for (size_t n : { 1, 2, 5, 16, 17, 100, 1000 }) {
+		multidim::dynarray<multidim::inner_array<int, 2>> arr(n);
+		std::mt19937 gen(static_cast<unsigned>(n));
+		std::uniform_int_distribution<int> dist(0, 50);
+		for (size_t i = 0; i < n; ++i) {
+			arr[i][0] = dist(gen);
+			arr[i][1] = static_cast<int>(i);
+		}
+		std::vector<int> sorted;
+		for (size_t i = 0; i < n; ++i) sorted.push_back(arr[i][0]);
+		std::sort(sorted.begin(), sorted.end());
+
+		for (size_t k : { size_t{ 0 }, n / 3, n - 1 }) {
+			multidim::dynarray<multidim::inner_array<int, 2>> sel = arr;
+			multidim::nth_element(sel.begin(), sel.begin() + static_cast<std::ptrdiff_t>(k), sel.end(), comp);
+			REQUIRE(sel[k][0] == sorted[k]);
+			for (size_t i = 0; i < k; ++i) REQUIRE(sel[i][0] <= sel[k][0]);
+			for (size_t i = k; i < n; ++i) REQUIRE(sel[i][0] >= sel[k][0]);
+			// the rows were moved as a whole
+			std::vector<int> seen;
+			for (size_t i = 0; i < n; ++i) seen.push_back(sel[i][1]);
+			std::sort(seen.begin(), seen.end());
+			for (size_t i = 0; i < n; ++i) REQUIRE(seen[i] == static_cast<int>(i));
+
+			multidim::dynarray<multidim::inner_array<int, 2>> part = arr;
+			multidim::partial_sort(part.begin(), part.begin() + static_cast<std::ptrdiff_t>(k), part.end(), comp);
+			for (size_t i = 0; i < k; ++i) REQUIRE(part[i][0] == sorted[i]);
+
+			multidim::dynarray<multidim::inner_array<int, 2>> out(k);
+			REQUIRE(multidim::partial_sort_copy(arr.cbegin(), arr.cend(), out.begin(), out.end(), comp) == out.end());
+			for (size_t i = 0; i < k; ++i) REQUIRE(out[i][0] == sorted[i]);
+		}
+
+		// more room in the output than there are input elements
+		multidim::dynarray<multidim::inner_array<int, 2>> big(n + 3);
+		REQUIRE(multidim::partial_sort_copy(arr.cbegin(), arr.cend(), big.begin(), big.end(), comp) == big.begin() + static_cast<std::ptrdiff_t>(n));
+		for (size_t i = 0; i < n; ++i) REQUIRE(big[i][0] == sorted[i]);
+	}
+
+	// sorted input with many duplicates
+	multidim::dynarray<int> ints(5000);
+	for (size_t i = 0; i < ints.size(); ++i) ints[i] = static_cast<int>(i / 10);
+	multidim::nth_element(ints.begin(), ints.begin() + 2500, ints.end(), std::greater<>());
+	REQUIRE(ints[2500] == 249);
+}
+
+TEST_CASE("stable_sort rows", "[2d][sort]") {
+	const auto comp = [](const auto& a, const auto& b) { return a[0] < b[0]; };
+	for (size_t n : { 0, 1, 5, 16, 17, 100, 1000 }) {
+		multidim::dynarray<multidim::inner_array<int, 2>> arr(n);
+		std::mt19937 gen(static_cast<unsigned>(n));
+		std::uniform_int_distribution<int> dist(0, 20);
+		for (size_t i = 0; i < n; ++i) {
+			arr[i][0] = dist(gen);
+			arr[i][1] = static_cast<int>(i);
+		}
+		std::vector<std::pair<int, int>> expected;
+		for (size_t i = 0; i < n; ++i) expected.emplace_back(arr[i][0], arr[i][1]);
+		std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+		for (size_t scratch : { size_t{ 0 }, size_t{ 3 }, n / 2, n }) {
+			multidim::dynarray<multidim::inner_array<int, 2>> sorted = arr;
+			multidim::dynarray<multidim::inner_array<int, 2>> buffer(scratch);
+			if (scratch == 0) multidim::stable_sort(sorted.begin(), sorted.end(), comp);
+			else multidim::stable_sort(sorted.begin(), sorted.end(), buffer.begin(), buffer.end(), comp);
+			for (size_t i = 0; i < n; ++i) {
+				REQUIRE(sorted[i][0] == expected[i].first);
+				REQUIRE(sorted[i][1] == expected[i].second);
+			}
+		}
+	}
+
+	std::vector<int> ints{ 5, 1, 4, 1, 3 };
+	std::vector<int> buffer(2);
+	multidim::stable_sort(ints.begin(), ints.end(), buffer.begin(), buffer.end());
+	REQUIRE(ints == std::vector<int>{ 1, 1, 3, 4, 5 });
+}
+
+TEST_CASE("external_sort", "[2d][sort]") {
+	const std::string path = test_util::temp_path("external_sort");
+	const auto comp = [](const auto& a, const auto& b) { return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]); };
+
+	multidim::dynarray<multidim::inner_dynarray<int>> input(10000, 3);
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<int> dist(-1000, 1000);
+	for (size_t i = 0; i < input.size(); ++i) {
+		input[i][0] = dist(gen);
+		input[i][1] = dist(gen);
+		input[i][2] = static_cast<int>(i);
+	}
+
+	// many runs, so that there are several merge passes
+	multidim::external_sort<multidim::inner_dynarray<int>>(input.begin(), input.end(), path.c_str(), 16384, comp);
+	auto output = load_file<multidim::dynarray<multidim::inner_dynarray<int>>>(path);
+	REQUIRE(output.size() == input.size());
+	REQUIRE(multidim::is_sorted(output.begin(), output.end(), comp));
+	multidim::sort(input.begin(), input.end(), comp);
+	for (size_t i = 0; i < input.size(); ++i) {
+		REQUIRE(output[i][0] == input[i][0]);
+		REQUIRE(output[i][1] == input[i][1]);
+	}
+	std::ifstream run(path + ".run0");
+	REQUIRE(!run); // temporary files were removed
+
+	// everything fits in memory
+	multidim::external_sort<multidim::inner_dynarray<int>>(input.rbegin(), input.rend(), path.c_str(), size_t{ 1 } << 20, comp);
+	output = load_file<multidim::dynarray<multidim::inner_dynarray<int>>>(path);
+	REQUIRE(output.size() == input.size());
+	REQUIRE(multidim::is_sorted(output.begin(), output.end(), comp));
+
+	// empty input
+	multidim::external_sort<multidim::inner_dynarray<int>>(input.end(), input.end(), path.c_str(), 1024, comp);
+	REQUIRE(load_file<multidim::dynarray<multidim::inner_dynarray<int>>>(path).size() == 0);
+
+	std::remove(path.c_str());
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio> // for P_tmpdir
+#include <string>
+
+#include <unistd.h> // for getpid()
+
+namespace test_util {
+	/**
+	 * Gets a path in the temporary directory that no other call returns, even from test runs in other processes, e.g. "/tmp/multidim_test_mapped_vector_1234_0".
+	 */
+	inline std::string temp_path(const char* name) {
+		static std::atomic<unsigned> counter{ 0 };
+		return std::string(P_tmpdir) + "/multidim_test_" + name + "_" + std::to_string(::getpid()) + "_" + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+	}
+}
@@ -0,0 +1,117 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <multidim/algorithm.hpp>
+#include <multidim/dynarray.hpp>
+#include <multidim/array.hpp>
+#include <multidim/vector.hpp>
+#include <multidim/temporary_row.hpp>
+
+TEST_CASE("temporary_row holds a copy of a row", "[2d][temporary_row]") {
+	multidim::dynarray<multidim::inner_dynarray<int>> grid(3, 4);
+	for (size_t i = 0; i != 3; ++i) {
+		for (size_t j = 0; j != 4; ++j) grid[i][j] = static_cast<int>(i * 10 + j);
+	}
+	{
+		auto tmp = multidim::make_temporary_row(grid[1]);
+		REQUIRE(tmp.cref() == grid[1]);
+		grid[1] = grid[2];
+		REQUIRE(tmp.cref()[0] == 10);
+		multidim::temporary_row<multidim::inner_dynarray<int>> zeros(multidim::dynamic_extent<multidim::unit_extent>(4));
+		REQUIRE(zeros.cref()[3] == 0);
+		zeros = grid[0];
+		REQUIRE(zeros.cref() == grid[0]);
+		grid[2] = tmp;
+		REQUIRE(grid[2][3] == 13);
+	}
+
+	// fixed-size rows, including ones too large for the arena
+	multidim::dynarray<multidim::inner_array<std::uint8_t, 100000>> big(2);
+	big[0][99999] = 7;
+	{
+		auto small = multidim::make_temporary_row(grid[0]);
+		auto tmp = multidim::make_temporary_row(big[0]);
+		auto after = multidim::make_temporary_row(grid[2]);
+		big[0] = big[1];
+		big[1] = tmp;
+		REQUIRE(big[1][99999] == 7);
+		REQUIRE(small.cref() == grid[0]);
+		REQUIRE(after.cref() == grid[2]);
+	}
+	{
+		// without the heap, rows that do not fit in the arena are left empty
+		const multidim::temporary_row<multidim::inner_dynarray<int>> fits(std::nothrow, grid[1]);
+		REQUIRE(fits);
+		REQUIRE(fits.cref() == grid[1]);
+		const multidim::temporary_row<multidim::inner_array<std::uint8_t, 100000>> too_big(std::nothrow, big[0]);
+		REQUIRE(!too_big);
+	}
+
+	// elements that are not trivial, and a thread of their own
+	std::thread([] {
+		multidim::dynarray<multidim::inner_dynarray<std::string>> names(2, 2);
+		names[0][0] = "a";
+		names[0][1] = "b";
+		auto tmp = multidim::make_temporary_row(names[0]);
+		names[0] = names[1];
+		REQUIRE(tmp.cref()[1] == "b");
+	}).join();
+}
+
+TEST_CASE("rotate rows through a temporary_row", "[2d][temporary_row]") {
+	for (size_t n : { 1, 2, 6, 12, 101 }) {
+		for (size_t k = 0; k <= n; ++k) {
+			multidim::vector<multidim::inner_dynarray<int>> rows(3);
+			multidim::dynarray<int> row(3);
+			for (size_t i = 0; i != n; ++i) {
+				for (size_t j = 0; j != 3; ++j) row[j] = static_cast<int>(i * 3 + j);
+				rows.push_back(row);
+			}
+			const auto ret = multidim::rotate(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(k), rows.end());
+			REQUIRE(ret - rows.begin() == static_cast<std::ptrdiff_t>(n - k));
+			for (size_t i = 0; i != n; ++i) {
+				for (size_t j = 0; j != 3; ++j) REQUIRE(rows[i][j] == static_cast<int>((i + k) % n * 3 + j));
+			}
+		}
+	}
+}
+
+TEST_CASE("rotate rows too large for the arena by swapping them", "[2d][temporary_row]") {
+	constexpr size_t width = 20000; // 80 KB per row
+	multidim::dynarray<multidim::inner_dynarray<int>> rows(5, width);
+	for (size_t i = 0; i != 5; ++i) {
+		rows[i][0] = static_cast<int>(i);
+		rows[i][width - 1] = static_cast<int>(i);
+	}
+	const auto ret = multidim::rotate(rows.begin(), rows.begin() + 2, rows.end());
+	REQUIRE(ret == rows.begin() + 3);
+	for (size_t i = 0; i != 5; ++i) {
+		REQUIRE(rows[i][0] == static_cast<int>((i + 2) % 5));
+		REQUIRE(rows[i][width - 1] == static_cast<int>((i + 2) % 5));
+	}
+}
+
+TEST_CASE("rotate whole containers by swapping them", "[2d][temporary_row]") {
+	std::vector<multidim::dynarray<int>> rows;
+	std::vector<const int*> buffers;
+	for (int i = 0; i != 7; ++i) {
+		rows.emplace_back(static_cast<size_t>(i + 1));
+		rows.back()[0] = i;
+		buffers.push_back(rows.back().data());
+	}
+	const auto ret = multidim::rotate(rows.begin(), rows.begin() + 3, rows.end());
+	REQUIRE(ret == rows.begin() + 4);
+	for (size_t i = 0; i != 7; ++i) {
+		const size_t from = (i + 3) % 7;
+		REQUIRE(rows[i].size() == from + 1);
+		REQUIRE(rows[i][0] == static_cast<int>(from));
+		REQUIRE(rows[i].data() == buffers[from]); // the buffers were swapped, not copied
+	}
+	multidim::stable_sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a[0] < b[0]; });
+	for (size_t i = 0; i != 7; ++i) REQUIRE(rows[i][0] == static_cast<int>(i));
+}
@@ -338,3 +338,56 @@ TEST_CASE("1D vector shrink_to_fit", "[1d][vector][shrink_to_fit]") {
 	REQUIRE(arr.size() == 4);
 	REQUIRE(std::equal(v.begin(), v.end(), arr.begin(), arr.end()));
 }
+
+TEST_CASE("2D vector adopt and release", "[2d][vector][adopt]") {
+	int freed = 0;
+	int* const raw = new int[8]{ 0, 1, 10, 11, 20, 21 };
+	{
+		using managed_vector = multidim::vector<multidim::inner_dynarray<int>, multidim::default_growth, multidim::managed_buffer>;
+		managed_vector arr = managed_vector::adopt(raw, [&freed](int* p) { ++freed; delete[] p; }, 3, 4, 2);
+		REQUIRE(arr.data() == raw);
+		REQUIRE(arr.size() == 3);
+		REQUIRE(arr.capacity() == 4);
+		REQUIRE(arr[2][1] == 21);
+		multidim::dynarray<int> row(2);
+		row[0] = 30;
+		arr.push_back(row); // fits in the adopted capacity
+		REQUIRE(arr.data() == raw);
+		arr.push_back(row); // reallocates, so the adopted buffer is freed
+		REQUIRE(freed == 1);
+		REQUIRE(arr[3][0] == 30);
+		REQUIRE(arr[1][1] == 11);
+	}
+	REQUIRE(freed == 1);
+
+	{
+		// a vector with plain_buffer adopts and releases std::unique_ptr<T[]>
+		std::unique_ptr<int[]> plain_buf(new int[8]{ 0, 1, 10, 11 });
+		int* const plain_raw = plain_buf.get();
+		multidim::vector<multidim::inner_dynarray<int>> plain = multidim::vector<multidim::inner_dynarray<int>>::adopt(std::move(plain_buf), 2, 4, 2);
+		REQUIRE(plain.data() == plain_raw);
+		REQUIRE(plain.capacity() == 4);
+		REQUIRE(plain[1][1] == 11);
+		const std::unique_ptr<int[]> released = plain.release();
+		REQUIRE(plain.empty());
+		REQUIRE(plain.capacity() == 0);
+		REQUIRE(released.get() == plain_raw);
+	}
+
+	Tracker<int>::reset();
+	{
+		multidim::buffer_ptr<Tracker<int>> buf;
+		{
+			multidim::vector<multidim::inner_dynarray<Tracker<int>>, multidim::default_growth, multidim::managed_buffer> arr(2);
+			arr.resize(3);
+			Tracker<int>::validate_net(6);
+			const Tracker<int>* const data = arr.data();
+			buf = arr.release();
+			REQUIRE(arr.empty());
+			REQUIRE(arr.capacity() == 0);
+			REQUIRE(buf.get() == data);
+		}
+		Tracker<int>::validate_net(6);
+	}
+	Tracker<int>::validate_net(0);
+}